@@ -319,6 +319,7 @@ XGB_DLL int XGDMatrixCreateFromCudaArrayInterface(char const *data, char const *
  * - \ref XGProxyDMatrixSetDataCudaArrayInterface
  * - \ref XGProxyDMatrixSetDataCudaColumnar
  * - \ref XGProxyDMatrixSetDataDense
+ * - \ref XGProxyDMatrixSetDataColumnar
  * - \ref XGProxyDMatrixSetDataCSR
  * - ... (data setters)
  *
@@ -442,6 +443,9 @@ XGB_EXTERN_C typedef void DataIterResetCallback(DataIterHandle handle); // NOLIN
  *   - missing:      Which value to represent missing value
  *   - cache_prefix: The path of cache file, caller must initialize all the directories in this path.
  *   - nthread (optional): Number of threads used for initializing DMatrix.
+ *   - persistent_cache (optional): Keep the cache files after the DMatrix is freed.  A new
+ *     DMatrix with the same cache_prefix reuses the cache instead of building it again
+ *     when the data and its meta info are unchanged.  Default to false.
  * \param[out] out      The created external memory DMatrix
  *
  * \return 0 when success, -1 when failure happens
@@ -475,6 +479,12 @@ XGB_DLL int XGDMatrixCreateFromCallback(DataIterHandle iter, DMatrixHandle proxy
  *   - missing:      Which value to represent missing value
  *   - nthread (optional): Number of threads used for initializing DMatrix.
  *   - max_bin (optional):  Maximum number of bins for building histogram.
+ *   - sketch_buffer_bytes (optional): Build the CPU quantile DMatrix with a single pass
+ *     over the iterator.  Batches are buffered in memory up to this size, the quantile
+ *     cuts are sketched from the buffered batches and the rest of the data is quantized as
+ *     it arrives.  The cuts are estimated from the leading batches when the data doesn't
+ *     fit in the buffer.  Default to 0, which iterates over the data multiple times.
+ *     (since 2.0.0)
  * \param out      The created Device Quantile DMatrix
  *
  * \return 0 when success, -1 when failure happens
@@ -531,6 +541,20 @@ XGB_DLL int XGProxyDMatrixSetDataCudaColumnar(DMatrixHandle handle,
 XGB_DLL int XGProxyDMatrixSetDataDense(DMatrixHandle handle,
                                        char const *c_interface_str);
 
+/*!
+ * \brief Set columnar data on a DMatrix proxy.  The data is read in place, which avoids
+ *        converting columnar inputs like Arrow record batches into CSR for quantile DMatrix.
+ *
+ * \param handle          A DMatrix proxy created by \ref XGProxyDMatrixCreate
+ * \param c_interface_str Null terminated JSON document string representation of a list of
+ *                        array interfaces, one for each column.  Each column can have a
+ *                        validity bitmap specified by the `mask` field, masked values are
+ *                        treated as missing.
+ *
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGProxyDMatrixSetDataColumnar(DMatrixHandle handle, char const *c_interface_str);
+
 /*!
  * \brief Set data on a DMatrix proxy.
  *
@@ -592,6 +616,65 @@ XGB_DLL int XGDMatrixSliceDMatrixEx(DMatrixHandle handle,
                                     bst_ulong len,
                                     DMatrixHandle *out,
                                     int allow_groups);
+/**
+ * \brief Create a view on selected rows of an in-memory DMatrix without copying the data.
+ *        The view keeps a reference to the original matrix, meta info like labels is
+ *        gathered at construction.  For the `hist` tree method, the gradient index is
+ *        obtained from the original matrix by selecting the quantized rows.  Not supported
+ *        by `gpu_hist`.
+ *
+ * \since 2.0.0
+ *
+ * \param handle       Instance of data matrix to be viewed.
+ * \param idxset       Index set.
+ * \param len          Length of index set.
+ * \param out          The new view.
+ * \param allow_groups Allow viewing a matrix with groups.
+ *
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGDMatrixSliceDMatrixView(DMatrixHandle handle, const int *idxset, bst_ulong len,
+                                      DMatrixHandle *out, int allow_groups);
+/**
+ * \brief Append rows of another DMatrix to an in-memory DMatrix.
+ *
+ *   The DMatrix is modified in place.  If a gradient index has been built for the `hist`
+ *   tree method, new rows are quantized using the existing cuts and the prediction cache
+ *   of boosters trained on this DMatrix is extended by predicting only the new rows.
+ *   Values outside of the existing cut range fall into the first or the last bin of the
+ *   feature, re-create the DMatrix when the data distribution drifts significantly.
+ *
+ * \param handle The DMatrix to be extended, must be created from in-memory data.
+ * \param other  The DMatrix containing new rows and their meta info.  The number of columns
+ *               must not exceed the number of columns of `handle`.
+ *
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGDMatrixAppend(DMatrixHandle handle, DMatrixHandle other);
+/**
+ * \brief Remove the first `n_rows` rows from an in-memory DMatrix, used together with
+ *        \ref XGDMatrixAppend for training on a sliding window.
+ *
+ * \param handle The DMatrix to be modified, must be created from in-memory data.
+ * \param n_rows Number of rows to be removed.  When the DMatrix has query groups, it must
+ *               end at a group boundary.
+ *
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGDMatrixDropPrefix(DMatrixHandle handle, bst_ulong n_rows);
+/**
+ * \brief Encode the row storage of an in-memory DMatrix in a compact form to reduce
+ *        resident memory.
+ *
+ *   Feature indices are stored with 8 or 16 bits when the number of features allows,
+ *   values are omitted when all of them are 1 and row offsets use 32-bit integers.  The
+ *   rows are decoded on demand when accessed, which is transparent to all algorithms.
+ *
+ * \param handle The DMatrix to be compacted, must be created from in-memory data.
+ *
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGDMatrixCompact(DMatrixHandle handle);
 /*!
  * \brief free space in data matrix
  * \return 0 when success, -1 when failure happens
@@ -602,7 +685,9 @@ XGB_DLL int XGDMatrixFree(DMatrixHandle handle);
  */
 
 /*!
- * \brief load a data matrix into binary file
+ * \brief Save a data matrix into binary file.  Both the DMatrix and the QuantileDMatrix
+ *        (CPU only) can be saved, the latter stores the quantized data so that it can be
+ *        loaded without being quantized again.
  * \param handle a instance of data matrix
  * \param fname file name
  * \param silent print statistics when saving
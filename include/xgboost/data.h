@@ -587,6 +587,8 @@ class DMatrix {
    * \param missing Value that should be treated as missing.
    * \param nthread number of threads used for initialization.
    * \param max_bin Maximum number of bins.
+   * \param sketch_buffer_bytes Size of the buffer for building the quantile DMatrix with a
+   *                            single pass over the data, 0 to disable.
    *
    * \return A created quantile based DMatrix.
    */
@@ -594,7 +596,7 @@ class DMatrix {
             typename XGDMatrixCallbackNext>
   static DMatrix* Create(DataIterHandle iter, DMatrixHandle proxy, std::shared_ptr<DMatrix> ref,
                          DataIterResetCallback* reset, XGDMatrixCallbackNext* next, float missing,
-                         int nthread, bst_bin_t max_bin);
+                         int nthread, bst_bin_t max_bin, std::size_t sketch_buffer_bytes = 0);
 
   /**
    * \brief Create an external memory DMatrix with callbacks.
@@ -611,6 +613,8 @@ class DMatrix {
    * \param missing Value that should be treated as missing.
    * \param nthread number of threads used for initialization.
    * \param cache   Prefix of cache file path.
+   * \param persistent_cache Keep the cache files after the DMatrix is destroyed and reuse
+   *                         them when the data source is unchanged.
    *
    * \return A created external memory DMatrix.
    */
@@ -619,7 +623,7 @@ class DMatrix {
   static DMatrix *Create(DataIterHandle iter, DMatrixHandle proxy,
                          DataIterResetCallback *reset,
                          XGDMatrixCallbackNext *next, float missing,
-                         int32_t nthread, std::string cache);
+                         int32_t nthread, std::string cache, bool persistent_cache = false);
 
   virtual DMatrix *Slice(common::Span<int32_t const> ridxs) = 0;
 
@@ -632,6 +636,28 @@ class DMatrix {
    */
   virtual DMatrix *SliceCol(int num_slices, int slice_id) = 0;
 
+  /**
+   * \brief Append rows from another DMatrix.  Existing gradient index is extended with
+   *        the current cuts instead of being re-sketched.
+   *
+   * \param that The DMatrix containing new rows, with the same number of columns.
+   */
+  virtual void Append(DMatrix* that) {
+    CHECK(that);
+    LOG(FATAL) << "Appending rows is only supported by in-memory DMatrix.";
+  }
+  /**
+   * \brief Remove the first `n_rows` rows.
+   */
+  virtual void DropPrefix(bst_row_t n_rows) {
+    LOG(FATAL) << "Dropping rows is only supported by in-memory DMatrix, n_rows: " << n_rows;
+  }
+  /**
+   * \brief Total number of rows removed by `DropPrefix` since the DMatrix was created, used
+   *        for aligning the prediction cache with the remaining rows.
+   */
+  virtual bst_row_t NumDroppedRows() const { return 0; }
+
  protected:
   virtual BatchSet<SparsePage> GetRowBatches() = 0;
   virtual BatchSet<CSCPage> GetColumnBatches() = 0;
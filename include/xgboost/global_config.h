@@ -8,6 +8,8 @@
 #define XGBOOST_GLOBAL_CONFIG_H_
 
 #include <xgboost/parameter.h>
+
+#include <cstdint>
 #include <vector>
 #include <string>
 
@@ -17,6 +19,8 @@ class Json;
 struct GlobalConfiguration : public XGBoostParameter<GlobalConfiguration> {
   int verbosity { 1 };
   bool use_rmm { false };
+  std::int64_t ext_mem_prefetch_bytes { static_cast<std::int64_t>(1) << 30 };
+  std::string ext_mem_page_format { "raw" };
   DMLC_DECLARE_PARAMETER(GlobalConfiguration) {
     DMLC_DECLARE_FIELD(verbosity)
         .set_range(0, 3)
@@ -25,6 +29,13 @@ struct GlobalConfiguration : public XGBoostParameter<GlobalConfiguration> {
     DMLC_DECLARE_FIELD(use_rmm)
         .set_default(false)
         .describe("Whether to use RAPIDS Memory Manager to allocate GPU memory in XGBoost");
+    DMLC_DECLARE_FIELD(ext_mem_prefetch_bytes)
+        .set_lower_bound(0)
+        .set_default(static_cast<std::int64_t>(1) << 30)
+        .describe("Maximum number of bytes of external memory pages being prefetched.");
+    DMLC_DECLARE_FIELD(ext_mem_page_format)
+        .set_default("raw")
+        .describe("Format of pages in the external memory cache, either raw or compressed.");
   }
 };
 
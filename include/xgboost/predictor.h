@@ -34,6 +34,9 @@ struct PredictionCacheEntry {
   HostDeviceVector<bst_float> predictions;
   // The version of current cache, corresponding number of layers of trees
   std::uint32_t version{0};
+  // Number of rows dropped from the front of the DMatrix when the cache was last aligned
+  // with it, see `DMatrix::NumDroppedRows`.
+  bst_row_t n_dropped_rows{0};
 
   PredictionCacheEntry() = default;
   /**
@@ -421,13 +421,23 @@ class DataIter(ABC):  # pylint: disable=too-many-instance-attributes
     release_data :
         Whether the iterator should release the data during reset. Set it to True if the
         data transformation (converting data to np.float32 type) is expensive.
+    persistent_cache :
+        Keep the cache files after the DMatrix is freed, only used in external memory.
+        Another DMatrix created with the same `cache_prefix` reuses the cache instead of
+        building it again, as long as the data and its meta info are unchanged.
+
+        .. versionadded:: 2.0.0
 
     """
 
     def __init__(
-        self, cache_prefix: Optional[str] = None, release_data: bool = True
+        self,
+        cache_prefix: Optional[str] = None,
+        release_data: bool = True,
+        persistent_cache: bool = False,
     ) -> None:
         self.cache_prefix = cache_prefix
+        self.persistent_cache = persistent_cache
 
         self._handle = _ProxyDMatrix()
         self._exception: Optional[Exception] = None
@@ -783,6 +793,7 @@ class DMatrix:  # pylint: disable=too-many-instance-attributes,too-many-public-m
             "missing": self.missing,
             "nthread": self.nthread,
             "cache_prefix": it.cache_prefix if it.cache_prefix else "",
+            "persistent_cache": getattr(it, "persistent_cache", False),
         }
         args_cstr = from_pystr_to_cstr(json.dumps(args))
         handle = ctypes.c_void_p()
@@ -940,6 +951,11 @@ class DMatrix:  # pylint: disable=too-many-instance-attributes,too-many-public-m
         """Save DMatrix to an XGBoost buffer.  Saved binary can be later loaded
         by providing the path to :py:func:`xgboost.DMatrix` as input.
 
+        .. versionchanged:: 2.0.0
+
+            :py:class:`QuantileDMatrix` constructed on CPU can be saved, the quantized data
+            is loaded without being quantized again.
+
         Parameters
         ----------
         fname : string or os.PathLike
@@ -1099,16 +1115,28 @@ class DMatrix:  # pylint: disable=too-many-instance-attributes,too-many-public-m
         return ret.value
 
     def slice(
-        self, rindex: Union[List[int], np.ndarray], allow_groups: bool = False
+        self,
+        rindex: Union[List[int], np.ndarray],
+        allow_groups: bool = False,
+        view: bool = False,
     ) -> "DMatrix":
         """Slice the DMatrix and return a new DMatrix that only contains `rindex`.
 
+        .. versionchanged:: 2.0.0
+
+            The ``view`` parameter is added.
+
         Parameters
         ----------
         rindex
             List of indices to be selected.
         allow_groups
             Allow slicing of a matrix with a groups attribute
+        view
+            Return a view that refers to the data of this DMatrix instead of a copy.  For
+            the ``hist`` tree method, the view copies the quantized rows of this DMatrix
+            instead of sketching them again, the histogram cuts are shared.  The row
+            storage is gathered only when needed.  Not supported by ``gpu_hist``.
 
         Returns
         -------
@@ -1120,8 +1148,9 @@ class DMatrix:  # pylint: disable=too-many-instance-attributes,too-many-public-m
         res = DMatrix(None)
         res.handle = ctypes.c_void_p()
         rindex = _maybe_np_slice(rindex, dtype=np.int32)
+        fn = _LIB.XGDMatrixSliceDMatrixView if view else _LIB.XGDMatrixSliceDMatrixEx
         _check_call(
-            _LIB.XGDMatrixSliceDMatrixEx(
+            fn(
                 self.handle,
                 c_array(ctypes.c_int, rindex),
                 c_bst_ulong(len(rindex)),
@@ -1131,6 +1160,47 @@ class DMatrix:  # pylint: disable=too-many-instance-attributes,too-many-public-m
         )
         return res
 
+    def append(self, other: "DMatrix") -> None:
+        """Append rows of another DMatrix in place.  Along with :py:meth:`drop_prefix`,
+        this can be used for training on a sliding window without re-building the
+        DMatrix.  For the ``hist`` tree method, new rows are quantized with the existing
+        histogram cuts.
+
+        .. versionadded:: 2.0.0
+
+        Parameters
+        ----------
+        other :
+            DMatrix containing new rows along with their meta info.
+
+        """
+        _check_call(_LIB.XGDMatrixAppend(self.handle, other.handle))
+
+    def drop_prefix(self, n_rows: int) -> None:
+        """Remove the first `n_rows` rows in place.
+
+        .. versionadded:: 2.0.0
+
+        Parameters
+        ----------
+        n_rows :
+            Number of rows to be removed.  When the DMatrix has query groups, the removed
+            rows must end at a group boundary.
+
+        """
+        _check_call(_LIB.XGDMatrixDropPrefix(self.handle, c_bst_ulong(n_rows)))
+
+    def compact(self) -> None:
+        """Encode the data in a compact form to reduce memory usage.  Feature indices are
+        stored with narrow integers when the number of features allows, and values are
+        omitted when the data is binary.  The data is decoded on demand, which doesn't
+        affect training or prediction results.
+
+        .. versionadded:: 2.0.0
+
+        """
+        _check_call(_LIB.XGDMatrixCompact(self.handle))
+
     @property
     def feature_names(self) -> Optional[FeatureNames]:
         """Get feature names (column labels).
@@ -1320,6 +1390,16 @@ class _ProxyDMatrix(DMatrix):
             _LIB.XGProxyDMatrixSetDataDense(self.handle, _array_interface(data))
         )
 
+    def _set_data_from_arrow(self, data: DataType) -> None:
+        """Set data from Arrow table or record batch without converting it to CSR."""
+        from .data import _arrow_array_interfaces
+
+        _check_call(
+            _LIB.XGProxyDMatrixSetDataColumnar(
+                self.handle, _arrow_array_interfaces(data)
+            )
+        )
+
     def _set_data_from_csr(self, csr: scipy.sparse.csr_matrix) -> None:
         """Set data from scipy csr"""
         from .data import _array_interface
@@ -1363,6 +1443,16 @@ class QuantileDMatrix(DMatrix):
         as a reference means that the same quantisation applied to the training data is
         applied to the validation/test data
 
+    sketch_buffer_bytes :
+        Build the ``QuantileDMatrix`` with a single pass over the data iterator instead of
+        iterating over it multiple times.  Batches are buffered in memory up to this size,
+        the quantile cuts are sketched from the buffered batches and the rest of the data
+        is quantized as it arrives.  When the data doesn't fit in the buffer, the cuts are
+        estimated from the leading batches, which should be shuffled beforehand.  Only
+        used for CPU input.
+
+        .. versionadded:: 2.0.0
+
     """
 
     @_deprecate_positional_args
@@ -1387,8 +1477,10 @@ class QuantileDMatrix(DMatrix):
         feature_weights: Optional[ArrayLike] = None,
         enable_categorical: bool = False,
         data_split_mode: DataSplitMode = DataSplitMode.ROW,
+        sketch_buffer_bytes: Optional[int] = None,
     ) -> None:
         self.max_bin: int = max_bin if max_bin is not None else 256
+        self.sketch_buffer_bytes = sketch_buffer_bytes
         self.missing = missing if missing is not None else np.nan
         self.nthread = nthread if nthread is not None else -1
         self._silent = silent  # unused, kept for compatibility
@@ -1470,9 +1562,14 @@ class QuantileDMatrix(DMatrix):
                 "in iterator to fix this error."
             )
 
-        config = make_jcargs(
-            nthread=self.nthread, missing=self.missing, max_bin=self.max_bin
-        )
+        args: Dict[str, Any] = {
+            "nthread": self.nthread,
+            "missing": self.missing,
+            "max_bin": self.max_bin,
+        }
+        if self.sketch_buffer_bytes is not None:
+            args["sketch_buffer_bytes"] = self.sketch_buffer_bytes
+        config = make_jcargs(**args)
         ret = _LIB.XGQuantileDMatrixCreateFromCallback(
             None,
             it.proxy.handle,
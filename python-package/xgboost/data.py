@@ -5,7 +5,18 @@ import ctypes
 import json
 import os
 import warnings
-from typing import Any, Callable, Iterator, List, Optional, Sequence, Tuple, Union, cast
+from typing import (
+    Any,
+    Callable,
+    Dict,
+    Iterator,
+    List,
+    Optional,
+    Sequence,
+    Tuple,
+    Union,
+    cast,
+)
 
 import numpy as np
 
@@ -654,7 +665,7 @@ def _is_arrow(data: DataType) -> bool:
         import pyarrow as pa
         from pyarrow import dataset as arrow_dataset
 
-        return isinstance(data, (pa.Table, arrow_dataset.Dataset))
+        return isinstance(data, (pa.Table, pa.RecordBatch, arrow_dataset.Dataset))
     except ImportError:
         return False
 
@@ -714,7 +725,7 @@ def _from_arrow(
     if enable_categorical:
         raise ValueError("categorical data in arrow is not supported yet.")
 
-    batches = data.to_batches()
+    batches = [data] if isinstance(data, pa.RecordBatch) else data.to_batches()
     rb_iter = iter(batches)
     it = record_batch_data_iter(rb_iter)
     next_callback = ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_void_p)(it)
@@ -729,9 +740,72 @@ def _from_arrow(
             ctypes.byref(handle),
         )
     )
+    if feature_names is None:
+        feature_names = list(data.schema.names)
     return handle, feature_names, feature_types
 
 
+def _transform_arrow(
+    data: DataType, feature_names: Optional[FeatureNames]
+) -> Tuple[DataType, Optional[FeatureNames]]:
+    """Prepare Arrow data for the columnar proxy. Chunks in a table are passed as they
+    are without being combined."""
+    import pyarrow as pa
+
+    if not all(
+        pa.types.is_integer(t) or pa.types.is_floating(t) for t in data.schema.types
+    ):
+        raise ValueError(
+            "Features in dataset can only be integers or floating point number"
+        )
+    if not isinstance(data, (pa.Table, pa.RecordBatch)):
+        data = data.to_table()
+    if feature_names is None:
+        feature_names = list(data.schema.names)
+    return data, feature_names
+
+
+def _arrow_array_interfaces(data: DataType) -> bytes:
+    """Extract array interfaces from Arrow columns without copying the data. Validity
+    bitmaps are passed as masks. A table is passed as a list of record batches, which
+    share the chunk boundaries between columns."""
+    import pyarrow as pa
+
+    def columns_interfaces(columns: Sequence) -> List[Dict[str, Any]]:
+        interfaces = []
+        for col in columns:
+            if col.null_count != 0 and col.offset % 8 != 0:
+                # The validity bitmap of a sliced array might not be byte aligned.
+                col = pa.concat_arrays([col])
+            validity, values = col.buffers()[:2]
+            dtype = np.dtype(col.type.to_pandas_dtype())
+            interface: Dict[str, Any] = {
+                "data": (values.address + col.offset * dtype.itemsize, True),
+                "shape": (len(col),),
+                "strides": None,
+                "typestr": dtype.str,
+                "version": 3,
+            }
+            if validity is not None and col.null_count != 0:
+                interface["mask"] = {
+                    "data": (validity.address + col.offset // 8, True),
+                    "shape": (len(col),),
+                    "typestr": "|t1",
+                    "version": 3,
+                }
+            interfaces.append(interface)
+        return interfaces
+
+    if isinstance(data, pa.Table):
+        # Slicing a table into record batches doesn't copy the data.
+        batches = [batch for batch in data.to_batches() if batch.num_rows != 0]
+        if len(batches) == 1:
+            return bytes(json.dumps(columns_interfaces(batches[0].columns)), "utf-8")
+        chunks = [columns_interfaces(batch.columns) for batch in batches]
+        return bytes(json.dumps(chunks), "utf-8")
+    return bytes(json.dumps(columns_interfaces(data.columns)), "utf-8")
+
+
 def _is_cudf_df(data: DataType) -> bool:
     return lazy_isinstance(data, "cudf.core.dataframe", "DataFrame")
 
@@ -1284,6 +1358,9 @@ def _proxy_transform(
     if _is_scipy_csr(data):
         data = transform_scipy_sparse(data, True)
         return data, None, feature_names, feature_types
+    if _is_arrow(data):
+        data, feature_names = _transform_arrow(data, feature_names)
+        return data, None, feature_names, feature_types
     if _is_pandas_series(data):
         import pandas as pd
 
@@ -1335,4 +1412,7 @@ def dispatch_proxy_set_data(
     if _is_scipy_csr(data):
         proxy._set_data_from_csr(data)  # pylint: disable=W0212
         return
+    if _is_arrow(data):
+        proxy._set_data_from_arrow(data)  # pylint: disable=W0212
+        return
     raise err
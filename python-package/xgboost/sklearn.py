@@ -217,7 +217,7 @@ __model_doc = f"""
     subsample : Optional[float]
         Subsample ratio of the training instance.
     sampling_method :
-        Sampling method. Used only by `gpu_hist` tree method.
+        Sampling method. Used only by the `hist`, `approx` and `gpu_hist` tree methods.
           - `uniform`: select random training instances uniformly.
           - `gradient_based` select random training instances with higher probability when
             the gradient and hessian are larger. (cf. CatBoost)
@@ -290,6 +290,12 @@ def groups_to_rows(groups: List[np.ndarray], boundaries: np.ndarray) -> np.ndarr
     return np.concatenate([np.arange(boundaries[g], boundaries[g + 1]) for g in groups])
 
 
+def _check_view(param: BoosterParam) -> None:
+    """Views are not supported by the GPU tree method."""
+    if dict(param).get("tree_method", None) == "gpu_hist":
+        raise ValueError("DMatrix views are not supported by `gpu_hist`.")
+
+
 def mkgroupfold(
     dall: DMatrix,
     nfold: int,
@@ -297,6 +303,7 @@ def mkgroupfold(
     evals: Sequence[str] = (),
     fpreproc: Optional[FPreProcCallable] = None,
     shuffle: bool = True,
+    view: bool = False,
 ) -> List[CVPack]:
     """
     Make n folds for cross-validation maintaining groups
@@ -329,9 +336,9 @@ def mkgroupfold(
     ret = []
     for k in range(nfold):
         # perform the slicing using the indexes determined by the above methods
-        dtrain = dall.slice(in_idset[k], allow_groups=True)
+        dtrain = dall.slice(in_idset[k], allow_groups=True, view=view)
         dtrain.set_group(group_sizes[in_group_idset[k]])
-        dtest = dall.slice(out_idset[k], allow_groups=True)
+        dtest = dall.slice(out_idset[k], allow_groups=True, view=view)
         dtest.set_group(group_sizes[out_group_idset[k]])
         # run preprocessing on the data set if needed
         if fpreproc is not None:
@@ -353,18 +360,27 @@ def mknfold(
     stratified: Optional[bool] = False,
     folds: Optional[XGBStratifiedKFold] = None,
     shuffle: bool = True,
+    view: bool = False,
 ) -> List[CVPack]:
     """
     Make an n-fold list of CVPack from random indices.
     """
     evals = list(evals)
     np.random.seed(seed)
+    if view:
+        _check_view(param)
 
     if stratified is False and folds is None:
         # Do standard k-fold cross validation. Automatically determine the folds.
         if len(dall.get_uint_info("group_ptr")) > 1:
             return mkgroupfold(
-                dall, nfold, param, evals=evals, fpreproc=fpreproc, shuffle=shuffle
+                dall,
+                nfold,
+                param,
+                evals=evals,
+                fpreproc=fpreproc,
+                shuffle=shuffle,
+                view=view,
             )
 
         if shuffle is True:
@@ -398,8 +414,8 @@ def mknfold(
     ret = []
     for k in range(nfold):
         # perform the slicing using the indexes determined by the above methods
-        dtrain = dall.slice(in_idset[k])
-        dtest = dall.slice(out_idset[k])
+        dtrain = dall.slice(in_idset[k], view=view)
+        dtest = dall.slice(out_idset[k], view=view)
         # run preprocessing on the data set if needed
         if fpreproc is not None:
             dtrain, dtest, tparam = fpreproc(dtrain, dtest, param.copy())
@@ -430,6 +446,7 @@ def cv(
     callbacks: Optional[Sequence[TrainingCallback]] = None,
     shuffle: bool = True,
     custom_metric: Optional[Metric] = None,
+    view: bool = False,
 ) -> Union[Dict[str, float], DataFrame]:
     # pylint: disable = invalid-name
     """Cross-validation with given parameters.
@@ -515,6 +532,18 @@ def cv(
         Custom metric function.  See :doc:`Custom Metric </tutorials/custom_metric_obj>`
         for details.
 
+    view :
+
+        .. versionadded 2.0.0
+
+        Use views of **dtrain** as folds instead of copies, see
+        :py:meth:`DMatrix.slice`.  Only the ``hist`` tree method reuses the quantized
+        data of **dtrain**: the histogram cuts are computed on the full data, including
+        the rows held out by each fold, so the results can differ from copied folds.
+        The quantized bins of each fold are still copied from **dtrain**.  Other CPU tree
+        methods, including the default ``auto``, gather the rows of each fold on demand.
+        Not supported by ``gpu_hist``.
+
     Returns
     -------
     evaluation history : list(string)
@@ -544,7 +573,7 @@ def cv(
 
     results: Dict[str, List[float]] = {}
     cvfolds = mknfold(
-        dtrain, nfold, params, seed, metrics, fpreproc, stratified, folds, shuffle
+        dtrain, nfold, params, seed, metrics, fpreproc, stratified, folds, shuffle, view
     )
 
     metric_fn = _configure_custom_metric(feval, custom_metric)
@@ -16,7 +16,10 @@
 #include "../common/charconv.h"
 #include "../common/io.h"
 #include "../data/adapter.h"
+#include "../data/iterative_dmatrix.h"
+#include "../data/row_subset_dmatrix.h"
 #include "../data/simple_dmatrix.h"
+#include "../data/sparse_page_writer.h"  // for CheckPageFormat
 #include "c_api_utils.h"
 #include "xgboost/base.h"
 #include "xgboost/data.h"
@@ -160,6 +163,11 @@ XGB_DLL int XGBSetGlobalConfig(const char* json_str) {
       break;
     }
   }
+  auto const& obj = get<Object const>(config);
+  auto page_format = obj.find("ext_mem_page_format");
+  if (page_format != obj.cend()) {
+    data::CheckPageFormat(get<String const>(page_format->second));
+  }
   auto unknown = FromJson(config, GlobalConfigThreadLocalStore::Get());
   if (!unknown.empty()) {
     std::stringstream ss;
@@ -290,13 +298,14 @@ XGB_DLL int XGDMatrixCreateFromCallback(DataIterHandle iter, DMatrixHandle proxy
   auto missing = GetMissing(jconfig);
   std::string cache = RequiredArg<String>(jconfig, "cache_prefix", __func__);
   auto n_threads = OptionalArg<Integer, int64_t>(jconfig, "nthread", 0);
+  auto persistent = OptionalArg<Boolean, bool>(jconfig, "persistent_cache", false);
 
   xgboost_CHECK_C_ARG_PTR(next);
   xgboost_CHECK_C_ARG_PTR(reset);
   xgboost_CHECK_C_ARG_PTR(out);
 
-  *out = new std::shared_ptr<xgboost::DMatrix>{
-      xgboost::DMatrix::Create(iter, proxy, reset, next, missing, n_threads, cache)};
+  *out = new std::shared_ptr<xgboost::DMatrix>{xgboost::DMatrix::Create(
+      iter, proxy, reset, next, missing, n_threads, cache, persistent)};
   API_END();
 }
 
@@ -331,13 +340,16 @@ XGB_DLL int XGQuantileDMatrixCreateFromCallback(DataIterHandle iter, DMatrixHand
   auto missing = GetMissing(jconfig);
   auto n_threads = OptionalArg<Integer, int64_t>(jconfig, "nthread", 0);
   auto max_bin = OptionalArg<Integer, int64_t>(jconfig, "max_bin", 256);
+  auto sketch_buffer_bytes = OptionalArg<Integer, int64_t>(jconfig, "sketch_buffer_bytes", 0);
+  CHECK_GE(sketch_buffer_bytes, 0) << "Invalid `sketch_buffer_bytes`.";
 
   xgboost_CHECK_C_ARG_PTR(next);
   xgboost_CHECK_C_ARG_PTR(reset);
   xgboost_CHECK_C_ARG_PTR(out);
 
-  *out = new std::shared_ptr<xgboost::DMatrix>{
-      xgboost::DMatrix::Create(iter, proxy, _ref, reset, next, missing, n_threads, max_bin)};
+  *out = new std::shared_ptr<xgboost::DMatrix>{xgboost::DMatrix::Create(
+      iter, proxy, _ref, reset, next, missing, n_threads, max_bin,
+      static_cast<std::size_t>(sketch_buffer_bytes))};
   API_END();
 }
 
@@ -388,6 +400,18 @@ XGB_DLL int XGProxyDMatrixSetDataDense(DMatrixHandle handle,
   API_END();
 }
 
+XGB_DLL int XGProxyDMatrixSetDataColumnar(DMatrixHandle handle, char const *c_interface_str) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  xgboost_CHECK_C_ARG_PTR(c_interface_str);
+  auto p_m = static_cast<std::shared_ptr<xgboost::DMatrix> *>(handle);
+  CHECK(p_m);
+  auto m = static_cast<xgboost::data::DMatrixProxy *>(p_m->get());
+  CHECK(m) << "Current DMatrix type does not support set data.";
+  m->SetColumnarData(c_interface_str);
+  API_END();
+}
+
 XGB_DLL int XGProxyDMatrixSetDataCSR(DMatrixHandle handle, char const *indptr,
                                      char const *indices, char const *data,
                                      xgboost::bst_ulong ncol) {
@@ -564,6 +588,53 @@ XGB_DLL int XGDMatrixSliceDMatrixEx(DMatrixHandle handle,
   API_END();
 }
 
+XGB_DLL int XGDMatrixSliceDMatrixView(DMatrixHandle handle, const int *idxset, bst_ulong len,
+                                      DMatrixHandle *out, int allow_groups) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  xgboost_CHECK_C_ARG_PTR(out);
+  auto p_m = CastDMatrixHandle(handle);
+  if (!allow_groups) {
+    CHECK_EQ(p_m->Info().group_ptr_.size(), 0U) << "slice does not support group structure";
+  }
+  common::Span<std::int32_t const> ridx{idxset, static_cast<std::size_t>(len)};
+  if (dynamic_cast<data::RowSubsetDMatrix *>(p_m.get())) {
+    // Don't nest views.
+    *out = new std::shared_ptr<DMatrix>(p_m->Slice(ridx));
+  } else {
+    *out = new std::shared_ptr<DMatrix>(new data::RowSubsetDMatrix{p_m, ridx});
+  }
+  API_END();
+}
+
+XGB_DLL int XGDMatrixAppend(DMatrixHandle handle, DMatrixHandle other) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  xgboost_CHECK_C_ARG_PTR(other);
+  auto p_m = CastDMatrixHandle(handle);
+  auto p_other = CastDMatrixHandle(other);
+  p_m->Append(p_other.get());
+  API_END();
+}
+
+XGB_DLL int XGDMatrixDropPrefix(DMatrixHandle handle, xgboost::bst_ulong n_rows) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  auto p_m = CastDMatrixHandle(handle);
+  p_m->DropPrefix(n_rows);
+  API_END();
+}
+
+XGB_DLL int XGDMatrixCompact(DMatrixHandle handle) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  auto p_m = CastDMatrixHandle(handle);
+  auto* derived = dynamic_cast<data::SimpleDMatrix*>(p_m.get());
+  CHECK(derived) << "Compact storage is only supported by in-memory DMatrix.";
+  derived->Compact();
+  API_END();
+}
+
 XGB_DLL int XGDMatrixFree(DMatrixHandle handle) {
   API_BEGIN();
   CHECK_HANDLE();
@@ -579,8 +650,10 @@ XGB_DLL int XGDMatrixSaveBinary(DMatrixHandle handle, const char* fname,
   xgboost_CHECK_C_ARG_PTR(fname);
   if (data::SimpleDMatrix* derived = dynamic_cast<data::SimpleDMatrix*>(dmat)) {
     derived->SaveToLocalFile(fname);
+  } else if (auto* quantile = dynamic_cast<data::IterativeDMatrix*>(dmat)) {
+    quantile->SaveToLocalFile(fname);
   } else {
-    LOG(FATAL) << "binary saving only supported by SimpleDMatrix";
+    LOG(FATAL) << "binary saving only supported by SimpleDMatrix and QuantileDMatrix";
   }
   API_END();
 }
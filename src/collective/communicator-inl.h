@@ -175,6 +175,21 @@ inline void Allreduce(void *send_receive_buffer, size_t count, DataType data_typ
   Communicator::Get()->AllReduce(send_receive_buffer, count, data_type, op);
 }
 
+/**
+ * @brief Perform in-place allreduce with a user-defined reduction.  This function is NOT
+ * thread-safe.
+ *
+ * @param send_receive_buffer Buffer for both sending and receiving data.
+ * @param type_bytes          Size of each element in bytes, must be the same on all processes.
+ * @param count               Number of elements to be reduced.
+ * @param reducer             Function that combines the elements from another process into the
+ *                            local elements.
+ */
+inline void AllreduceCustom(void *send_receive_buffer, std::size_t type_bytes, std::size_t count,
+                            Communicator::ReduceFn reducer) {
+  Communicator::Get()->AllReduceCustom(send_receive_buffer, type_bytes, count, reducer);
+}
+
 template <Operation op>
 inline void Allreduce(int8_t *send_receive_buffer, size_t count) {
   Communicator::Get()->AllReduce(send_receive_buffer, count, DataType::kInt8, op);
@@ -3,6 +3,10 @@
  */
 #include "communicator.h"
 
+#include <algorithm>  // for copy_n
+#include <cstdint>    // for uint8_t
+#include <vector>     // for vector
+
 #include "in_memory_communicator.h"
 #include "noop_communicator.h"
 #include "rabit_communicator.h"
@@ -50,6 +54,27 @@ void Communicator::Init(Json const& config) {
   }
 }
 
+void Communicator::AllReduceCustom(void *send_receive_buffer, std::size_t type_bytes,
+                                   std::size_t count, ReduceFn reducer) {
+  auto world = static_cast<std::size_t>(GetWorldSize());
+  if (world == 1) {
+    return;
+  }
+  auto n_bytes = type_bytes * count;
+  std::vector<std::uint8_t> buffer(n_bytes * world, 0);
+  std::copy_n(static_cast<std::uint8_t const *>(send_receive_buffer), n_bytes,
+              buffer.begin() + n_bytes * GetRank());
+  this->AllGather(buffer.data(), buffer.size());
+  // Reduce pairs of buffers at each level, the order is the same on all processes.
+  for (std::size_t stride = 1; stride < world; stride *= 2) {
+    for (std::size_t r = 0; r + stride < world; r += 2 * stride) {
+      reducer(buffer.data() + (r + stride) * n_bytes, buffer.data() + r * n_bytes, count,
+              type_bytes);
+    }
+  }
+  std::copy_n(buffer.cbegin(), n_bytes, static_cast<std::uint8_t *>(send_receive_buffer));
+}
+
 #ifndef XGBOOST_USE_CUDA
 void Communicator::Finalize() {
   communicator_->Shutdown();
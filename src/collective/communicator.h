@@ -144,6 +144,32 @@ class Communicator {
   virtual void AllReduce(void *send_receive_buffer, std::size_t count, DataType data_type,
                          Operation op) = 0;
 
+  /**
+   * @brief Reduction function for user-defined element types.
+   *
+   * @param src        Elements from another process.
+   * @param dst        Elements to be combined with `src` in place.
+   * @param count      Number of elements.
+   * @param type_bytes Size of each element in bytes.
+   */
+  using ReduceFn = void (*)(void const *src, void *dst, std::size_t count, std::size_t type_bytes);
+
+  /**
+   * @brief Combines fixed size elements from all processes with a user-defined reduction and
+   * distributes the result back to all processes.
+   *
+   * The default implementation gathers the buffers from all processes and reduces them in a
+   * binary tree order.  Communicators with a tree based allreduce reduce the buffers at each
+   * hop instead.
+   *
+   * @param send_receive_buffer Buffer storing the data.
+   * @param type_bytes          Size of each element in bytes.
+   * @param count               Number of elements in the buffer.
+   * @param reducer             The reduction function.
+   */
+  virtual void AllReduceCustom(void *send_receive_buffer, std::size_t type_bytes,
+                               std::size_t count, ReduceFn reducer);
+
   /**
    * @brief Broadcasts a message from the process with rank `root` to all other processes of the
    * group.
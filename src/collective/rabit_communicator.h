@@ -93,6 +93,17 @@ class RabitCommunicator : public Communicator {
     }
   }
 
+  void AllReduceCustom(void *send_receive_buffer, std::size_t type_bytes, std::size_t count,
+                       ReduceFn reducer) override {
+    // Rabit reduces the buffers at each hop of the tree (or the ring), but it only accepts a
+    // function pointer with its own signature.
+    auto &op = CurrentCustomOp();
+    op = CustomOp{reducer, type_bytes};
+    rabit::engine::Allreduce_(send_receive_buffer, type_bytes, count, &CustomReducer,
+                              rabit::engine::mpi::kChar, rabit::engine::mpi::kSum);
+    op = CustomOp{};
+  }
+
   void Broadcast(void *send_receive_buffer, std::size_t size, int root) override {
     rabit::Broadcast(send_receive_buffer, size, root);
   }
@@ -105,6 +116,20 @@ class RabitCommunicator : public Communicator {
   void Shutdown() override { rabit::Finalize(); }
 
  private:
+  struct CustomOp {
+    ReduceFn reducer{nullptr};
+    std::size_t type_bytes{0};
+  };
+  static CustomOp &CurrentCustomOp() {
+    static thread_local CustomOp op;
+    return op;
+  }
+  static void CustomReducer(const void *src, void *dst, int count, const MPI::Datatype &) {
+    auto const &op = CurrentCustomOp();
+    CHECK(op.reducer);
+    op.reducer(src, dst, static_cast<std::size_t>(count), op.type_bytes);
+  }
+
   template <typename DType, std::enable_if_t<std::is_integral<DType>::value> * = nullptr>
   void DoBitwiseAllReduce(void *send_receive_buffer, std::size_t count, Operation op) {
     switch (op) {
@@ -0,0 +1,219 @@
+/**
+ * Copyright 2023 by XGBoost Contributors
+ *
+ * \brief Simple and fast lossless encodings used for compressing data written to disk.
+ */
+#ifndef XGBOOST_COMMON_CODEC_H_
+#define XGBOOST_COMMON_CODEC_H_
+
+#include <algorithm>    // for min, fill_n
+#include <cstddef>      // for size_t
+#include <cstdint>      // for uint8_t, uint32_t, uint64_t, int64_t
+#include <cstring>      // for memcpy
+#include <type_traits>  // for is_trivially_copyable_v
+#include <vector>       // for vector
+
+#include "xgboost/logging.h"  // for CHECK
+#include "xgboost/span.h"     // for Span
+
+namespace xgboost::common {
+/**
+ * \brief Append an unsigned integer to the output using the LEB128 variable length
+ *        encoding, 7 bits are stored in each byte.
+ */
+inline void VarintEncode(std::uint64_t v, std::vector<std::uint8_t>* out) {
+  while (v >= 0x80) {
+    out->push_back(static_cast<std::uint8_t>(v | 0x80));
+    v >>= 7;
+  }
+  out->push_back(static_cast<std::uint8_t>(v));
+}
+
+/**
+ * \brief Decode an integer encoded by `VarintEncode`, `p` is advanced to the next value.
+ */
+inline std::uint64_t VarintDecode(std::uint8_t const** p, std::uint8_t const* end) {
+  std::uint64_t v{0};
+  std::uint32_t shift{0};
+  auto it = *p;
+  while (true) {
+    CHECK(it != end && shift < 64) << "Corrupted varint.";
+    auto byte = *it++;
+    v |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      break;
+    }
+    shift += 7;
+  }
+  *p = it;
+  return v;
+}
+
+/**
+ * \brief Map signed integers to unsigned integers such that values with small magnitude
+ *        have small encodings.
+ */
+inline std::uint64_t ZigZagEncode(std::int64_t v) {
+  return (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63);
+}
+
+inline std::int64_t ZigZagDecode(std::uint64_t v) {
+  return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+}
+
+/**
+ * \brief Transpose the bytes of values such that the i^th byte of all values are
+ *        contiguous. Exponent and sign bytes of floating point values are often repetitive,
+ *        which makes the shuffled data more compressible.
+ */
+template <typename T>
+void ByteShuffle(Span<T const> in, std::uint8_t* out) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  auto const* bytes = reinterpret_cast<std::uint8_t const*>(in.data());
+  auto n = in.size();
+  for (std::size_t b = 0; b < sizeof(T); ++b) {
+    auto plane = out + b * n;
+    for (std::size_t i = 0; i < n; ++i) {
+      plane[i] = bytes[i * sizeof(T) + b];
+    }
+  }
+}
+
+template <typename T>
+void ByteUnshuffle(std::uint8_t const* in, Span<T> out) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  auto* bytes = reinterpret_cast<std::uint8_t*>(out.data());
+  auto n = out.size();
+  for (std::size_t b = 0; b < sizeof(T); ++b) {
+    auto plane = in + b * n;
+    for (std::size_t i = 0; i < n; ++i) {
+      bytes[i * sizeof(T) + b] = plane[i];
+    }
+  }
+}
+
+/**
+ * \brief Run length encoding for bytes. The output is a sequence of blocks, each starting
+ *        with a varint header `(length << 1) | is_run`. A run block is followed by a
+ *        single byte to be repeated, while a literal block is followed by `length` bytes.
+ */
+inline void RleEncode(Span<std::uint8_t const> in, std::vector<std::uint8_t>* out) {
+  // Shorter runs are stored as literals since the header costs at least one byte.
+  constexpr std::size_t kMinRun = 4;
+  std::size_t literal_begin = 0;
+  auto flush_literal = [&](std::size_t literal_end) {
+    if (literal_end == literal_begin) {
+      return;
+    }
+    VarintEncode(static_cast<std::uint64_t>(literal_end - literal_begin) << 1, out);
+    out->insert(out->end(), in.data() + literal_begin, in.data() + literal_end);
+  };
+
+  std::size_t i = 0;
+  while (i < in.size()) {
+    std::size_t j = i + 1;
+    while (j < in.size() && in[j] == in[i]) {
+      ++j;
+    }
+    if (j - i >= kMinRun) {
+      flush_literal(i);
+      VarintEncode((static_cast<std::uint64_t>(j - i) << 1) | 1, out);
+      out->push_back(in[i]);
+      literal_begin = j;
+    }
+    i = j;
+  }
+  flush_literal(in.size());
+}
+
+/**
+ * \brief Decode exactly `out.size()` bytes encoded by `RleEncode`, `p` is advanced to the
+ *        end of the encoded data.
+ */
+inline void RleDecode(std::uint8_t const** p, std::uint8_t const* end, Span<std::uint8_t> out) {
+  std::size_t k = 0;
+  while (k < out.size()) {
+    auto header = VarintDecode(p, end);
+    auto length = static_cast<std::size_t>(header >> 1);
+    CHECK_LE(length, out.size() - k) << "Corrupted RLE block.";
+    if (header & 1) {
+      CHECK(*p != end) << "Corrupted RLE block.";
+      std::fill_n(out.data() + k, length, **p);
+      ++(*p);
+    } else {
+      CHECK_LE(length, static_cast<std::size_t>(end - *p)) << "Corrupted RLE block.";
+      std::memcpy(out.data() + k, *p, length);
+      *p += length;
+    }
+    k += length;
+  }
+}
+
+/**
+ * \brief Number of bits required to represent `v`.
+ */
+inline std::uint32_t BitWidth(std::uint64_t v) {
+  std::uint32_t n{0};
+  while (v != 0) {
+    ++n;
+    v >>= 1;
+  }
+  return n;
+}
+
+/**
+ * \brief Number of bytes required for storing `n` values with `n_bits` each.
+ */
+inline std::size_t BitPackedBytes(std::size_t n, std::uint32_t n_bits) {
+  return (n * n_bits + 7) / 8;
+}
+
+/**
+ * \brief Pack the lowest `n_bits` of each value into a contiguous bit stream.
+ */
+inline void BitPack(Span<std::uint32_t const> in, std::uint32_t n_bits, std::uint8_t* out) {
+  CHECK_LE(n_bits, 32);
+  std::fill_n(out, BitPackedBytes(in.size(), n_bits), 0);
+  if (n_bits == 0) {
+    return;
+  }
+  std::uint64_t acc{0};
+  std::uint32_t n_acc{0};
+  for (auto v : in) {
+    acc |= static_cast<std::uint64_t>(v) << n_acc;
+    n_acc += n_bits;
+    while (n_acc >= 8) {
+      *out++ = static_cast<std::uint8_t>(acc);
+      acc >>= 8;
+      n_acc -= 8;
+    }
+  }
+  if (n_acc != 0) {
+    *out = static_cast<std::uint8_t>(acc);
+  }
+}
+
+/**
+ * \brief Inverse of `BitPack`, `out.size()` values are decoded.
+ */
+inline void BitUnpack(std::uint8_t const* in, std::uint32_t n_bits, Span<std::uint32_t> out) {
+  CHECK_LE(n_bits, 32);
+  if (n_bits == 0) {
+    std::fill_n(out.data(), out.size(), 0);
+    return;
+  }
+  std::uint64_t const mask = (static_cast<std::uint64_t>(1) << n_bits) - 1;
+  std::uint64_t acc{0};
+  std::uint32_t n_acc{0};
+  for (auto& v : out) {
+    while (n_acc < n_bits) {
+      acc |= static_cast<std::uint64_t>(*in++) << n_acc;
+      n_acc += 8;
+    }
+    v = static_cast<std::uint32_t>(acc & mask);
+    acc >>= n_bits;
+    n_acc -= n_bits;
+  }
+}
+}  // namespace xgboost::common
+#endif  // XGBOOST_COMMON_CODEC_H_
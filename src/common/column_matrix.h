@@ -11,15 +11,20 @@
 #include <dmlc/endian.h>
 
 #include <algorithm>
+#include <cstddef>  // std::size_t
+#include <cstdint>  // std::uint32_t
+#include <iterator>  // std::distance
 #include <limits>
 #include <memory>
-#include <utility>  // std::move
+#include <utility>  // std::move, std::make_pair
 #include <vector>
 
 #include "../data/adapter.h"
 #include "../data/gradient_index.h"
 #include "algorithm.h"
+#include "common.h"  // DivRoundUp
 #include "hist_util.h"
+#include "threading_utils.h"  // ParallelFor
 
 namespace xgboost {
 namespace common {
@@ -139,19 +144,118 @@ class DenseColumnIter : public Column<BinIdxT> {
 class ColumnMatrix {
   void InitStorage(GHistIndexMatrix const& gmat, double sparse_threshold);
 
-  template <typename ColumnBinT, typename BinT, typename RIdx>
-  void SetBinSparse(BinT bin_id, RIdx rid, bst_feature_t fid, ColumnBinT* local_index) {
-    if (type_[fid] == kDenseColumn) {
-      ColumnBinT* begin = &local_index[feature_offsets_[fid]];
-      begin[rid] = bin_id - index_base_[fid];
-      // not thread-safe with bool vector.  FIXME(jiamingy): We can directly assign
-      // kMissingId to the index to avoid missing flags.
-      missing_flags_[feature_offsets_[fid] + rid] = false;
-    } else {
-      ColumnBinT* begin = &local_index[feature_offsets_[fid]];
-      begin[num_nonzeros_[fid]] = bin_id - index_base_[fid];
-      row_ind_[feature_offsets_[fid] + num_nonzeros_[fid]] = rid;
-      ++num_nonzeros_[fid];
+  /**
+   * \brief Transpose the rows into column storage.
+   *
+   *   The rows are split into one contiguous block per thread.  The number of entries of
+   *   each sparse column is counted for every block first, a prefix sum over the blocks
+   *   gives each block its own write position in the column, then the entries are
+   *   scattered in parallel.  Each block writes a contiguous range of rows for each
+   *   column, which keeps the blocks away from each other's cache lines and produces the
+   *   same layout as a serial transpose.
+   *
+   * \param base_rowid Row index of the first row in the column storage.
+   * \param n_rows     Number of rows to be transposed.
+   * \param visit      Callback that invokes `fn(fidx, bin_idx)` for each entry of a row,
+   *                   with feature indices in ascending order.
+   */
+  template <typename Visit>
+  void SetIndexMixedColumnsImpl(std::size_t base_rowid, std::size_t n_rows, int32_t n_threads,
+                                Visit&& visit) {
+    auto n_features = static_cast<std::size_t>(this->GetNumFeature());
+    missing_flags_.resize(feature_offsets_[n_features], true);
+    num_nonzeros_.resize(n_features, 0);
+    if (n_rows == 0) {
+      return;
+    }
+
+    std::size_t n_blocks = std::min(static_cast<std::size_t>(std::max(n_threads, 1)), n_rows);
+    std::size_t block_size = DivRoundUp(n_rows, n_blocks);
+    auto block_range = [&](std::size_t bidx) {
+      auto begin = std::min(bidx * block_size, n_rows);
+      return std::make_pair(begin, std::min(begin + block_size, n_rows));
+    };
+
+    // Count the entries of sparse columns for each block.
+    std::vector<std::size_t> block_offsets(n_blocks * n_features, 0);
+    ParallelFor(n_blocks, n_threads, [&](std::size_t bidx) {
+      auto* counts = block_offsets.data() + bidx * n_features;
+      auto [begin, end] = block_range(bidx);
+      for (std::size_t rid = begin; rid < end; ++rid) {
+        visit(rid, [&](bst_feature_t fidx, std::uint32_t) {
+          if (type_[fidx] == kSparseColumn) {
+            ++counts[fidx];
+          }
+        });
+      }
+    });
+    // Exclusive scan over blocks, starting from the entries of previous batches.
+    ParallelFor(n_features, n_threads, [&](std::size_t fidx) {
+      if (type_[fidx] == kSparseColumn) {
+        auto sum = num_nonzeros_[fidx];
+        for (std::size_t bidx = 0; bidx < n_blocks; ++bidx) {
+          auto n = block_offsets[bidx * n_features + fidx];
+          block_offsets[bidx * n_features + fidx] = sum;
+          sum += n;
+        }
+        num_nonzeros_[fidx] = sum;
+      }
+    });
+
+    // Missing flags are packed bits, rows close to the boundary of a block might share a
+    // word with other blocks.  Flags of those rows are set serially afterward.
+    constexpr std::size_t kBoundary = 512;
+    auto interior = [&](std::size_t bidx) {
+      auto [begin, end] = block_range(bidx);
+      auto head = std::min(begin + kBoundary, end);
+      auto tail = std::max(head, end - std::min(end, kBoundary));
+      return std::make_pair(head, tail);
+    };
+    auto set_valid = [&](std::size_t rid) {
+      visit(rid, [&](bst_feature_t fidx, std::uint32_t) {
+        if (type_[fidx] == kDenseColumn) {
+          missing_flags_[feature_offsets_[fidx] + rid + base_rowid] = false;
+        }
+      });
+    };
+
+    DispatchBinType(bins_type_size_, [&](auto t) {
+      using ColumnBinT = decltype(t);
+      ColumnBinT* local_index = reinterpret_cast<ColumnBinT*>(index_.data());
+      ParallelFor(n_blocks, n_threads, [&](std::size_t bidx) {
+        auto* cursor = block_offsets.data() + bidx * n_features;
+        auto [begin, end] = block_range(bidx);
+        auto [head, tail] = interior(bidx);
+        for (std::size_t rid = begin; rid < end; ++rid) {
+          auto r = rid + base_rowid;
+          bool set_flag = rid >= head && rid < tail;
+          visit(rid, [&](bst_feature_t fidx, std::uint32_t bin_idx) {
+            auto offset = feature_offsets_[fidx];
+            auto bin = static_cast<ColumnBinT>(bin_idx - index_base_[fidx]);
+            if (type_[fidx] == kDenseColumn) {
+              local_index[offset + r] = bin;
+              if (set_flag) {
+                missing_flags_[offset + r] = false;
+              }
+            } else {
+              auto k = offset + cursor[fidx]++;
+              local_index[k] = bin;
+              row_ind_[k] = r;
+            }
+          });
+        }
+      });
+    });
+
+    for (std::size_t bidx = 0; bidx < n_blocks; ++bidx) {
+      auto [begin, end] = block_range(bidx);
+      auto [head, tail] = interior(bidx);
+      for (std::size_t rid = begin; rid < head; ++rid) {
+        set_valid(rid);
+      }
+      for (std::size_t rid = tail; rid < end; ++rid) {
+        set_valid(rid);
+      }
     }
   }
 
@@ -184,18 +288,17 @@ class ColumnMatrix {
    *    This function requires a binary search for each bin to get back the feature index
    *    for those bins.
    */
-  void InitFromGHist(Context const* ctx, GHistIndexMatrix const& gmat) {
-    auto n_threads = ctx->Threads();
+  void InitFromGHist(int32_t n_threads, GHistIndexMatrix const& gmat) {
+    // Same as `InitFromSparse`, the column matrix uses the row index local to the page.
     if (!any_missing_) {
       // row index is compressed, we need to dispatch it.
       DispatchBinType(gmat.index.GetBinTypeSize(), [&, size = gmat.Size(), n_threads = n_threads,
                                                     n_features = gmat.Features()](auto t) {
         using RowBinIdxT = decltype(t);
-        SetIndexNoMissing(gmat.base_rowid, gmat.index.data<RowBinIdxT>(), size, n_features,
-                          n_threads);
+        SetIndexNoMissing(0, gmat.index.data<RowBinIdxT>(), size, n_features, n_threads);
       });
     } else {
-      SetIndexMixedColumns(gmat);
+      SetIndexMixedColumns(gmat, n_threads);
     }
   }
 
@@ -223,7 +326,7 @@ class ColumnMatrix {
         SetIndexNoMissing(base_rowid, gmat.index.data<RowBinIdxT>(), size, n_features, n_threads);
       });
     } else {
-      SetIndexMixedColumns(base_rowid, batch, gmat, missing);
+      SetIndexMixedColumns(base_rowid, batch, gmat, missing, n_threads);
     }
   }
 
@@ -288,28 +391,17 @@ class ColumnMatrix {
    */
   template <typename Batch>
   void SetIndexMixedColumns(size_t base_rowid, Batch const& batch, const GHistIndexMatrix& gmat,
-                            float missing) {
-    auto n_features = gmat.Features();
-    missing_flags_.resize(feature_offsets_[n_features], true);
-    auto const* row_index = gmat.index.data<uint32_t>() + gmat.row_ptr[base_rowid];
-    num_nonzeros_.resize(n_features, 0);
+                            float missing, int32_t n_threads) {
+    auto const* row_index = gmat.index.data<uint32_t>();
     auto is_valid = data::IsValidFunctor{missing};
-
-    DispatchBinType(bins_type_size_, [&](auto t) {
-      using ColumnBinT = decltype(t);
-      ColumnBinT* local_index = reinterpret_cast<ColumnBinT*>(index_.data());
-      size_t const batch_size = batch.Size();
-      size_t k{0};
-      for (size_t rid = 0; rid < batch_size; ++rid) {
-        auto line = batch.GetLine(rid);
-        for (size_t i = 0; i < line.Size(); ++i) {
-          auto coo = line.GetElement(i);
-          if (is_valid(coo)) {
-            auto fid = coo.column_idx;
-            const uint32_t bin_id = row_index[k];
-            SetBinSparse(bin_id, rid + base_rowid, fid, local_index);
-            ++k;
-          }
+    SetIndexMixedColumnsImpl(base_rowid, batch.Size(), n_threads, [&](size_t rid, auto&& fn) {
+      auto k = gmat.row_ptr[rid + base_rowid];
+      auto line = batch.GetLine(rid);
+      for (size_t i = 0; i < line.Size(); ++i) {
+        auto coo = line.GetElement(i);
+        if (is_valid(coo)) {
+          fn(static_cast<bst_feature_t>(coo.column_idx), row_index[k]);
+          ++k;
         }
       }
     });
@@ -317,21 +409,25 @@ class ColumnMatrix {
 
   /**
    * \brief Set column index for both dense and sparse columns, but with only GHistMatrix
-   *        available and requires a search for each bin.
+   *        available.  The feature index of each bin is recovered by searching the cut
+   *        pointers, the entries in a row are not required to be sorted by feature.
    */
-  void SetIndexMixedColumns(const GHistIndexMatrix& gmat) {
-    auto n_features = gmat.Features();
-    missing_flags_.resize(feature_offsets_[n_features], true);
-    num_nonzeros_.resize(n_features, 0);
-
-    DispatchBinType(bins_type_size_, [&](auto t) {
-      using ColumnBinT = decltype(t);
-      ColumnBinT* local_index = reinterpret_cast<ColumnBinT*>(index_.data());
-      CHECK(this->any_missing_);
-      AssignColumnBinIndex(gmat,
-                           [&](auto bin_idx, std::size_t, std::size_t ridx, bst_feature_t fidx) {
-                             SetBinSparse(bin_idx, ridx, fidx, local_index);
-                           });
+  void SetIndexMixedColumns(const GHistIndexMatrix& gmat, int32_t n_threads) {
+    CHECK(this->any_missing_);
+    CHECK_EQ(gmat.index.GetBinTypeSize(), kUint32BinsTypeSize);
+    auto const* row_index = gmat.index.data<uint32_t>();
+    auto const& ptrs = gmat.cut.Ptrs();
+    SetIndexMixedColumnsImpl(0, gmat.Size(), n_threads, [&](size_t rid, auto&& fn) {
+      bst_feature_t fidx{0};
+      for (auto j = gmat.row_ptr[rid]; j < gmat.row_ptr[rid + 1]; ++j) {
+        auto bin_idx = row_index[j];
+        if (bin_idx < ptrs[fidx] || bin_idx >= ptrs[fidx + 1]) {
+          // Search only when the bin is not in the same feature as the previous one.
+          auto it = std::upper_bound(ptrs.cbegin(), ptrs.cend(), bin_idx);
+          fidx = static_cast<bst_feature_t>(std::distance(ptrs.cbegin(), it) - 1);
+        }
+        fn(fidx, bin_idx);
+      }
     });
   }
 
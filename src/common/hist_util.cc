@@ -4,6 +4,7 @@
  */
 #include <dmlc/timer.h>
 
+#include <algorithm>  // for count
 #include <vector>
 
 #include "xgboost/base.h"
@@ -266,6 +267,7 @@ void RowsWiseBuildHistKernel(Span<GradientPair const> gpair,
 template <class BuildingManager>
 void ColsWiseBuildHistKernel(Span<GradientPair const> gpair,
                              const RowSetCollection::Elem row_indices, const GHistIndexMatrix &gmat,
+                             size_t cbegin, size_t cend, Span<std::uint8_t const> feature_mask,
                              GHistRow hist) {
   constexpr bool kAnyMissing = BuildingManager::kAnyMissing;
   constexpr bool kFirstPage = BuildingManager::kFirstPage;
@@ -286,13 +288,15 @@ void ColsWiseBuildHistKernel(Span<GradientPair const> gpair,
   };
 
   const size_t n_features = gmat.cut.Ptrs().size() - 1;
-  const size_t n_columns = n_features;
   auto hist_data = reinterpret_cast<double *>(hist.data());
   const uint32_t two{2};  // Each element from 'gpair' and 'hist' contains
                           // 2 FP values: gradient and hessian.
                           // So we need to multiply each row-index/bin-index by 2
                           // to work with gradient pairs as a singe row FP array
-  for (size_t cid = 0; cid < n_columns; ++cid) {
+  for (size_t cid = cbegin; cid < cend; ++cid) {
+    if (!feature_mask.empty() && !feature_mask[cid]) {
+      continue;
+    }
     const uint32_t offset = kAnyMissing ? 0 : offsets[cid];
     for (size_t i = 0; i < size; ++i) {
       const size_t row_id = rid[i];
@@ -318,9 +322,11 @@ void ColsWiseBuildHistKernel(Span<GradientPair const> gpair,
 
 template <class BuildingManager>
 void BuildHistDispatch(Span<GradientPair const> gpair, const RowSetCollection::Elem row_indices,
-                       const GHistIndexMatrix &gmat, GHistRow hist) {
+                       const GHistIndexMatrix &gmat, Span<std::uint8_t const> feature_mask,
+                       GHistRow hist) {
   if (BuildingManager::kReadByColumn) {
-    ColsWiseBuildHistKernel<BuildingManager>(gpair, row_indices, gmat, hist);
+    ColsWiseBuildHistKernel<BuildingManager>(gpair, row_indices, gmat, 0, gmat.Features(),
+                                             feature_mask, hist);
   } else {
     const size_t nrows = row_indices.Size();
     const size_t no_prefetch_size = Prefetch::NoPrefetchSize(nrows);
@@ -347,31 +353,60 @@ void BuildHistDispatch(Span<GradientPair const> gpair, const RowSetCollection::E
 template <bool any_missing>
 void GHistBuilder::BuildHist(Span<GradientPair const> gpair,
                              const RowSetCollection::Elem row_indices, const GHistIndexMatrix &gmat,
-                             GHistRow hist, bool force_read_by_column) const {
+                             GHistRow hist, bool force_read_by_column,
+                             Span<std::uint8_t const> feature_mask) const {
   /* force_read_by_column is used for testing the columnwise building of histograms.
    * default force_read_by_column = false
    */
   constexpr double kAdhocL2Size = 1024 * 1024 * 0.8;
   const bool hist_fit_to_l2 = kAdhocL2Size > 2 * sizeof(float) * gmat.cut.Ptrs().back();
   bool first_page = gmat.base_rowid == 0;
-  bool read_by_column = !hist_fit_to_l2 && !any_missing;
+  // Only the column-wise kernel can skip the masked features.  It's chosen for that only if
+  // most features are masked, as it reads the gradient index with stride.
+  bool skip_masked = !feature_mask.empty() &&
+                     2 * static_cast<std::size_t>(std::count(
+                             feature_mask.cbegin(), feature_mask.cend(), std::uint8_t{0})) >=
+                         feature_mask.size();
+  bool read_by_column = (!hist_fit_to_l2 || skip_masked) && !any_missing;
   auto bin_type_size = gmat.index.GetBinTypeSize();
 
   GHistBuildingManager<any_missing>::DispatchAndExecute(
       {first_page, read_by_column || force_read_by_column, bin_type_size}, [&](auto t) {
         using BuildingManager = decltype(t);
-        BuildHistDispatch<BuildingManager>(gpair, row_indices, gmat, hist);
+        BuildHistDispatch<BuildingManager>(gpair, row_indices, gmat, feature_mask, hist);
+      });
+}
+
+void GHistBuilder::BuildHistForFeatures(Span<GradientPair const> gpair,
+                                        const RowSetCollection::Elem row_indices,
+                                        const GHistIndexMatrix &gmat, bst_feature_t fbegin,
+                                        bst_feature_t fend, GHistRow hist,
+                                        Span<std::uint8_t const> feature_mask) const {
+  // With missing values the position of an entry inside a row doesn't identify its feature.
+  CHECK(gmat.IsDense());
+  CHECK_LE(fbegin, fend);
+  CHECK_LE(fend, gmat.Features());
+  bool first_page = gmat.base_rowid == 0;
+  auto bin_type_size = gmat.index.GetBinTypeSize();
+
+  GHistBuildingManager<false>::DispatchAndExecute(
+      {first_page, true, bin_type_size}, [&](auto t) {
+        using BuildingManager = decltype(t);
+        ColsWiseBuildHistKernel<BuildingManager>(gpair, row_indices, gmat, fbegin, fend,
+                                                 feature_mask, hist);
       });
 }
 
 template void GHistBuilder::BuildHist<true>(Span<GradientPair const> gpair,
                                             const RowSetCollection::Elem row_indices,
                                             const GHistIndexMatrix &gmat, GHistRow hist,
-                                            bool force_read_by_column) const;
+                                            bool force_read_by_column,
+                                            Span<std::uint8_t const> feature_mask) const;
 
 template void GHistBuilder::BuildHist<false>(Span<GradientPair const> gpair,
                                              const RowSetCollection::Elem row_indices,
                                              const GHistIndexMatrix &gmat, GHistRow hist,
-                                             bool force_read_by_column) const;
+                                             bool force_read_by_column,
+                                             Span<std::uint8_t const> feature_mask) const;
 }  // namespace common
 }  // namespace xgboost
@@ -8,7 +8,7 @@
 #define XGBOOST_COMMON_HIST_UTIL_H_
 
 #include <algorithm>
-#include <cstdint>  // for uint32_t
+#include <cstdint>  // for uint32_t, uint8_t
 #include <limits>
 #include <map>
 #include <memory>
@@ -204,7 +204,8 @@ auto DispatchBinType(BinTypeSize type, Fn&& fn) {
  *        data.
  *
  *   The main body of construction code is in gradient_index.cc, this struct is only a
- *   storage class.
+ *   storage class.  The bins can refer to read-only storage like a memory mapped cache
+ *   file, they are copied before the first modification.
  */
 struct Index {
   // Inside the compressor, bin_idx is the index for cut value across all features. By
@@ -239,9 +240,9 @@ struct Index {
       // dense, compressed
       auto fidx = i % bin_offset_.size();
       // restore the index by adding back its feature offset.
-      return func_(data_.data(), i) + bin_offset_[fidx];
+      return func_(this->Bytes(), i) + bin_offset_[fidx];
     } else {
-      return func_(data_.data(), i);
+      return func_(this->Bytes(), i);
     }
   }
   void SetBinTypeSize(BinTypeSize binTypeSize) {
@@ -266,39 +267,69 @@ struct Index {
   }
   template <typename T>
   T const* data() const {  // NOLINT
-    return reinterpret_cast<T const*>(data_.data());
+    return reinterpret_cast<T const*>(this->Bytes());
   }
   template <typename T>
   T* data() {  // NOLINT
+    this->Own();
     return reinterpret_cast<T*>(data_.data());
   }
   uint32_t const* Offset() const { return bin_offset_.data(); }
   size_t OffsetSize() const { return bin_offset_.size(); }
-  size_t Size() const { return data_.size() / (binTypeSize_); }
+  size_t Size() const { return this->NumBytes() / (binTypeSize_); }
 
   void Resize(const size_t n_bytes) {
+    this->Own();
     data_.resize(n_bytes);
   }
+  /**
+   * \brief Refer to the bins stored in `bins` instead of owning them.
+   *
+   * \param owner Keeps the storage alive while the index refers to it.
+   */
+  void SetView(Span<std::uint8_t const> bins, std::shared_ptr<void const> owner) {
+    std::vector<std::uint8_t>{}.swap(data_);
+    view_ = bins;
+    owner_ = std::move(owner);
+  }
+  [[nodiscard]] bool IsView() const { return static_cast<bool>(owner_); }
+  // Release the storage left by shrinking the index.
+  void ShrinkToFit() { data_.shrink_to_fit(); }
   // set the offset used in compression, cut_ptrs is the CSC indptr in HistogramCuts
   void SetBinOffset(std::vector<uint32_t> const& cut_ptrs) {
     bin_offset_.resize(cut_ptrs.size() - 1);  // resize to number of features.
     std::copy_n(cut_ptrs.begin(), bin_offset_.size(), bin_offset_.begin());
   }
-  std::vector<uint8_t>::const_iterator begin() const {  // NOLINT
-    return data_.begin();
+  std::uint8_t const* begin() const {  // NOLINT
+    return this->Bytes();
   }
-  std::vector<uint8_t>::const_iterator end() const {  // NOLINT
-    return data_.end();
+  std::uint8_t const* end() const {  // NOLINT
+    return this->Bytes() + this->NumBytes();
   }
 
   std::vector<uint8_t>::iterator begin() {  // NOLINT
+    this->Own();
     return data_.begin();
   }
   std::vector<uint8_t>::iterator end() {  // NOLINT
+    this->Own();
     return data_.end();
   }
 
  private:
+  [[nodiscard]] std::uint8_t const* Bytes() const {
+    return owner_ ? view_.data() : data_.data();
+  }
+  [[nodiscard]] std::size_t NumBytes() const { return owner_ ? view_.size() : data_.size(); }
+  // Copy the bins out of the borrowed storage.
+  void Own() {
+    if (owner_) {
+      data_.assign(view_.cbegin(), view_.cend());
+      view_ = {};
+      owner_.reset();
+    }
+  }
+
   // Functions to decompress the index.
   static uint32_t GetValueFromUint8(uint8_t const* t, size_t i) { return t[i]; }
   static uint32_t GetValueFromUint16(uint8_t const* t, size_t i) {
@@ -311,6 +342,9 @@ struct Index {
   using Func = uint32_t (*)(uint8_t const*, size_t);
 
   std::vector<uint8_t> data_;
+  // Borrowed storage of the bins, used instead of `data_` when `owner_` is set.
+  Span<std::uint8_t const> view_;
+  std::shared_ptr<void const> owner_;
   // starting position of each feature inside the cut values (the indptr of the CSC cut matrix
   // HistogramCuts without the last entry.) Used for bin compression.
   std::vector<uint32_t> bin_offset_;
@@ -510,6 +544,26 @@ class ParallelGHistBuilder {
     return hist;
   }
 
+  /**
+   * \brief Claim the histogram storing the result of a node for all threads, used when
+   *        threads write disjoint bins of the node directly.
+   *
+   * \return Whether the histogram is used for the first time since `Reset`, in which case
+   *         the caller must initialize it by zeroes.
+   */
+  bool ClaimTargetHist(size_t nid) {
+    CHECK_LT(nid, nodes_);
+    for (size_t tid = 0; tid < nthreads_; ++tid) {
+      if (threads_to_nids_map_[tid * nodes_ + nid] && tid_nid_to_hist_.at({tid, nid}) == -1) {
+        bool first_use = !hist_was_used_[tid * nodes_ + nid];
+        hist_was_used_[tid * nodes_ + nid] = static_cast<int>(true);
+        return first_use;
+      }
+    }
+    // No thread works on the node, it's empty and initialized by `ReduceHist`.
+    return false;
+  }
+
   // Reduce following bins (begin, end] for nid-node in dst across threads
   void ReduceHist(size_t nid, size_t begin, size_t end) const {
     CHECK_GT(end, begin);
@@ -636,11 +690,29 @@ class GHistBuilder {
   GHistBuilder() = default;
   explicit GHistBuilder(uint32_t nbins): nbins_{nbins} {}
 
-  // construct a histogram via histogram aggregation
+  /**
+   * \brief Construct a histogram via histogram aggregation.
+   *
+   * \param feature_mask Optional mask of features to be built, the bins of features with
+   *                     zero mask are skipped when the gradient index is read by column,
+   *                     which is chosen if at least half of the features are masked.
+   */
   template <bool any_missing>
   void BuildHist(Span<GradientPair const> gpair, const RowSetCollection::Elem row_indices,
                  const GHistIndexMatrix& gmat, GHistRow hist,
-                 bool force_read_by_column = false) const;
+                 bool force_read_by_column = false,
+                 Span<std::uint8_t const> feature_mask = {}) const;
+  /**
+   * \brief Build the histogram bins of features in [fbegin, fend) only, reading the
+   *        gradient index by column. Bins of other features are not touched, so disjoint
+   *        feature ranges of the same histogram can be built concurrently. Requires dense
+   *        data.
+   */
+  void BuildHistForFeatures(Span<GradientPair const> gpair,
+                            const RowSetCollection::Elem row_indices,
+                            const GHistIndexMatrix& gmat, bst_feature_t fbegin,
+                            bst_feature_t fend, GHistRow hist,
+                            Span<std::uint8_t const> feature_mask = {}) const;
   uint32_t GetNumBins() const {
       return nbins_;
   }
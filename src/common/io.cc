@@ -1,11 +1,12 @@
 /*!
  * Copyright (c) by XGBoost Contributors 2019-2022
  */
-#if defined(__unix__)
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
-#endif  // defined(__unix__)
+#endif  // defined(__unix__) || defined(__APPLE__)
 #include <algorithm>
 #include <fstream>
 #include <string>
@@ -143,6 +144,75 @@ std::string LoadSequentialFile(std::string uri, bool stream) {
   return buffer;
 }
 
+MmapFile::MmapFile(std::string path) : path_{std::move(path)} {
+#if defined(__unix__) || defined(__APPLE__)
+  auto fd = open(path_.c_str(), O_RDONLY);
+  CHECK_GE(fd, 0) << "Failed to open " << path_ << ": " << strerror(errno);
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    LOG(FATAL) << "Failed to get the size of " << path_ << ": " << strerror(errno);
+  }
+  size_ = static_cast<std::size_t>(st.st_size);
+  if (size_ != 0) {
+    auto ptr = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) {
+      close(fd);
+      LOG(FATAL) << "Failed to map " << path_ << ": " << strerror(errno);
+    }
+    ptr_ = static_cast<char*>(ptr);
+    // Pages are read in order during training.
+    madvise(ptr_, size_, MADV_SEQUENTIAL);
+  }
+  // The mapping is kept valid after closing the file descriptor.
+  close(fd);
+#else
+  LOG(FATAL) << "Memory mapped file is not supported on this platform.";
+#endif  // defined(__unix__) || defined(__APPLE__)
+}
+
+MmapFile::~MmapFile() {
+#if defined(__unix__) || defined(__APPLE__)
+  if (ptr_ != nullptr && munmap(ptr_, size_) != 0) {
+    LOG(WARNING) << "Failed to unmap " << path_ << ": " << strerror(errno);
+  }
+#endif  // defined(__unix__) || defined(__APPLE__)
+}
+
+MemoryFixSizeBuffer MmapFile::Stream(std::size_t offset, std::size_t n) const {
+  CHECK_LE(offset + n, size_);
+  // The buffer is only used for reading.
+  return MemoryFixSizeBuffer{ptr_ + offset, n};
+}
+
+void MmapFile::Advise(std::size_t offset, std::size_t n, int advice) const {
+#if defined(__unix__) || defined(__APPLE__)
+  if (ptr_ == nullptr || n == 0) {
+    return;
+  }
+  CHECK_LE(offset + n, size_);
+  // madvise requires an address aligned to the page size.
+  auto page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  auto aligned = offset / page_size * page_size;
+  auto ret = madvise(ptr_ + aligned, n + (offset - aligned), advice);
+  if (ret != 0) {
+    LOG(DEBUG) << "madvise failed for " << path_ << ": " << strerror(errno);
+  }
+#endif  // defined(__unix__) || defined(__APPLE__)
+}
+
+void MmapFile::WillNeed(std::size_t offset, std::size_t n) const {
+#if defined(__unix__) || defined(__APPLE__)
+  this->Advise(offset, n, MADV_WILLNEED);
+#endif  // defined(__unix__) || defined(__APPLE__)
+}
+
+void MmapFile::DontNeed(std::size_t offset, std::size_t n) const {
+#if defined(__unix__) || defined(__APPLE__)
+  this->Advise(offset, n, MADV_DONTNEED);
+#endif  // defined(__unix__) || defined(__APPLE__)
+}
+
 std::string FileExtension(std::string fname, bool lower) {
   if (lower) {
     std::transform(fname.begin(), fname.end(), fname.begin(),
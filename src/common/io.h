@@ -10,9 +10,11 @@
 
 #include <dmlc/io.h>
 #include <rabit/rabit.h>
-#include <string>
+
+#include <cstddef>  // for size_t
 #include <cstring>
 #include <fstream>
+#include <string>
 
 #include "common.h"
 
@@ -127,6 +129,51 @@ inline std::string ReadAll(std::string const &path) {
   return content;
 }
 
+/**
+ * \brief Read-only memory mapping of a local file.
+ *
+ *   Only available on POSIX systems, check `MmapFile::Supported()` before use.  Data read
+ *   through `Stream` is copied out of the mapping, the mapping must outlive the stream.
+ *   Objects referring to `Data()` directly keep a shared pointer to the mapping.
+ */
+class MmapFile {
+ public:
+  explicit MmapFile(std::string path);
+  ~MmapFile();
+  MmapFile(MmapFile const& that) = delete;
+  MmapFile& operator=(MmapFile const& that) = delete;
+
+  [[nodiscard]] static constexpr bool Supported() {
+#if defined(__unix__) || defined(__APPLE__)
+    return true;
+#else
+    return false;
+#endif  // defined(__unix__) || defined(__APPLE__)
+  }
+
+  [[nodiscard]] char const* Data() const { return ptr_; }
+  [[nodiscard]] std::size_t Size() const { return size_; }
+  /**
+   * \brief Get a stream for reading the byte range [offset, offset + n) of the file.
+   */
+  [[nodiscard]] MemoryFixSizeBuffer Stream(std::size_t offset, std::size_t n) const;
+  /**
+   * \brief Hint the kernel that the range [offset, offset + n) will be accessed soon.
+   */
+  void WillNeed(std::size_t offset, std::size_t n) const;
+  /**
+   * \brief Hint the kernel that the range [offset, offset + n) won't be accessed soon,
+   *        the mapped pages can be released.
+   */
+  void DontNeed(std::size_t offset, std::size_t n) const;
+
+ private:
+  void Advise(std::size_t offset, std::size_t n, int advice) const;
+
+  std::string path_;
+  char* ptr_{nullptr};
+  std::size_t size_{0};
+};
 }  // namespace common
 }  // namespace xgboost
 #endif  // XGBOOST_COMMON_IO_H_
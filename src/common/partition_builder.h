@@ -10,6 +10,7 @@
 #include <xgboost/data.h>
 
 #include <algorithm>
+#include <cstdint>
 #include <limits>
 #include <memory>
 #include <utility>
@@ -28,6 +29,9 @@ namespace common {
 // Responsible for:
 // 1) Effective memory allocation for intermediate results for multi-thread work
 // 2) Merging partial results produced by threads into original row set (row_set_collection_)
+// Alternatively, the decisions can be recorded with `PartitionDecision` and the rows are
+// scattered directly into a destination array with `ScatterToArray`, without any
+// intermediate buffer.
 // BlockSize is template to enable memory alignment easily with C++11 'alignas()' feature
 template<size_t BlockSize>
 class PartitionBuilder {
@@ -45,27 +49,20 @@ class PartitionBuilder {
     }
 
     if (n_tasks > max_n_tasks_) {
+      blocks_.resize(n_tasks);
       mem_blocks_.resize(n_tasks);
       max_n_tasks_ = n_tasks;
     }
   }
 
-  // split row indexes (rid_span) to 2 parts (left_part, right_part) depending
-  // on comparison of indexes values (idx_span) and split point (split_cond)
-  // Handle dense columns
-  // Analog of std::stable_partition, but in no-inplace manner
-  template <bool default_left, bool any_missing, typename ColumnType, typename Predicate>
-  inline std::pair<size_t, size_t> PartitionKernel(ColumnType* p_column,
-                                                   common::Span<const size_t> row_indices,
-                                                   common::Span<size_t> left_part,
-                                                   common::Span<size_t> right_part,
-                                                   size_t base_rowid, Predicate&& pred) {
+  // Decide the child node for each row index in rid_span depending on comparison of
+  // indexes values (idx_span) and split point (split_cond), the decision is passed to
+  // `emit` in the order of row indexes.
+  template <bool default_left, bool any_missing, typename ColumnType, typename Predicate,
+            typename Emit>
+  inline void PartitionKernel(ColumnType* p_column, common::Span<const size_t> row_indices,
+                              size_t base_rowid, Predicate&& pred, Emit&& emit) {
     auto& column = *p_column;
-    size_t* p_left_part = left_part.data();
-    size_t* p_right_part = right_part.data();
-    size_t nleft_elems = 0;
-    size_t nright_elems = 0;
-
     auto p_row_indices = row_indices.data();
     auto n_samples = row_indices.size();
 
@@ -73,51 +70,78 @@ class PartitionBuilder {
       auto rid = p_row_indices[i];
       const int32_t bin_id = column[rid - base_rowid];
       if (any_missing && bin_id == ColumnType::kMissingId) {
-        if (default_left) {
-          p_left_part[nleft_elems++] = rid;
-        } else {
-          p_right_part[nright_elems++] = rid;
-        }
+        emit(i, rid, default_left);
       } else {
-        if (pred(rid, bin_id)) {
-          p_left_part[nleft_elems++] = rid;
-        } else {
-          p_right_part[nright_elems++] = rid;
-        }
+        emit(i, rid, pred(rid, bin_id));
       }
     }
+  }
 
-    return {nleft_elems, nright_elems};
+  template <typename Pred, typename Emit>
+  inline void PartitionRangeKernel(common::Span<const size_t> ridx, Pred pred, Emit&& emit) {
+    for (size_t i = 0; i < ridx.size(); ++i) {
+      auto row_id = ridx[i];
+      emit(i, row_id, pred(row_id));
+    }
+  }
+
+  /**
+   * \brief Record the decision for each row instead of writing row indexes into the
+   *        intermediate buffers, the rows are moved to their final position by
+   *        `ScatterToArray` once the offsets are calculated. Used by the allocation-free
+   *        partitioning, which doesn't need `AllocateForTask`.
+   *
+   * \param decisions Decision for each row in the range, 1 for going left.
+   */
+  template <typename BinIdxType, bool any_missing, bool any_cat>
+  void PartitionDecision(const size_t node_in_set,
+                         std::vector<xgboost::tree::CPUExpandEntry> const& nodes,
+                         const common::Range1d range, const bst_bin_t split_cond,
+                         GHistIndexMatrix const& gmat, const common::ColumnMatrix& column_matrix,
+                         const RegTree& tree, const size_t* rid,
+                         common::Span<std::uint8_t> decisions) {
+    CHECK_EQ(decisions.size(), range.end() - range.begin());
+    std::uint8_t* p_decisions = decisions.data();
+    size_t n_left = 0;
+    this->template DispatchPartition<BinIdxType, any_missing, any_cat>(
+        node_in_set, nodes, range, split_cond, gmat, column_matrix, tree, rid,
+        [&](size_t i, size_t, bool go_left) {
+          p_decisions[i] = go_left;
+          n_left += go_left;
+        });
+
+    SetNLeftElems(node_in_set, range.begin(), n_left);
+    SetNRightElems(node_in_set, range.begin(), decisions.size() - n_left);
   }
 
-  template <typename Pred>
-  inline std::pair<size_t, size_t> PartitionRangeKernel(common::Span<const size_t> ridx,
-                                                        common::Span<size_t> left_part,
-                                                        common::Span<size_t> right_part,
-                                                        Pred pred) {
-    size_t* p_left_part = left_part.data();
-    size_t* p_right_part = right_part.data();
-    size_t nleft_elems = 0;
-    size_t nright_elems = 0;
-    for (auto row_id : ridx) {
-      if (pred(row_id)) {
-        p_left_part[nleft_elems++] = row_id;
+  /**
+   * \brief Move the rows in range to their final position in `rows_indexes` based on the
+   *        decisions recorded by `PartitionDecision`. Must be called after
+   *        `CalculateRowOffsets`.
+   */
+  void ScatterToArray(int nid, common::Range1d range, const size_t* rid,
+                      common::Span<std::uint8_t const> decisions, size_t* rows_indexes) {
+    size_t task_idx = GetTaskIdx(nid, range.begin());
+    size_t* p_left = rows_indexes + blocks_[task_idx].n_offset_left;
+    size_t* p_right = rows_indexes + blocks_[task_idx].n_offset_right;
+    std::uint8_t const* p_decisions = decisions.data();
+    for (size_t i = 0, n = range.end() - range.begin(); i < n; ++i) {
+      auto row_id = rid[range.begin() + i];
+      if (p_decisions[i]) {
+        *p_left++ = row_id;
       } else {
-        p_right_part[nright_elems++] = row_id;
+        *p_right++ = row_id;
       }
     }
-    return {nleft_elems, nright_elems};
   }
 
-  template <typename BinIdxType, bool any_missing, bool any_cat>
-  void Partition(const size_t node_in_set, std::vector<xgboost::tree::CPUExpandEntry> const &nodes,
-                 const common::Range1d range,
-                 const bst_bin_t split_cond, GHistIndexMatrix const& gmat,
-                 const common::ColumnMatrix& column_matrix,
-                 const RegTree& tree, const size_t* rid) {
+  template <typename BinIdxType, bool any_missing, bool any_cat, typename Emit>
+  void DispatchPartition(const size_t node_in_set,
+                         std::vector<xgboost::tree::CPUExpandEntry> const& nodes,
+                         const common::Range1d range, const bst_bin_t split_cond,
+                         GHistIndexMatrix const& gmat, const common::ColumnMatrix& column_matrix,
+                         const RegTree& tree, const size_t* rid, Emit&& emit) {
     common::Span<const size_t> rid_span(rid + range.begin(), rid + range.end());
-    common::Span<size_t> left = GetLeftBuffer(node_in_set, range.begin(), range.end());
-    common::Span<size_t> right = GetRightBuffer(node_in_set, range.begin(), range.end());
     std::size_t nid = nodes[node_in_set].nid;
     bst_feature_t fid = tree[nid].SplitIndex();
     bool default_left = tree[nid].DefaultLeft();
@@ -151,38 +175,27 @@ class PartitionBuilder {
       return go_left;
     };
 
-    std::pair<size_t, size_t> child_nodes_sizes;
     if (!column_matrix.IsInitialized()) {
-      child_nodes_sizes = PartitionRangeKernel(rid_span, left, right, pred_approx);
+      PartitionRangeKernel(rid_span, pred_approx, emit);
     } else {
       if (column_matrix.GetColumnType(fid) == xgboost::common::kDenseColumn) {
         auto column = column_matrix.DenseColumn<BinIdxType, any_missing>(fid);
         if (default_left) {
-          child_nodes_sizes = PartitionKernel<true, any_missing>(&column, rid_span, left, right,
-                                                                 gmat.base_rowid, pred_hist);
+          PartitionKernel<true, any_missing>(&column, rid_span, gmat.base_rowid, pred_hist, emit);
         } else {
-          child_nodes_sizes = PartitionKernel<false, any_missing>(&column, rid_span, left, right,
-                                                                  gmat.base_rowid, pred_hist);
+          PartitionKernel<false, any_missing>(&column, rid_span, gmat.base_rowid, pred_hist, emit);
         }
       } else {
         CHECK_EQ(any_missing, true);
         auto column =
             column_matrix.SparseColumn<BinIdxType>(fid, rid_span.front() - gmat.base_rowid);
         if (default_left) {
-          child_nodes_sizes = PartitionKernel<true, any_missing>(&column, rid_span, left, right,
-                                                                 gmat.base_rowid, pred_hist);
+          PartitionKernel<true, any_missing>(&column, rid_span, gmat.base_rowid, pred_hist, emit);
         } else {
-          child_nodes_sizes = PartitionKernel<false, any_missing>(&column, rid_span, left, right,
-                                                                  gmat.base_rowid, pred_hist);
+          PartitionKernel<false, any_missing>(&column, rid_span, gmat.base_rowid, pred_hist, emit);
         }
       }
     }
-
-    const size_t n_left  = child_nodes_sizes.first;
-    const size_t n_right = child_nodes_sizes.second;
-
-    SetNLeftElems(node_in_set, range.begin(), n_left);
-    SetNRightElems(node_in_set, range.begin(), n_right);
   }
 
   /**
@@ -249,16 +262,22 @@ class PartitionBuilder {
       return go_left;
     };
 
-    std::pair<size_t, size_t> child_nodes_sizes;
+    size_t* p_left_part = left.data();
+    size_t* p_right_part = right.data();
+    size_t n_left = 0;
+    size_t n_right = 0;
     if (!column_matrix.IsInitialized()) {
-      child_nodes_sizes = PartitionRangeKernel(rid_span, left, right, pred_approx);
+      PartitionRangeKernel(rid_span, pred_approx, [&](size_t, size_t row_id, bool go_left) {
+        if (go_left) {
+          p_left_part[n_left++] = row_id;
+        } else {
+          p_right_part[n_right++] = row_id;
+        }
+      });
     } else {
       LOG(FATAL) << "Column data split is only supported for the `approx` tree method";
     }
 
-    const size_t n_left  = child_nodes_sizes.first;
-    const size_t n_right = child_nodes_sizes.second;
-
     SetNLeftElems(node_in_set, range.begin(), n_left);
     SetNRightElems(node_in_set, range.begin(), n_right);
   }
@@ -266,8 +285,8 @@ class PartitionBuilder {
   // allocate thread local memory, should be called for each specific task
   void AllocateForTask(size_t id) {
     if (mem_blocks_[id].get() == nullptr) {
-      BlockInfo* local_block_ptr = new BlockInfo;
-      CHECK_NE(local_block_ptr, (BlockInfo*)nullptr);
+      BlockBuffer* local_block_ptr = new BlockBuffer;
+      CHECK_NE(local_block_ptr, (BlockBuffer*)nullptr);
       mem_blocks_[id].reset(local_block_ptr);
     }
   }
@@ -284,12 +303,12 @@ class PartitionBuilder {
 
   void SetNLeftElems(int nid, size_t begin, size_t n_left) {
     size_t task_idx = GetTaskIdx(nid, begin);
-    mem_blocks_.at(task_idx)->n_left = n_left;
+    blocks_.at(task_idx).n_left = n_left;
   }
 
   void SetNRightElems(int nid, size_t begin, size_t n_right) {
     size_t task_idx = GetTaskIdx(nid, begin);
-    mem_blocks_.at(task_idx)->n_right = n_right;
+    blocks_.at(task_idx).n_right = n_right;
   }
 
 
@@ -307,13 +326,13 @@ class PartitionBuilder {
     for (size_t i = 0; i < blocks_offsets_.size()-1; ++i) {
       size_t n_left = 0;
       for (size_t j = blocks_offsets_[i]; j < blocks_offsets_[i+1]; ++j) {
-        mem_blocks_[j]->n_offset_left = n_left;
-        n_left += mem_blocks_[j]->n_left;
+        blocks_[j].n_offset_left = n_left;
+        n_left += blocks_[j].n_left;
       }
       size_t n_right = 0;
       for (size_t j = blocks_offsets_[i]; j < blocks_offsets_[i + 1]; ++j) {
-        mem_blocks_[j]->n_offset_right = n_left + n_right;
-        n_right += mem_blocks_[j]->n_right;
+        blocks_[j].n_offset_right = n_left + n_right;
+        n_right += blocks_[j].n_right;
       }
       left_right_nodes_sizes_[i] = {n_left, n_right};
     }
@@ -322,14 +341,14 @@ class PartitionBuilder {
   void MergeToArray(int nid, size_t begin, size_t* rows_indexes) {
     size_t task_idx = GetTaskIdx(nid, begin);
 
-    size_t* left_result  = rows_indexes + mem_blocks_[task_idx]->n_offset_left;
-    size_t* right_result = rows_indexes + mem_blocks_[task_idx]->n_offset_right;
+    size_t* left_result  = rows_indexes + blocks_[task_idx].n_offset_left;
+    size_t* right_result = rows_indexes + blocks_[task_idx].n_offset_right;
 
     const size_t* left = mem_blocks_[task_idx]->Left();
     const size_t* right = mem_blocks_[task_idx]->Right();
 
-    std::copy_n(left, mem_blocks_[task_idx]->n_left, left_result);
-    std::copy_n(right, mem_blocks_[task_idx]->n_right, right_result);
+    std::copy_n(left, blocks_[task_idx].n_left, left_result);
+    std::copy_n(right, blocks_[task_idx].n_right, right_result);
   }
 
   size_t GetTaskIdx(int nid, size_t begin) {
@@ -343,7 +362,6 @@ class PartitionBuilder {
     auto& h_pos = *p_position;
     h_pos.resize(row_set.Data()->size(), std::numeric_limits<bst_node_t>::max());
 
-    auto p_begin = row_set.Data()->data();
     ParallelFor(row_set.Size(), ctx->Threads(), [&](size_t i) {
       auto const& node = row_set[i];
       if (node.node_id < 0) {
@@ -351,8 +369,7 @@ class PartitionBuilder {
       }
       CHECK(tree[node.node_id].IsLeaf());
       if (node.begin) {  // guard for empty node.
-        size_t ptr_offset = node.end - p_begin;
-        CHECK_LE(ptr_offset, row_set.Data()->size()) << node.node_id;
+        CHECK_LE(node.Size(), row_set.Data()->size()) << node.node_id;
         for (auto idx = node.begin; idx != node.end; ++idx) {
           h_pos[*idx] = sampledp(*idx) ? ~node.node_id : node.node_id;
         }
@@ -361,13 +378,15 @@ class PartitionBuilder {
   }
 
  protected:
-  struct BlockInfo{
+  struct BlockInfo {
     size_t n_left;
     size_t n_right;
 
     size_t n_offset_left;
     size_t n_offset_right;
-
+  };
+  // Intermediate buffers, only allocated for tasks that don't use `PartitionDecision`.
+  struct BlockBuffer {
     size_t* Left() {
       return &left_data_[0];
     }
@@ -381,7 +400,8 @@ class PartitionBuilder {
   };
   std::vector<std::pair<size_t, size_t>> left_right_nodes_sizes_;
   std::vector<size_t> blocks_offsets_;
-  std::vector<std::shared_ptr<BlockInfo>> mem_blocks_;
+  std::vector<BlockInfo> blocks_;
+  std::vector<std::shared_ptr<BlockBuffer>> mem_blocks_;
   size_t max_n_tasks_ = 0;
 };
 
@@ -3,13 +3,17 @@
  */
 #include "quantile.h"
 
+#include <algorithm>    // for copy_n, max
+#include <cstdint>      // for uint8_t, uint64_t
 #include <limits>
+#include <type_traits>  // for is_same_v
 #include <utility>
 
 #include "../collective/communicator-inl.h"
 #include "../data/adapter.h"
 #include "categorical.h"
 #include "hist_util.h"
+#include "threading_utils.h"  // for ParallelFor
 
 namespace xgboost {
 namespace common {
@@ -94,6 +98,25 @@ void HostSketchContainer::PushAdapterBatch(Batch const &batch, size_t base_rowid
 
   auto is_valid = data::IsValidFunctor{missing};
   auto weights = OptionalWeights{Span<float const>{h_weights}};
+  if constexpr (std::is_same_v<Batch, data::ColumnarAdapterBatch>) {
+    // Sketches are independent between features, push the columnar input one feature at a
+    // time so that each column is read sequentially.
+    ParallelFor(batch.NumCols(), n_threads_, Sched::Dyn(), [&](auto fidx) {
+      auto is_cat = IsCat(feature_types_, fidx);
+      for (std::size_t ridx = 0; ridx < batch.Size(); ++ridx) {
+        auto v = batch.GetValue(ridx, fidx);
+        if (!is_valid(v)) {
+          continue;
+        }
+        if (is_cat) {
+          categories_[fidx].emplace(v);
+        } else {
+          sketches_[fidx].Push(v, weights[ridx + base_rowid]);
+        }
+      }
+    });
+    return;
+  }
   // the nnz from info is not reliable as sketching might be the first place to go through
   // the data.
   auto is_dense = info.num_nonzero_ == info.num_col_ * info.num_row_;
@@ -106,6 +129,7 @@ void HostSketchContainer::PushAdapterBatch(Batch const &batch, size_t base_rowid
       data::_type const &batch, size_t base_rowid, MetaInfo const &info, float missing);
 
 INSTANTIATE(ArrayAdapterBatch)
+INSTANTIATE(ColumnarAdapterBatch)
 INSTANTIATE(CSRArrayAdapterBatch)
 INSTANTIATE(CSCAdapterBatch)
 INSTANTIATE(DataTableAdapterBatch)
@@ -139,67 +163,45 @@ struct QuantileAllreduce {
     return worker_values.subspan(feat_beg, feat_size);
   }
 };
-}  // anonymous namespace
 
-template <typename WQSketch>
-void SketchContainerImpl<WQSketch>::GatherSketchInfo(
-    std::vector<typename WQSketch::SummaryContainer> const &reduced,
-    std::vector<size_t> *p_worker_segments, std::vector<bst_row_t> *p_sketches_scan,
-    std::vector<typename WQSketch::Entry> *p_global_sketches) {
-  auto &worker_segments = *p_worker_segments;
-  worker_segments.resize(1, 0);
-  auto world = collective::GetWorldSize();
-  auto rank = collective::GetRank();
-  auto n_columns = sketches_.size();
+// Header of the fixed size slot storing the summary of one feature for allreduce, followed
+// by the summary entries.
+struct SummarySlotHeader {
+  std::uint64_t size{0};
+  // Maximum number of entries after merging.
+  std::uint64_t limit{0};
+};
 
-  // get the size of each feature.
-  std::vector<bst_row_t> sketch_size;
-  for (size_t i = 0; i < reduced.size(); ++i) {
-    if (IsCat(feature_types_, i)) {
-      sketch_size.push_back(0);
-    } else {
-      sketch_size.push_back(reduced[i].size);
-    }
-  }
-  // turn the size into CSC indptr
-  std::vector<bst_row_t> &sketches_scan = *p_sketches_scan;
-  sketches_scan.resize((n_columns + 1) * world, 0);
-  size_t beg_scan = rank * (n_columns + 1);  // starting storage for current worker.
-  std::partial_sum(sketch_size.cbegin(), sketch_size.cend(), sketches_scan.begin() + beg_scan + 1);
-
-  // Gather all column pointers
-  collective::Allreduce<collective::Operation::kSum>(sketches_scan.data(), sketches_scan.size());
-  for (int32_t i = 0; i < world; ++i) {
-    size_t back = (i + 1) * (n_columns + 1) - 1;
-    auto n_entries = sketches_scan.at(back);
-    worker_segments.push_back(n_entries);
-  }
-  // Offset of sketch from each worker.
-  std::partial_sum(worker_segments.begin(), worker_segments.end(), worker_segments.begin());
-  CHECK_GE(worker_segments.size(), 1);
-  auto total = worker_segments.back();
-
-  auto &global_sketches = *p_global_sketches;
-  global_sketches.resize(total, typename WQSketch::Entry{0, 0, 0, 0});
-  auto worker_sketch = Span<typename WQSketch::Entry>{global_sketches}.subspan(
-      worker_segments[rank], worker_segments[rank + 1] - worker_segments[rank]);
-  auto cursor{worker_sketch.begin()};
-  for (size_t fidx = 0; fidx < reduced.size(); ++fidx) {
-    auto const &sketch = reduced[fidx];
-    if (IsCat(feature_types_, fidx)) {
-      // nothing to do if it's categorical feature, size is 0 so no need to change cursor
+static_assert(sizeof(SummarySlotHeader) % sizeof(double) == 0);
+
+template <typename WQSketch>
+void MergeSummarySlots(void const *src, void *dst, std::size_t count, std::size_t slot_bytes) {
+  using Entry = typename WQSketch::Entry;
+  using Summary = typename WQSketch::Summary;
+  typename WQSketch::SummaryContainer combined;
+  for (std::size_t i = 0; i < count; ++i) {
+    auto const *s_header = reinterpret_cast<SummarySlotHeader const *>(
+        static_cast<std::uint8_t const *>(src) + i * slot_bytes);
+    auto *d_header =
+        reinterpret_cast<SummarySlotHeader *>(static_cast<std::uint8_t *>(dst) + i * slot_bytes);
+    if (s_header->size == 0) {
       continue;
-    } else {
-      cursor = std::copy(sketch.data, sketch.data + sketch.size, cursor);
     }
+    auto *d_entries = reinterpret_cast<Entry *>(d_header + 1);
+    Summary lhs{d_entries, d_header->size};
+    Summary rhs{const_cast<Entry *>(reinterpret_cast<Entry const *>(s_header + 1)),
+                s_header->size};
+    combined.Reserve(lhs.size + rhs.size);
+    combined.SetCombine(lhs, rhs);
+
+    Summary out{d_entries, 0};
+    out.SetPrune(combined, std::max(d_header->limit, s_header->limit));
+    CHECK_LE(out.size, (slot_bytes - sizeof(SummarySlotHeader)) / sizeof(Entry));
+    d_header->size = out.size;
+    d_header->limit = std::max(d_header->limit, s_header->limit);
   }
-
-  static_assert(sizeof(typename WQSketch::Entry) / 4 == sizeof(float),
-                "Unexpected size of sketch entry.");
-  collective::Allreduce<collective::Operation::kSum>(
-      reinterpret_cast<float *>(global_sketches.data()),
-      global_sketches.size() * sizeof(typename WQSketch::Entry) / sizeof(float));
 }
+}  // anonymous namespace
 
 template <typename WQSketch>
 void SketchContainerImpl<WQSketch>::AllreduceCategories() {
@@ -321,35 +323,40 @@ void SketchContainerImpl<WQSketch>::AllReduce(
     return;
   }
 
-  std::vector<size_t> worker_segments(1, 0);  // CSC pointer to sketches.
-  std::vector<bst_row_t> sketches_scan((n_columns + 1) * world, 0);
-
-  std::vector<typename WQSketch::Entry> global_sketches;
-  this->GatherSketchInfo(reduced, &worker_segments, &sketches_scan, &global_sketches);
-
-  std::vector<typename WQSketch::SummaryContainer> final_sketches(n_columns);
-
+  // Pack the summaries into fixed size slots.  Each hop of the allreduce merges two slots
+  // and prunes the result back to the intermediate number of cuts.
+  using Entry = typename WQSketch::Entry;
+  std::size_t max_num_cuts{0};
+  for (std::size_t i = 0; i < n_columns; ++i) {
+    if (!IsCat(feature_types_, i)) {
+      max_num_cuts = std::max(max_num_cuts, static_cast<std::size_t>(num_cuts[i]));
+    }
+  }
+  auto slot_bytes = sizeof(SummarySlotHeader) + max_num_cuts * sizeof(Entry);
+  std::vector<std::uint8_t> slots(slot_bytes * n_columns, 0);
   ParallelFor(n_columns, n_threads_, [&](auto fidx) {
-    // gcc raises subobject-linkage warning if we put allreduce_result as lambda capture
-    QuantileAllreduce<typename WQSketch::Entry> allreduce_result{global_sketches, worker_segments,
-                                                                 sketches_scan, n_columns};
-    int32_t intermediate_num_cuts = num_cuts[fidx];
-    auto nbytes = WQSketch::SummaryContainer::CalcMemCost(intermediate_num_cuts);
+    auto *header = reinterpret_cast<SummarySlotHeader *>(slots.data() + fidx * slot_bytes);
     if (IsCat(feature_types_, fidx)) {
       return;
     }
+    auto const &sketch = reduced[fidx];
+    header->size = sketch.size;
+    header->limit = num_cuts[fidx];
+    std::copy_n(sketch.data, sketch.size, reinterpret_cast<Entry *>(header + 1));
+  });
 
-    for (int32_t r = 0; r < world; ++r) {
-      // 1 feature of 1 worker
-      auto worker_feature = allreduce_result.Values(r, fidx);
-      CHECK(worker_feature.data());
-      typename WQSketch::Summary summary(worker_feature.data(), worker_feature.size());
-      auto &out = final_sketches.at(fidx);
-      out.Reduce(summary, nbytes);
-    }
+  collective::AllreduceCustom(slots.data(), slot_bytes, n_columns, MergeSummarySlots<WQSketch>);
 
-    reduced.at(fidx).Reserve(intermediate_num_cuts);
-    reduced.at(fidx).SetPrune(final_sketches.at(fidx), intermediate_num_cuts);
+  ParallelFor(n_columns, n_threads_, [&](auto fidx) {
+    if (IsCat(feature_types_, fidx)) {
+      return;
+    }
+    auto const *header =
+        reinterpret_cast<SummarySlotHeader const *>(slots.data() + fidx * slot_bytes);
+    auto &sketch = reduced[fidx];
+    sketch.Reserve(header->size);
+    std::copy_n(reinterpret_cast<Entry const *>(header + 1), header->size, sketch.data);
+    sketch.size = header->size;
   });
   monitor_.Stop(__func__);
 }
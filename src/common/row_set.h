@@ -95,14 +95,11 @@ class RowSetCollection {
                        size_t n_left, size_t n_right) {
     const Elem e = elem_of_each_node_[node_id];
 
-    size_t* all_begin{nullptr};
-    size_t* begin{nullptr};
+    // The node might be stored in an external buffer owned by the partitioner.
+    const size_t* begin = e.begin;
     if (e.begin == nullptr) {
       CHECK_EQ(n_left, 0);
       CHECK_EQ(n_right, 0);
-    } else {
-      all_begin = dmlc::BeginPtr(row_indices_);
-      begin = all_begin + (e.begin - all_begin);
     }
 
     CHECK_EQ(n_left + n_right, e.Size());
@@ -0,0 +1,91 @@
+/**
+ * Copyright 2023 by XGBoost Contributors
+ */
+#ifndef XGBOOST_COMMON_THREADPOOL_H_
+#define XGBOOST_COMMON_THREADPOOL_H_
+
+#include <condition_variable>  // for condition_variable
+#include <cstddef>             // for size_t
+#include <cstdint>             // for int32_t
+#include <functional>          // for function
+#include <future>              // for future, packaged_task
+#include <memory>              // for make_shared
+#include <mutex>               // for mutex, unique_lock
+#include <queue>               // for queue
+#include <thread>              // for thread
+#include <type_traits>         // for invoke_result_t
+#include <utility>             // for forward, move
+#include <vector>              // for vector
+
+#include "xgboost/logging.h"  // for CHECK_GE
+
+namespace xgboost::common {
+/**
+ * \brief A simple thread pool with a fixed number of workers, used for running blocking
+ *        tasks like I/O in the background without creating a new thread for each task.
+ */
+class ThreadPool {
+  std::mutex mu_;
+  std::queue<std::function<void()>> tasks_;
+  std::condition_variable cv_;
+  std::vector<std::thread> pool_;
+  bool stop_{false};
+
+ public:
+  explicit ThreadPool(std::int32_t n_threads) {
+    CHECK_GE(n_threads, 1);
+    for (std::int32_t i = 0; i < n_threads; ++i) {
+      pool_.emplace_back([this] {
+        while (true) {
+          std::unique_lock lock{mu_};
+          cv_.wait(lock, [this] { return !this->tasks_.empty() || stop_; });
+          if (this->tasks_.empty()) {
+            // stop_ is set and all tasks are finished.
+            return;
+          }
+          auto task = std::move(tasks_.front());
+          tasks_.pop();
+          lock.unlock();
+          task();
+        }
+      });
+    }
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard guard{mu_};
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& t : pool_) {
+      if (t.joinable()) {
+        t.join();
+      }
+    }
+  }
+
+  ThreadPool(ThreadPool const& that) = delete;
+  ThreadPool& operator=(ThreadPool const& that) = delete;
+
+  /**
+   * \brief Submit a task to the pool, exceptions thrown by the task are propagated through
+   *        the returned future.
+   */
+  template <typename Fn, typename R = std::invoke_result_t<Fn>>
+  [[nodiscard]] std::future<R> Submit(Fn&& fn) {
+    auto task = std::make_shared<std::packaged_task<R()>>(std::forward<Fn>(fn));
+    auto fut = task->get_future();
+    {
+      std::lock_guard guard{mu_};
+      CHECK(!stop_);
+      tasks_.emplace([task] { (*task)(); });
+    }
+    cv_.notify_one();
+    return fut;
+  }
+
+  [[nodiscard]] std::size_t Size() const { return pool_.size(); }
+};
+}  // namespace xgboost::common
+#endif  // XGBOOST_COMMON_THREADPOOL_H_
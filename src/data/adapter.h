@@ -9,6 +9,7 @@
 #include <algorithm>
 #include <cstddef>  // std::size_t
 #include <functional>
+#include <iterator>  // std::distance
 #include <limits>
 #include <map>
 #include <memory>
@@ -309,6 +310,124 @@ class ArrayAdapter : public detail::SingleBatchDataIter<ArrayAdapterBatch> {
   ArrayInterface<2> array_interface_;
 };
 
+/**
+ * \brief Batch of host columns.  Each column is a 1-dim array with an optional validity
+ *        bitmap, which matches the memory layout of primitive Arrow arrays.  Values are
+ *        read in place, masked values are returned as NaN.  The rows can be split into
+ *        chunks like the record batches of an Arrow table, so chunked columns are not
+ *        concatenated.
+ */
+class ColumnarAdapterBatch : public detail::NoMetaInfo {
+  // Columns of chunk `i` are stored in [i * n_features, (i + 1) * n_features).
+  common::Span<ArrayInterface<1> const> columns_;
+  // Row offset of each chunk, the size equals the number of chunks + 1.
+  common::Span<std::size_t const> chunk_ptr_;
+  std::size_t n_features_{0};
+
+  static float ReadValue(ArrayInterface<1> const& column, std::size_t ridx) {
+    return column.valid.Data() == nullptr || column.valid.Check(ridx)
+               ? column(ridx)
+               : std::numeric_limits<float>::quiet_NaN();
+  }
+  [[nodiscard]] std::size_t ChunkIdx(std::size_t ridx) const {
+    auto end = chunk_ptr_.data() + chunk_ptr_.size();
+    return std::distance(chunk_ptr_.data() + 1, std::upper_bound(chunk_ptr_.data() + 1, end, ridx));
+  }
+  [[nodiscard]] common::Span<ArrayInterface<1> const> ChunkColumns(std::size_t chunk) const {
+    return columns_.subspan(chunk * n_features_, n_features_);
+  }
+
+  class Line {
+    common::Span<ArrayInterface<1> const> columns_;
+    std::size_t ridx_;
+    std::size_t local_ridx_;
+
+   public:
+    Line(common::Span<ArrayInterface<1> const> columns, std::size_t ridx, std::size_t local_ridx)
+        : columns_{columns}, ridx_{ridx}, local_ridx_{local_ridx} {}
+
+    [[nodiscard]] std::size_t Size() const { return columns_.size(); }
+    [[nodiscard]] COOTuple GetElement(std::size_t idx) const {
+      return {ridx_, idx, ReadValue(columns_[idx], local_ridx_)};
+    }
+  };
+
+ public:
+  static constexpr bool kIsRowMajor = true;
+
+  ColumnarAdapterBatch() = default;
+  ColumnarAdapterBatch(common::Span<ArrayInterface<1> const> columns,
+                       common::Span<std::size_t const> chunk_ptr, std::size_t n_features)
+      : columns_{columns}, chunk_ptr_{chunk_ptr}, n_features_{n_features} {}
+
+  [[nodiscard]] Line GetLine(std::size_t ridx) const {
+    auto chunk = this->ChunkIdx(ridx);
+    return Line{this->ChunkColumns(chunk), ridx, ridx - chunk_ptr_[chunk]};
+  }
+  /**
+   * \brief Access a single value, used by algorithms that iterate over columns.
+   */
+  [[nodiscard]] float GetValue(std::size_t ridx, std::size_t fidx) const {
+    auto chunk = this->ChunkIdx(ridx);
+    return ReadValue(this->ChunkColumns(chunk)[fidx], ridx - chunk_ptr_[chunk]);
+  }
+
+  [[nodiscard]] std::size_t Size() const { return this->NumRows(); }
+  [[nodiscard]] std::size_t NumRows() const { return chunk_ptr_.empty() ? 0 : chunk_ptr_.back(); }
+  [[nodiscard]] std::size_t NumCols() const { return n_features_; }
+};
+
+/**
+ * Adapter for columnar data on host, like Arrow record batches.  The input is a JSON list
+ * of array interfaces, one for each column, see `CudfAdapter` for the device version.
+ * Chunked data like an Arrow table is specified as a list of chunks instead, each of them
+ * is a list of columns with the same number of rows.
+ */
+class ColumnarAdapter : public detail::SingleBatchDataIter<ColumnarAdapterBatch> {
+  std::vector<ArrayInterface<1>> columns_;
+  std::vector<std::size_t> chunk_ptr_{0};
+  ColumnarAdapterBatch batch_;
+  std::size_t n_features_{0};
+
+  void PushChunk(std::vector<Json> const& jcolumns) {
+    CHECK(!jcolumns.empty()) << "Number of columns must not equal to 0.";
+    if (columns_.empty()) {
+      n_features_ = jcolumns.size();
+    }
+    CHECK_EQ(jcolumns.size(), n_features_)
+        << "All chunks should have the same number of columns.";
+    auto begin = columns_.size();
+    for (auto const& jcol : jcolumns) {
+      columns_.emplace_back(get<Object const>(jcol));
+    }
+    auto n_rows = columns_[begin].Shape(0);
+    for (auto i = begin; i < columns_.size(); ++i) {
+      CHECK_EQ(columns_[i].Shape(0), n_rows) << "All columns should have the same number of rows.";
+    }
+    chunk_ptr_.push_back(chunk_ptr_.back() + n_rows);
+  }
+
+ public:
+  explicit ColumnarAdapter(StringView columns) {
+    auto jarray = Json::Load(columns);
+    auto const& jchunks = get<Array const>(jarray);
+    CHECK(!jchunks.empty()) << "Number of columns must not equal to 0.";
+    if (IsA<Object>(jchunks.front())) {
+      this->PushChunk(jchunks);
+    } else {
+      for (auto const& jchunk : jchunks) {
+        this->PushChunk(get<Array const>(jchunk));
+      }
+    }
+    batch_ = ColumnarAdapterBatch{common::Span<ArrayInterface<1> const>{columns_},
+                                  common::Span<std::size_t const>{chunk_ptr_}, n_features_};
+  }
+
+  [[nodiscard]] ColumnarAdapterBatch const& Value() const override { return batch_; }
+  [[nodiscard]] std::size_t NumRows() const { return chunk_ptr_.back(); }
+  [[nodiscard]] std::size_t NumColumns() const { return n_features_; }
+};
+
 class CSRArrayAdapterBatch : public detail::NoMetaInfo {
   ArrayInterface<1> indptr_;
   ArrayInterface<1> indices_;
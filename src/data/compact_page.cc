@@ -0,0 +1,103 @@
+/**
+ * Copyright 2023 by XGBoost Contributors
+ */
+#include "compact_page.h"
+
+#include <algorithm>  // for copy, any_of
+#include <limits>     // for numeric_limits
+
+#include "../common/threading_utils.h"  // for ParallelFor
+#include "xgboost/logging.h"            // for CHECK_EQ, CHECK_LT
+
+namespace xgboost::data {
+namespace {
+template <typename Fn>
+decltype(auto) DispatchIndexType(std::uint32_t n_bytes, Fn&& fn) {
+  switch (n_bytes) {
+    case sizeof(std::uint8_t):
+      return fn(std::uint8_t{});
+    case sizeof(std::uint16_t):
+      return fn(std::uint16_t{});
+    default: {
+      CHECK_EQ(n_bytes, sizeof(std::uint32_t));
+      return fn(std::uint32_t{});
+    }
+  }
+}
+}  // anonymous namespace
+
+CompactPage::CompactPage(SparsePage const& page, bst_feature_t n_features,
+                         std::int32_t n_threads)
+    : n_rows_{page.Size()}, base_rowid_{page.base_rowid} {
+  auto const& h_data = page.data.ConstHostVector();
+  auto const& h_offset = page.offset.ConstHostVector();
+  nnz_ = h_data.size();
+
+  if (n_features <= static_cast<bst_feature_t>(std::numeric_limits<std::uint8_t>::max()) + 1) {
+    index_bytes_ = sizeof(std::uint8_t);
+  } else if (n_features <=
+             static_cast<bst_feature_t>(std::numeric_limits<std::uint16_t>::max()) + 1) {
+    index_bytes_ = sizeof(std::uint16_t);
+  } else {
+    index_bytes_ = sizeof(std::uint32_t);
+  }
+
+  index_.resize(nnz_ * index_bytes_);
+  // Whether each thread has seen a value other than 1.
+  std::vector<std::uint8_t> non_binary(n_threads, 0);
+  DispatchIndexType(index_bytes_, [&](auto t) {
+    using T = decltype(t);
+    auto* index = reinterpret_cast<T*>(index_.data());
+    common::ParallelFor(nnz_, n_threads, [&](std::size_t i) {
+      auto const& e = h_data[i];
+      CHECK_LT(e.index, n_features);
+      index[i] = static_cast<T>(e.index);
+      if (e.fvalue != 1.0f) {
+        non_binary[omp_get_thread_num()] = 1;
+      }
+    });
+  });
+
+  if (std::any_of(non_binary.cbegin(), non_binary.cend(), [](auto v) { return v != 0; })) {
+    value_.resize(nnz_);
+    common::ParallelFor(nnz_, n_threads, [&](std::size_t i) { value_[i] = h_data[i].fvalue; });
+  }
+
+  if (nnz_ <= std::numeric_limits<std::uint32_t>::max()) {
+    offset32_.resize(h_offset.size());
+    common::ParallelFor(h_offset.size(), n_threads, [&](std::size_t i) {
+      offset32_[i] = static_cast<std::uint32_t>(h_offset[i]);
+    });
+  } else {
+    offset_ = h_offset;
+  }
+}
+
+void CompactPage::Decode(std::int32_t n_threads, SparsePage* out) const {
+  out->Clear();
+  out->SetBaseRowId(base_rowid_);
+
+  auto& h_offset = out->offset.HostVector();
+  if (offset_.empty()) {
+    h_offset.resize(offset32_.size());
+    common::ParallelFor(offset32_.size(), n_threads,
+                        [&](std::size_t i) { h_offset[i] = offset32_[i]; });
+  } else {
+    h_offset = offset_;
+  }
+  CHECK_EQ(out->Size(), n_rows_);
+
+  auto& h_data = out->data.HostVector();
+  h_data.resize(nnz_);
+  DispatchIndexType(index_bytes_, [&](auto t) {
+    using T = decltype(t);
+    auto const* index = reinterpret_cast<T const*>(index_.data());
+    if (this->IsBinary()) {
+      common::ParallelFor(nnz_, n_threads, [&](std::size_t i) { h_data[i] = {index[i], 1.0f}; });
+    } else {
+      common::ParallelFor(nnz_, n_threads,
+                          [&](std::size_t i) { h_data[i] = {index[i], value_[i]}; });
+    }
+  });
+}
+}  // namespace xgboost::data
@@ -0,0 +1,65 @@
+/**
+ * Copyright 2023 by XGBoost Contributors
+ *
+ * \file compact_page.h
+ * \brief Compact in-memory encoding of the row storage used by SimpleDMatrix.
+ */
+#ifndef XGBOOST_DATA_COMPACT_PAGE_H_
+#define XGBOOST_DATA_COMPACT_PAGE_H_
+
+#include <cstddef>  // for size_t
+#include <cstdint>  // for uint8_t, uint32_t, int32_t
+#include <vector>   // for vector
+
+#include "xgboost/base.h"  // for bst_feature_t, bst_row_t
+#include "xgboost/data.h"  // for SparsePage
+
+namespace xgboost::data {
+/**
+ * \brief Encoded form of a SparsePage.
+ *
+ *   - Feature indices are stored with the narrowest unsigned integer type that can hold the
+ *     number of features (8, 16 or 32 bits).
+ *   - Values are omitted when all of them equal 1, which is common for one-hot encoded or
+ *     bag-of-words data.
+ *   - Row offsets are stored as 32-bit integers when the number of entries allows.
+ *
+ *   The page can not be accessed directly, it must be decoded into a SparsePage first.
+ */
+class CompactPage {
+  std::vector<std::uint8_t> index_;
+  std::uint32_t index_bytes_{sizeof(bst_feature_t)};
+  // Empty if the page is binary.
+  std::vector<float> value_;
+  // Only one of the offsets is used.
+  std::vector<std::uint32_t> offset32_;
+  std::vector<bst_row_t> offset_;
+  std::size_t n_rows_{0};
+  std::size_t nnz_{0};
+  std::size_t base_rowid_{0};
+
+ public:
+  /**
+   * \param page       The page to be encoded.
+   * \param n_features Number of features in the DMatrix, all feature indices in the page
+   *                   must be smaller than it.
+   */
+  CompactPage(SparsePage const& page, bst_feature_t n_features, std::int32_t n_threads);
+  /**
+   * \brief Restore the original page.
+   */
+  void Decode(std::int32_t n_threads, SparsePage* out) const;
+
+  [[nodiscard]] std::size_t Size() const { return n_rows_; }
+  [[nodiscard]] bool IsBinary() const { return value_.empty(); }
+  [[nodiscard]] std::size_t IndexBytes() const { return index_bytes_; }
+  /**
+   * \brief Size of the encoded page in bytes, comparable to `SparsePage::MemCostBytes`.
+   */
+  [[nodiscard]] std::size_t MemCostBytes() const {
+    return index_.size() + value_.size() * sizeof(float) +
+           offset32_.size() * sizeof(std::uint32_t) + offset_.size() * sizeof(bst_row_t);
+  }
+};
+}  // namespace xgboost::data
+#endif  // XGBOOST_DATA_COMPACT_PAGE_H_
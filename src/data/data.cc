@@ -30,6 +30,7 @@
 #include "file_iterator.h"
 #include "simple_dmatrix.h"
 #include "sparse_page_writer.h"
+#include "text_parser.h"
 #include "validation.h"
 #include "xgboost/c_api.h"
 #include "xgboost/context.h"
@@ -786,8 +787,14 @@ DMatrix *TryLoadBinary(std::string fname, bool silent) {
       if (!DMLC_IO_NO_ENDIAN_SWAP) {
         dmlc::ByteSwap(&magic, sizeof(magic), 1);
       }
+      DMatrix *dmat{nullptr};
       if (magic == data::SimpleDMatrix::kMagic) {
-        DMatrix *dmat = new data::SimpleDMatrix(&is);
+        dmat = new data::SimpleDMatrix(&is);
+      } else if (magic == data::IterativeDMatrix::kMagic) {
+        fi.reset();
+        dmat = data::IterativeDMatrix::Load(fname);
+      }
+      if (dmat) {
         if (!silent) {
           LOG(CONSOLE) << dmat->Info().num_row_ << 'x' << dmat->Info().num_col_
                        << " matrix with " << dmat->Info().num_nonzero_
@@ -800,6 +807,39 @@ DMatrix *TryLoadBinary(std::string fname, bool silent) {
   return nullptr;
 }
 
+namespace {
+/**
+ * \brief Load a local text file with the native parser, the parsed CSR buffers are passed
+ *        to the array adapter directly.
+ */
+DMatrix* LoadTextFile(std::string const& path, data::TextParserParam param) {
+  Context ctx;
+  data::TextParser parser{path, std::move(param), ctx.Threads()};
+  parser.Next();
+  auto const& block = parser.Value();
+
+  using linalg::MakeVec;
+  auto indptr = linalg::ArrayInterfaceStr(MakeVec(block.offset.data(), block.offset.size()));
+  auto indices = linalg::ArrayInterfaceStr(MakeVec(block.index.data(), block.index.size()));
+  auto values = linalg::ArrayInterfaceStr(MakeVec(block.value.data(), block.value.size()));
+  data::CSRArrayAdapter adapter{StringView{indptr}, StringView{indices}, StringView{values},
+                                block.n_features};
+  auto* dmat = DMatrix::Create(&adapter, std::numeric_limits<float>::quiet_NaN(), ctx.Threads(),
+                               "");
+  auto& info = dmat->Info();
+  if (!block.label.empty()) {
+    info.SetInfo(ctx, "label", block.label.data(), DataType::kFloat32, block.label.size());
+  }
+  if (!block.weight.empty()) {
+    info.SetInfo(ctx, "weight", block.weight.data(), DataType::kFloat32, block.weight.size());
+  }
+  if (!block.qid.empty()) {
+    info.SetInfo(ctx, "qid", block.qid.data(), DataType::kUInt64, block.qid.size());
+  }
+  return dmat;
+}
+}  // namespace
+
 DMatrix* DMatrix::Load(const std::string& uri, bool silent, DataSplitMode data_split_mode,
                        const std::string& file_format) {
   auto need_split = false;
@@ -865,7 +905,12 @@ DMatrix* DMatrix::Load(const std::string& uri, bool silent, DataSplitMode data_s
 
   DMatrix* dmat {nullptr};
   try {
-    if (cache_file.empty()) {
+    std::string path;
+    data::TextParserParam param;
+    if (cache_file.empty() &&
+        data::TextParser::ParseUri(fname, file_format, npart, &path, &param)) {
+      dmat = LoadTextFile(path, std::move(param));
+    } else if (cache_file.empty()) {
       std::unique_ptr<dmlc::Parser<uint32_t>> parser(
           dmlc::Parser<uint32_t>::Create(fname.c_str(), partid, npart, file_format.c_str()));
       data::FileAdapter adapter(parser.get());
@@ -929,8 +974,9 @@ template <typename DataIterHandle, typename DMatrixHandle, typename DataIterRese
           typename XGDMatrixCallbackNext>
 DMatrix* DMatrix::Create(DataIterHandle iter, DMatrixHandle proxy, std::shared_ptr<DMatrix> ref,
                          DataIterResetCallback* reset, XGDMatrixCallbackNext* next, float missing,
-                         int nthread, bst_bin_t max_bin) {
-  return new data::IterativeDMatrix(iter, proxy, ref, reset, next, missing, nthread, max_bin);
+                         int nthread, bst_bin_t max_bin, std::size_t sketch_buffer_bytes) {
+  return new data::IterativeDMatrix(iter, proxy, ref, reset, next, missing, nthread, max_bin,
+                                    sketch_buffer_bytes);
 }
 
 template <typename DataIterHandle, typename DMatrixHandle,
@@ -939,9 +985,9 @@ DMatrix *DMatrix::Create(DataIterHandle iter, DMatrixHandle proxy,
                          DataIterResetCallback *reset,
                          XGDMatrixCallbackNext *next, float missing,
                          int32_t n_threads,
-                         std::string cache) {
+                         std::string cache, bool persistent_cache) {
   return new data::SparsePageDMatrix(iter, proxy, reset, next, missing, n_threads,
-                                     cache);
+                                     cache, persistent_cache);
 }
 
 template DMatrix* DMatrix::Create<DataIterHandle, DMatrixHandle, DataIterResetCallback,
@@ -949,12 +995,13 @@ template DMatrix* DMatrix::Create<DataIterHandle, DMatrixHandle, DataIterResetCa
                                                          std::shared_ptr<DMatrix> ref,
                                                          DataIterResetCallback* reset,
                                                          XGDMatrixCallbackNext* next, float missing,
-                                                         int nthread, int max_bin);
+                                                         int nthread, int max_bin,
+                                                         std::size_t sketch_buffer_bytes);
 
 template DMatrix *DMatrix::Create<DataIterHandle, DMatrixHandle,
                                   DataIterResetCallback, XGDMatrixCallbackNext>(
     DataIterHandle iter, DMatrixHandle proxy, DataIterResetCallback *reset,
-    XGDMatrixCallbackNext *next, float missing, int32_t n_threads, std::string);
+    XGDMatrixCallbackNext *next, float missing, int32_t n_threads, std::string, bool);
 
 template <typename AdapterT>
 DMatrix* DMatrix::Create(AdapterT* adapter, float missing, int nthread, const std::string&) {
@@ -1241,6 +1288,8 @@ void SparsePage::PushCSC(const SparsePage &batch) {
 
 template uint64_t SparsePage::Push(const data::DenseAdapterBatch& batch, float missing,
                                    int nthread);
+template uint64_t SparsePage::Push(const data::ColumnarAdapterBatch& batch, float missing,
+                                   int nthread);
 template uint64_t SparsePage::Push(const data::ArrayAdapterBatch& batch, float missing,
                                    int nthread);
 template uint64_t SparsePage::Push(const data::CSRAdapterBatch& batch, float missing, int nthread);
@@ -1257,6 +1306,7 @@ namespace data {
 
 // List of files that will be force linked in static links.
 DMLC_REGISTRY_LINK_TAG(sparse_page_raw_format);
+DMLC_REGISTRY_LINK_TAG(sparse_page_compressed_format);
 DMLC_REGISTRY_LINK_TAG(gradient_index_format);
 }  // namespace data
 }  // namespace xgboost
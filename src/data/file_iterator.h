@@ -11,9 +11,11 @@
 
 #include "dmlc/data.h"
 #include "xgboost/c_api.h"
+#include "xgboost/context.h"
 #include "xgboost/json.h"
 #include "xgboost/linalg.h"
 #include "array_interface.h"
+#include "text_parser.h"
 
 namespace xgboost {
 namespace data {
@@ -37,12 +39,17 @@ class FileIterator {
   DMatrixHandle proxy_;
 
   std::unique_ptr<dmlc::Parser<uint32_t>> parser_;
+  // Native parser for local CSV and LIBSVM files, used in place of the dmlc parser when
+  // the input is supported.
+  std::unique_ptr<TextParser> text_parser_;
   // Temporary reference to stage the data.
   dmlc::RowBlock<uint32_t, float> row_block_;
   // Storage for the array interface strings.
   std::string indptr_;
   std::string values_;
   std::string indices_;
+  // Size of each batch read by the native text parser.
+  static constexpr std::size_t kBlockBytes = static_cast<std::size_t>(64) << 20;
 
  public:
   FileIterator(std::string uri, unsigned part_index, unsigned num_parts,
@@ -56,10 +63,32 @@ class FileIterator {
   }
 
   int Next() {
+    using linalg::MakeVec;
+    if (text_parser_) {
+      if (!text_parser_->Next()) {
+        return false;
+      }
+      auto const& block = text_parser_->Value();
+      indptr_ = ArrayInterfaceStr(MakeVec(block.offset.data(), block.offset.size()));
+      values_ = ArrayInterfaceStr(MakeVec(block.value.data(), block.value.size()));
+      indices_ = ArrayInterfaceStr(MakeVec(block.index.data(), block.index.size()));
+      XGProxyDMatrixSetDataCSR(proxy_, indptr_.c_str(), indices_.c_str(), values_.c_str(),
+                               block.n_features);
+      if (!block.label.empty()) {
+        XGDMatrixSetDenseInfo(proxy_, "label", block.label.data(), block.Size(), 1);
+      }
+      if (!block.qid.empty()) {
+        XGDMatrixSetDenseInfo(proxy_, "qid", block.qid.data(), block.Size(), 4);
+      }
+      if (!block.weight.empty()) {
+        XGDMatrixSetDenseInfo(proxy_, "weight", block.weight.data(), block.Size(), 1);
+      }
+      return true;
+    }
+
     CHECK(parser_);
     if (parser_->Next()) {
       row_block_ = parser_->Value();
-      using linalg::MakeVec;
 
       indptr_ = ArrayInterfaceStr(MakeVec(row_block_.offset, row_block_.size + 1));
       values_ = ArrayInterfaceStr(MakeVec(row_block_.value, row_block_.offset[row_block_.size]));
@@ -95,6 +124,17 @@ class FileIterator {
 
   void Reset() {
     CHECK(!type_.empty());
+    if (text_parser_) {
+      text_parser_->BeforeFirst();
+      return;
+    }
+    std::string path;
+    TextParserParam param;
+    if (TextParser::ParseUri(uri_, type_, n_parts_, &path, &param)) {
+      text_parser_ = std::make_unique<TextParser>(path, std::move(param), Context{}.Threads(),
+                                                  kBlockBytes);
+      return;
+    }
     parser_.reset(dmlc::Parser<uint32_t>::Create(uri_.c_str(), part_idx_,
                                                  n_parts_, type_.c_str()));
   }
@@ -5,8 +5,10 @@
 #include "gradient_index.h"
 
 #include <algorithm>
+#include <iterator>  // std::distance
 #include <limits>
 #include <memory>
+#include <mutex>    // std::call_once
 #include <utility>  // std::forward
 
 #include "../common/column_matrix.h"
@@ -16,6 +18,19 @@
 #include "../common/transform_iterator.h"  // MakeIndexTransformIter
 
 namespace xgboost {
+namespace {
+// Dense index is compressed into the smallest type that can hold the bins of a feature.
+common::BinTypeSize IndexBinType(bst_bin_t max_num_bin_per_feat, bool is_dense) {
+  auto n_bins = max_num_bin_per_feat - 1;
+  if (is_dense && n_bins <= static_cast<bst_bin_t>(std::numeric_limits<std::uint8_t>::max())) {
+    return common::kUint8BinsTypeSize;
+  }
+  if (is_dense && n_bins <= static_cast<bst_bin_t>(std::numeric_limits<std::uint16_t>::max())) {
+    return common::kUint16BinsTypeSize;
+  }
+  return common::kUint32BinsTypeSize;
+}
+}  // anonymous namespace
 
 GHistIndexMatrix::GHistIndexMatrix() : columns_{std::make_unique<common::ColumnMatrix>()} {}
 
@@ -47,15 +62,13 @@ GHistIndexMatrix::GHistIndexMatrix(DMatrix *p_fmat, bst_bin_t max_bins_per_feat,
   for (const auto &batch : p_fmat->GetBatches<SparsePage>()) {
     this->PushBatch(batch, ft, n_threads);
   }
-  this->columns_ = std::make_unique<common::ColumnMatrix>();
-
   // hessian is empty when hist tree method is used or when dataset is empty
   if (hess.empty() && !std::isnan(sparse_thresh)) {
     // hist
     CHECK(!sorted_sketch);
-    for (auto const &page : p_fmat->GetBatches<SparsePage>()) {
-      this->columns_->InitFromSparse(page, *this, sparse_thresh, n_threads);
-    }
+    this->DeferColumns(n_threads, sparse_thresh);
+  } else {
+    this->DeferColumns(n_threads, std::numeric_limits<double>::quiet_NaN());
   }
 }
 
@@ -104,9 +117,174 @@ GHistIndexMatrix::GHistIndexMatrix(SparsePage const &batch, common::Span<Feature
   hit_count_tloc_.resize(n_threads * nbins, 0);
 
   this->PushBatch(batch, ft, n_threads);
+  this->DeferColumns(n_threads, sparse_thresh);
+}
+
+GHistIndexMatrix::GHistIndexMatrix(Context const *ctx, GHistIndexMatrix const &that,
+                                   common::Span<std::int32_t const> ridx, double sparse_thresh)
+    : row_ptr(ridx.size() + 1, 0),
+      hit_count(that.hit_count.size(), 0),
+      cut{that.cut},
+      max_numeric_bins_per_feat{that.max_numeric_bins_per_feat},
+      isDense_{that.isDense_} {
+  CHECK_EQ(that.base_rowid, 0);
+  auto n_threads = ctx->Threads();
+  auto it = common::MakeIndexTransformIter([&](std::size_t i) {
+    auto r = ridx[i];
+    CHECK_LT(static_cast<bst_row_t>(r), that.Size());
+    return that.row_ptr[r + 1] - that.row_ptr[r];
+  });
+  common::PartialSum(n_threads, it, it + ridx.size(), static_cast<size_t>(0), row_ptr.begin());
+
+  // Same bin type and bin offset as the source, the compressed bins can be copied as it is.
+  auto n_bytes = that.index.GetBinTypeSize();
+  index.SetBinTypeSize(n_bytes);
+  index.Resize(row_ptr.back() * n_bytes);
+  if (that.index.OffsetSize() != 0) {
+    index.SetBinOffset(cut.Ptrs());
+  }
+  auto const *src = that.index.data<std::uint8_t>();
+  auto *dst = index.data<std::uint8_t>();
+  common::ParallelFor(ridx.size(), n_threads, [&](std::size_t i) {
+    auto r = ridx[i];
+    std::copy_n(src + that.row_ptr[r] * n_bytes, (row_ptr[i + 1] - row_ptr[i]) * n_bytes,
+                dst + row_ptr[i] * n_bytes);
+  });
+
+  auto n_bins_total = cut.TotalBins();
+  hit_count_tloc_.resize(n_threads * n_bins_total, 0);
+  common::ParallelFor(row_ptr.back(), n_threads, [&](std::size_t i) {
+    auto tid = omp_get_thread_num();
+    ++hit_count_tloc_[tid * n_bins_total + index[i]];
+  });
+  this->GatherHitCount(n_threads, n_bins_total);
+
+  this->DeferColumns(n_threads, sparse_thresh);
+}
+
+void GHistIndexMatrix::Append(Context const *ctx, SparsePage const &page,
+                              common::Span<FeatureType const> ft, double sparse_thresh) {
+  auto n_threads = ctx->Threads();
+  if (row_ptr.empty()) {
+    row_ptr.push_back(0);
+  }
+  auto rbegin = this->Size();
+  CHECK_GE(page.Size(), rbegin);
+  auto h_page = page.GetView();
+  // View of the new rows, offsets are still relative to the beginning of page data.
+  auto view = HostSparsePageView{h_page.offset.subspan(rbegin), h_page.data};
+  if (view.Size() == 0) {
+    return;
+  }
+
+  row_ptr.resize(page.Size() + 1);
+  auto it = common::MakeIndexTransformIter([&](std::size_t ridx) { return view[ridx].size(); });
+  common::PartialSum(n_threads, it, it + view.Size(), row_ptr[rbegin], row_ptr.begin() + rbegin);
+
+  auto n_bins_total = cut.TotalBins();
+  hit_count_tloc_.clear();
+  hit_count_tloc_.resize(n_threads * n_bins_total, 0);
+  data::SparsePageAdapterBatch adapter_batch{view};
+  auto is_valid = [](auto) { return true; };  // SparsePage always contains valid entries
+  PushBatchImpl(n_threads, adapter_batch, rbegin, is_valid, ft);
+  this->ResetColumns(ctx, sparse_thresh);
+}
+
+void GHistIndexMatrix::DropPrefix(Context const *ctx, bst_row_t n_rows, double sparse_thresh) {
+  CHECK_EQ(base_rowid, 0);
+  CHECK_LE(n_rows, this->Size());
+  if (n_rows == 0) {
+    return;
+  }
+  auto n_threads = ctx->Threads();
+  auto n_entries = row_ptr[n_rows];
+
+  // Retire the dropped entries from the hit count.
+  auto n_bins_total = cut.TotalBins();
+  hit_count_tloc_.clear();
+  hit_count_tloc_.resize(n_threads * n_bins_total, 0);
+  common::ParallelFor(n_entries, n_threads, [&](std::size_t i) {
+    auto tid = omp_get_thread_num();
+    ++hit_count_tloc_[tid * n_bins_total + index[i]];
+  });
+  common::ParallelFor(n_bins_total, n_threads, [&](bst_omp_uint idx) {
+    for (int32_t tid = 0; tid < n_threads; ++tid) {
+      hit_count[idx] -= hit_count_tloc_[tid * n_bins_total + idx];
+      hit_count_tloc_[tid * n_bins_total + idx] = 0;
+    }
+  });
+
+  // Shift the bins and the row pointer to the front.
+  auto n_bytes = std::distance(index.begin(), index.end());
+  auto n_dropped_bytes = static_cast<decltype(n_bytes)>(n_entries * index.GetBinTypeSize());
+  std::copy(index.begin() + n_dropped_bytes, index.end(), index.begin());
+  index.Resize(n_bytes - n_dropped_bytes);
+
+  std::transform(row_ptr.cbegin() + n_rows, row_ptr.cend(), row_ptr.begin(),
+                 [&](std::size_t ptr) { return ptr - n_entries; });
+  row_ptr.resize(row_ptr.size() - n_rows);
+  this->ResetColumns(ctx, sparse_thresh);
+}
+
+void GHistIndexMatrix::Finalize(Context const *ctx, double sparse_thresh) {
+  CHECK(!isDense_);
+  CHECK(!row_ptr.empty());
+  auto n_threads = ctx->Threads();
+  auto n_features = static_cast<std::size_t>(this->Features());
+  auto n_rows = this->Size();
+  if (row_ptr.back() == n_rows * n_features) {
+    // Every row is full, the bin of the j^th entry in a row belongs to the j^th feature.
+    // The compressed bins are never wider than the uint32 bins, compress them in place
+    // one block of rows at a time.  A block is buffered before its storage is overwritten,
+    // the following blocks are stored after the compressed bins.
+    CHECK_EQ(index.GetBinTypeSize(), common::kUint32BinsTypeSize);
+    auto n_entries = row_ptr.back();
+    auto const &ptrs = cut.Ptrs();
+    std::size_t constexpr kBlockEntries = 1ul << 20;
+    std::size_t block_rows =
+        n_features == 0 ? n_rows : std::max(kBlockEntries / n_features, std::size_t{1});
+    std::vector<std::uint32_t> buffer(std::min(block_rows * n_features, n_entries));
+    common::DispatchBinType(IndexBinType(this->MaxNumBinPerFeat(), true), [&](auto dtype) {
+      using T = decltype(dtype);
+      auto const *bins = index.data<std::uint32_t>();
+      auto *data = index.data<T>();
+      for (std::size_t begin = 0; begin < n_rows; begin += block_rows) {
+        auto end = std::min(begin + block_rows, n_rows);
+        std::copy(bins + begin * n_features, bins + end * n_features, buffer.begin());
+        common::ParallelFor(end - begin, n_threads, [&](std::size_t i) {
+          for (std::size_t j = 0; j < n_features; ++j) {
+            auto k = i * n_features + j;
+            data[begin * n_features + k] = static_cast<T>(buffer[k] - ptrs[j]);
+          }
+        });
+      }
+    });
+    isDense_ = true;
+    ResizeIndex(n_entries, isDense_);
+    index.SetBinOffset(ptrs);
+    index.ShrinkToFit();
+  }
+
+  this->DeferColumns(n_threads, sparse_thresh);
+}
+
+void GHistIndexMatrix::ResetColumns(Context const *ctx, double sparse_thresh) {
+  bool has_columns = columns_once_ || (columns_ && columns_->IsInitialized());
+  if (!has_columns || std::isnan(sparse_thresh)) {
+    return;
+  }
+  // The column layout depends on the density of each feature, re-derive it from the
+  // quantized rows without searching the cuts again.
+  this->DeferColumns(ctx->Threads(), sparse_thresh);
+}
+
+void GHistIndexMatrix::DeferColumns(std::int32_t n_threads, double sparse_thresh) {
   this->columns_ = std::make_unique<common::ColumnMatrix>();
+  this->columns_once_.reset();
   if (!std::isnan(sparse_thresh)) {
-    this->columns_->InitFromSparse(batch, *this, sparse_thresh, n_threads);
+    this->columns_thresh_ = sparse_thresh;
+    this->columns_n_threads_ = n_threads;
+    this->columns_once_ = std::make_unique<std::once_flag>();
   }
 }
 
@@ -114,6 +292,12 @@ template <typename Batch>
 void GHistIndexMatrix::PushAdapterBatchColumns(Context const *ctx, Batch const &batch,
                                                float missing, size_t rbegin) {
   CHECK(columns_);
+  if (columns_once_) {
+    // Storage is allocated by the first batch, the matrix is no longer built lazily.
+    CHECK(!std::isnan(columns_thresh_));
+    this->columns_ = std::make_unique<common::ColumnMatrix>(*this, columns_thresh_);
+    this->columns_once_.reset();
+  }
   this->columns_->PushBatch(ctx->Threads(), batch, missing, *this, rbegin);
 }
 
@@ -123,29 +307,24 @@ void GHistIndexMatrix::PushAdapterBatchColumns(Context const *ctx, Batch const &
 
 INSTANTIATION_PUSH(data::CSRArrayAdapterBatch)
 INSTANTIATION_PUSH(data::ArrayAdapterBatch)
+INSTANTIATION_PUSH(data::ColumnarAdapterBatch)
 INSTANTIATION_PUSH(data::SparsePageAdapterBatch)
 
 #undef INSTANTIATION_PUSH
 
 void GHistIndexMatrix::ResizeIndex(const size_t n_index, const bool isDense) {
-  if ((MaxNumBinPerFeat() - 1 <= static_cast<int>(std::numeric_limits<uint8_t>::max())) &&
-      isDense) {
-    // compress dense index to uint8
-    index.SetBinTypeSize(common::kUint8BinsTypeSize);
-    index.Resize((sizeof(uint8_t)) * n_index);
-  } else if ((MaxNumBinPerFeat() - 1 > static_cast<int>(std::numeric_limits<uint8_t>::max()) &&
-              MaxNumBinPerFeat() - 1 <= static_cast<int>(std::numeric_limits<uint16_t>::max())) &&
-             isDense) {
-    // compress dense index to uint16
-    index.SetBinTypeSize(common::kUint16BinsTypeSize);
-    index.Resize((sizeof(uint16_t)) * n_index);
-  } else {
-    index.SetBinTypeSize(common::kUint32BinsTypeSize);
-    index.Resize((sizeof(uint32_t)) * n_index);
-  }
+  auto bin_type = IndexBinType(this->MaxNumBinPerFeat(), isDense);
+  index.SetBinTypeSize(bin_type);
+  index.Resize(static_cast<std::size_t>(bin_type) * n_index);
 }
 
 common::ColumnMatrix const &GHistIndexMatrix::Transpose() const {
+  if (columns_once_) {
+    std::call_once(*columns_once_, [this] {
+      this->columns_ = std::make_unique<common::ColumnMatrix>(*this, columns_thresh_);
+      this->columns_->InitFromGHist(columns_n_threads_, *this);
+    });
+  }
   CHECK(columns_);
   return *columns_;
 }
@@ -182,21 +361,22 @@ float GHistIndexMatrix::GetFvalue(size_t ridx, size_t fidx, bool is_cat) const {
     return common::HistogramCuts::NumericBinValue(ptrs, values, mins, fidx, bin_idx);
   };
 
-  if (columns_->GetColumnType(fidx) == common::kDenseColumn) {
-    if (columns_->AnyMissing()) {
-      return common::DispatchBinType(columns_->GetTypeSize(), [&](auto dtype) {
-        auto column = columns_->DenseColumn<decltype(dtype), true>(fidx);
+  auto const &columns = this->Transpose();
+  if (columns.GetColumnType(fidx) == common::kDenseColumn) {
+    if (columns.AnyMissing()) {
+      return common::DispatchBinType(columns.GetTypeSize(), [&](auto dtype) {
+        auto column = columns.DenseColumn<decltype(dtype), true>(fidx);
         return get_bin_val(column);
       });
     } else {
-      return common::DispatchBinType(columns_->GetTypeSize(), [&](auto dtype) {
-        auto column = columns_->DenseColumn<decltype(dtype), false>(fidx);
+      return common::DispatchBinType(columns.GetTypeSize(), [&](auto dtype) {
+        auto column = columns.DenseColumn<decltype(dtype), false>(fidx);
         return get_bin_val(column);
       });
     }
   } else {
-    return common::DispatchBinType(columns_->GetTypeSize(), [&](auto dtype) {
-      auto column = columns_->SparseColumn<decltype(dtype)>(fidx, 0);
+    return common::DispatchBinType(columns.GetTypeSize(), [&](auto dtype) {
+      auto column = columns.SparseColumn<decltype(dtype)>(fidx, 0);
       return get_bin_val(column);
     });
   }
@@ -210,6 +390,6 @@ bool GHistIndexMatrix::ReadColumnPage(dmlc::SeekStream *fi) {
 }
 
 size_t GHistIndexMatrix::WriteColumnPage(dmlc::Stream *fo) const {
-  return this->columns_->Write(fo);
+  return this->Transpose().Write(fo);
 }
 }  // namespace xgboost
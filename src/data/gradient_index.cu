@@ -105,7 +105,6 @@ GHistIndexMatrix::GHistIndexMatrix(Context const* ctx, MetaInfo const& info,
   CHECK(this->cut.cut_values_.HostCanRead());
   CHECK(this->cut.min_vals_.HostCanRead());
 
-  this->columns_ = std::make_unique<common::ColumnMatrix>(*this, p.sparse_thresh);
-  this->columns_->InitFromGHist(ctx, *this);
+  this->DeferColumns(ctx->Threads(), p.sparse_thresh);
 }
 }  // namespace xgboost
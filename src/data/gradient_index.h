@@ -9,7 +9,9 @@
 #include <atomic>     // for atomic
 #include <cinttypes>  // for uint32_t
 #include <cstddef>    // for size_t
+#include <limits>     // for numeric_limits
 #include <memory>
+#include <mutex>      // for once_flag
 #include <vector>
 
 #include "../common/categorical.h"
@@ -176,6 +178,13 @@ class GHistIndexMatrix {
                    common::HistogramCuts cuts, int32_t max_bins_per_feat, bool is_dense,
                    double sparse_thresh, int32_t n_threads);
   GHistIndexMatrix();  // also for ext mem, empty ctor so that we can read the cache back.
+  /**
+   * \brief Constructor for row subset view.  Take the quantized rows `ridx` from an
+   *        existing index, the cuts are shared and the feature values are not searched
+   *        again.
+   */
+  GHistIndexMatrix(Context const* ctx, GHistIndexMatrix const& that,
+                   common::Span<std::int32_t const> ridx, double sparse_thresh);
 
   template <typename Batch>
   void PushAdapterBatch(Context const* ctx, size_t rbegin, size_t prev_sum, Batch const& batch,
@@ -197,11 +206,38 @@ class GHistIndexMatrix {
     if (rbegin + batch.Size() == n_samples_total) {
       // finished
       CHECK(!std::isnan(sparse_thresh));
-      this->columns_ = std::make_unique<common::ColumnMatrix>(*this, sparse_thresh);
+      this->DeferColumns(n_threads, sparse_thresh);
     }
   }
 
-  // Call ColumnMatrix::PushBatch
+  /**
+   * \brief Quantize rows in `page` that are not yet in the index using the existing cuts,
+   *        used by appendable in-memory DMatrix.  The index must have the same dense
+   *        layout as the new rows.
+   *
+   * \param page          The row storage of the whole DMatrix, the first `Size()` rows are
+   *                      already quantized.
+   * \param sparse_thresh Threshold for rebuilding the column matrix.
+   */
+  void Append(Context const* ctx, SparsePage const& page, common::Span<FeatureType const> ft,
+              double sparse_thresh);
+  /**
+   * \brief Remove the first `n_rows` rows from the index.
+   */
+  void DropPrefix(Context const* ctx, bst_row_t n_rows, double sparse_thresh);
+
+  /**
+   * \brief Finish an index whose batches are pushed before the total number of entries is
+   *        known.  The batches are quantized with the sparse layout, switch to the compressed
+   *        dense layout if every row turns out to be full, then build the column matrix from
+   *        the quantized rows.
+   */
+  void Finalize(Context const* ctx, double sparse_thresh);
+
+  /**
+   * \brief Push the raw batch into the column matrix instead of building it from the
+   *        quantized rows on first access.  Must be called for all batches in order.
+   */
   template <typename Batch>
   void PushAdapterBatchColumns(Context const* ctx, Batch const& batch, float missing,
                                size_t rbegin);
@@ -230,10 +266,21 @@ class GHistIndexMatrix {
 
   bst_row_t Size() const { return row_ptr.empty() ? 0 : row_ptr.size() - 1; }
   bst_feature_t Features() const { return cut.Ptrs().size() - 1; }
+  /** \brief Estimation of memory cost of this page, excluding the column matrix. */
+  [[nodiscard]] std::size_t MemCostBytes() const {
+    return row_ptr.size() * sizeof(std::size_t) +
+           index.Size() * static_cast<std::size_t>(index.GetBinTypeSize()) +
+           hit_count.size() * sizeof(std::size_t) + cut.Ptrs().size() * sizeof(std::uint32_t) +
+           (cut.Values().size() + cut.MinValues().size()) * sizeof(float);
+  }
 
   bool ReadColumnPage(dmlc::SeekStream* fi);
   size_t WriteColumnPage(dmlc::Stream* fo) const;
 
+  /**
+   * \brief Get the column matrix, which is built on the first call as it's only required
+   *        by the `hist` tree method.
+   */
   common::ColumnMatrix const& Transpose() const;
 
   bst_bin_t GetGindex(size_t ridx, size_t fidx) const;
@@ -241,7 +288,17 @@ class GHistIndexMatrix {
   float GetFvalue(size_t ridx, size_t fidx, bool is_cat) const;
 
  private:
-  std::unique_ptr<common::ColumnMatrix> columns_;
+  // Rebuild the column matrix from the quantized rows if it has been initialized.
+  void ResetColumns(Context const* ctx, double sparse_thresh);
+  // Build the column matrix from the quantized rows on the first call to `Transpose`, the
+  // column matrix is left uninitialized if the threshold is NaN.
+  void DeferColumns(std::int32_t n_threads, double sparse_thresh);
+
+  mutable std::unique_ptr<common::ColumnMatrix> columns_;
+  // Set when the construction of the column matrix is pending or finished.
+  mutable std::unique_ptr<std::once_flag> columns_once_;
+  double columns_thresh_{std::numeric_limits<double>::quiet_NaN()};
+  std::int32_t columns_n_threads_{1};
   std::vector<size_t> hit_count_tloc_;
   bool isDense_;
 };
@@ -1,6 +1,16 @@
 /*!
  * Copyright 2021-2022 XGBoost contributors
  */
+#include <algorithm>    // for copy_n
+#include <array>        // for array
+#include <cstdint>      // for uint8_t, uint64_t, uintptr_t
+#include <iterator>     // for distance
+#include <memory>       // for shared_ptr
+#include <type_traits>  // for underlying_type_t
+#include <utility>      // for move
+
+#include "../common/common.h"  // for DivRoundUp
+#include "../common/io.h"      // for MmapFile
 #include "sparse_page_writer.h"
 #include "gradient_index.h"
 #include "histogram_cut_format.h"
@@ -8,20 +18,25 @@
 namespace xgboost {
 namespace data {
 class GHistIndexRawFormat : public SparsePageFormat<GHistIndexMatrix> {
- public:
-  bool Read(GHistIndexMatrix* page, dmlc::SeekStream* fi) override {
+  /**
+   * \param read_bins Load `n_bytes` bins starting at the current position of `fi`.
+   */
+  template <typename Fn>
+  static bool ReadImpl(GHistIndexMatrix *page, dmlc::SeekStream *fi, Fn &&read_bins) {
     if (!ReadHistogramCuts(&page->cut, fi)) {
       return false;
     }
     // indptr
     fi->Read(&page->row_ptr);
-    // data
-    std::vector<uint8_t> data;
-    if (!fi->Read(&data)) {
+    // data, aligned relative to the start of the page
+    std::uint64_t n_bytes{0}, n_padding{0};
+    if (!fi->Read(&n_bytes) || !fi->Read(&n_padding)) {
+      return false;
+    }
+    fi->Seek(fi->Tell() + n_padding);
+    if (!read_bins(n_bytes)) {
       return false;
     }
-    page->index.Resize(data.size());
-    std::copy(data.cbegin(), data.cend(), page->index.begin());
     // bin type
     // Old gcc doesn't support reading from enum.
     std::underlying_type_t<common::BinTypeSize> uint_bin_type{0};
@@ -54,6 +69,34 @@ class GHistIndexRawFormat : public SparsePageFormat<GHistIndexMatrix> {
     return true;
   }
 
+ public:
+  bool Read(GHistIndexMatrix* page, dmlc::SeekStream* fi) override {
+    return ReadImpl(page, fi, [&](std::uint64_t n_bytes) {
+      page->index.Resize(n_bytes);
+      return n_bytes == 0 || fi->Read(page->index.data<std::uint8_t>(), n_bytes) == n_bytes;
+    });
+  }
+
+  bool ReadMapped(GHistIndexMatrix *page, std::shared_ptr<common::MmapFile const> mmap,
+                  std::size_t offset, std::size_t n) override {
+    auto fi = mmap->Stream(offset, n);
+    return ReadImpl(page, &fi, [&](std::uint64_t n_bytes) {
+      if (fi.Tell() + n_bytes > n) {
+        return false;
+      }
+      auto const *bins = reinterpret_cast<std::uint8_t const *>(mmap->Data()) + offset + fi.Tell();
+      if (reinterpret_cast<std::uintptr_t>(bins) % alignof(std::uint32_t) != 0) {
+        // Not aligned for the bin type, like a page written by another stream.
+        page->index.Resize(n_bytes);
+        std::copy_n(bins, n_bytes, page->index.data<std::uint8_t>());
+      } else {
+        page->index.SetView({bins, static_cast<std::size_t>(n_bytes)}, std::move(mmap));
+      }
+      fi.Seek(fi.Tell() + n_bytes);
+      return true;
+    });
+  }
+
   size_t Write(GHistIndexMatrix const &page, dmlc::Stream *fo) override {
     size_t bytes = 0;
     bytes += WriteHistogramCuts(page.cut, fo);
@@ -61,10 +104,17 @@ class GHistIndexRawFormat : public SparsePageFormat<GHistIndexMatrix> {
     fo->Write(page.row_ptr);
     bytes += page.row_ptr.size() * sizeof(decltype(page.row_ptr)::value_type) +
              sizeof(uint64_t);
-    // data
-    std::vector<uint8_t> data(page.index.begin(), page.index.end());
-    fo->Write(data);
-    bytes += data.size() * sizeof(decltype(data)::value_type) + sizeof(uint64_t);
+    // data, aligned relative to the start of the page
+    std::uint64_t n_bytes = std::distance(page.index.begin(), page.index.end());
+    bytes += sizeof(n_bytes) * 2;
+    std::uint64_t n_padding = common::DivRoundUp(bytes, kPageAlignment) * kPageAlignment - bytes;
+    fo->Write(n_bytes);
+    fo->Write(n_padding);
+    std::array<std::uint8_t, kPageAlignment> padding{};
+    fo->Write(padding.data(), n_padding);
+    bytes += n_padding;
+    fo->Write(page.index.begin(), n_bytes);
+    bytes += n_bytes;
     // bin type
     std::underlying_type_t<common::BinTypeSize> uint_bin_type =
         page.index.GetBinTypeSize();
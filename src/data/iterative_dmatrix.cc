@@ -5,16 +5,19 @@
 
 #include <algorithm>    // std::copy
 #include <cstddef>      // std::size_t
-#include <type_traits>  // std::underlying_type_t
+#include <limits>       // std::numeric_limits
+#include <type_traits>  // std::underlying_type_t, std::decay_t, std::is_same_v
 #include <vector>       // std::vector
 
 #include "../collective/communicator-inl.h"
 #include "../common/categorical.h"  // common::IsCat
 #include "../common/column_matrix.h"
+#include "../common/io.h"  // for MmapFile
 #include "../tree/param.h"  // FIXME(jiamingy): Find a better way to share this parameter.
 #include "gradient_index.h"
 #include "proxy_dmatrix.h"
 #include "simple_batch_iterator.h"
+#include "sparse_page_writer.h"  // for CreatePageFormat
 #include "xgboost/data.h"  // FeatureType
 #include "xgboost/logging.h"
 
@@ -23,7 +26,7 @@ namespace data {
 IterativeDMatrix::IterativeDMatrix(DataIterHandle iter_handle, DMatrixHandle proxy,
                                    std::shared_ptr<DMatrix> ref, DataIterResetCallback* reset,
                                    XGDMatrixCallbackNext* next, float missing, int nthread,
-                                   bst_bin_t max_bin)
+                                   bst_bin_t max_bin, std::size_t sketch_buffer_bytes)
     : proxy_{proxy}, reset_{reset}, next_{next} {
   // fetch the first batch
   auto iter =
@@ -45,9 +48,14 @@ IterativeDMatrix::IterativeDMatrix(DataIterHandle iter_handle, DMatrixHandle pro
 
   ctx_.UpdateAllowUnknown(
       Args{{"nthread", std::to_string(nthread)}, {"gpu_id", std::to_string(d)}});
-  if (ctx_.IsCPU()) {
+  if (ctx_.IsCPU() && sketch_buffer_bytes != 0) {
+    this->InitSinglePass(iter_handle, missing, ref, sketch_buffer_bytes);
+  } else if (ctx_.IsCPU()) {
     this->InitFromCPU(iter_handle, missing, ref);
   } else {
+    if (sketch_buffer_bytes != 0) {
+      LOG(WARNING) << "`sketch_buffer_bytes` is ignored for GPU input.";
+    }
     this->InitFromCUDA(iter_handle, missing, ref);
   }
 }
@@ -135,6 +143,19 @@ void IterativeDMatrix::InitFromCPU(DataIterHandle iter_handle, float missing,
     return HostAdapterDispatch(proxy, [&](auto const& value) {
       size_t n_threads = ctx_.Threads();
       size_t n_features = column_sizes.size();
+      if constexpr (std::is_same_v<std::decay_t<decltype(value)>, ColumnarAdapterBatch>) {
+        // Count the valid values of each column in place.
+        std::vector<std::size_t> batch_sizes(n_features, 0);
+        common::ParallelFor(n_features, n_threads, common::Sched::Dyn(), [&](auto fidx) {
+          for (std::size_t i = 0; i < value.Size(); ++i) {
+            batch_sizes[fidx] += is_valid(value.GetValue(i, fidx));
+          }
+        });
+        for (size_t fidx = 0; fidx < n_features; ++fidx) {
+          column_sizes[fidx] += batch_sizes[fidx];
+        }
+        return std::accumulate(batch_sizes.cbegin(), batch_sizes.cend(), static_cast<size_t>(0));
+      }
       linalg::Tensor<std::size_t, 2> column_sizes_tloc({n_threads, n_features}, Context::kCpuId);
       column_sizes_tloc.Data()->Fill(0ul);
       auto view = column_sizes_tloc.HostView();
@@ -257,19 +278,7 @@ void IterativeDMatrix::InitFromCPU(DataIterHandle iter_handle, float missing,
   }
   iter.Reset();
   CHECK_EQ(rbegin, Info().num_row_);
-
-  /**
-   * Generate column matrix
-   */
-  accumulated_rows = 0;
-  while (iter.Next()) {
-    HostAdapterDispatch(proxy, [&](auto const& batch) {
-      this->ghist_->PushAdapterBatchColumns(&ctx_, batch, missing, accumulated_rows);
-    });
-    accumulated_rows += num_rows();
-  }
-  iter.Reset();
-  CHECK_EQ(accumulated_rows, Info().num_row_);
+  // The column matrix is built from the gradient index on first use.
 
   if (n_batches == 1) {
     this->info_ = std::move(proxy->Info());
@@ -281,6 +290,176 @@ void IterativeDMatrix::InitFromCPU(DataIterHandle iter_handle, float missing,
   Info().feature_types.HostVector() = h_ft;
 }
 
+void IterativeDMatrix::InitSinglePass(DataIterHandle iter_handle, float missing,
+                                      std::shared_ptr<DMatrix> ref, std::size_t buffer_bytes) {
+  DMatrixProxy* proxy = MakeProxy(proxy_);
+  CHECK(proxy);
+
+  // The external iterator, the first batch is fetched in ctor.
+  auto iter =
+      DataIterProxy<DataIterResetCallback, XGDMatrixCallbackNext>{iter_handle, reset_, next_};
+  auto num_cols = [&]() {
+    return HostAdapterDispatch(proxy, [](auto const& value) { return value.NumCols(); });
+  };
+  auto n_threads = ctx_.Threads();
+
+  bst_feature_t n_features{0};
+  std::vector<FeatureType> h_ft;
+  // Buffered batches along with their meta info, which provides the weights for sketching.
+  std::vector<SparsePage> pages;
+  std::vector<MetaInfo> infos;
+  std::size_t n_buffered_bytes{0};
+
+  // Quantize a batch and append it to the end of the gradient index.
+  auto push = [&](auto const& batch, float missing) {
+    auto rbegin = this->ghist_->Size();
+    this->ghist_->row_ptr.resize(rbegin + batch.Size() + 1);
+    // The total number of samples is unknown, the column matrix is built in `Finalize`.
+    this->ghist_->PushAdapterBatch(&ctx_, rbegin, this->ghist_->row_ptr[rbegin], batch, missing,
+                                   h_ft, batch_param_.sparse_thresh,
+                                   std::numeric_limits<std::size_t>::max());
+  };
+  // Generate the cuts, then quantize the buffered batches.
+  auto make_index = [&]() {
+    common::HistogramCuts cuts;
+    if (ref) {
+      GetCutsFromRef(ref, n_features, batch_param_, &cuts);
+    } else {
+      CHECK(!pages.empty());
+      std::vector<std::size_t> column_sizes(n_features, 0);
+      for (auto const& page : pages) {
+        auto sizes = common::CalcColumnSize(SparsePageAdapterBatch{page.GetView()}, n_features,
+                                            n_threads, [](auto) { return true; });
+        for (bst_feature_t fidx = 0; fidx < n_features; ++fidx) {
+          column_sizes[fidx] += sizes[fidx];
+        }
+      }
+      auto use_group = !infos.front().group_ptr_.empty();
+      common::HostSketchContainer sketch{batch_param_.max_bin, h_ft, column_sizes, use_group,
+                                         proxy->IsColumnSplit(), n_threads};
+      for (std::size_t i = 0; i < pages.size(); ++i) {
+        // SparsePage contains only valid values.
+        sketch.PushAdapterBatch(SparsePageAdapterBatch{pages[i].GetView()}, 0, infos[i],
+                                std::numeric_limits<float>::quiet_NaN());
+      }
+      sketch.MakeCuts(&cuts);
+    }
+
+    this->ghist_ = std::make_shared<GHistIndexMatrix>(MetaInfo{}, std::move(cuts),
+                                                      batch_param_.max_bin);
+    this->ghist_->SetDense(false);
+    for (auto const& page : pages) {
+      push(SparsePageAdapterBatch{page.GetView()}, std::numeric_limits<float>::quiet_NaN());
+    }
+    pages.clear();
+    infos.clear();
+  };
+
+  do {
+    if (n_features == 0) {
+      n_features = num_cols();
+      collective::Allreduce<collective::Operation::kMax>(&n_features, 1);
+      info_.num_col_ = n_features;
+      if (ref) {
+        h_ft = ref->Info().feature_types.HostVector();
+        make_index();
+      } else {
+        h_ft = proxy->Info().feature_types.ConstHostVector();
+        SyncFeatureType(&h_ft);
+      }
+    } else {
+      CHECK_EQ(n_features, num_cols()) << "Inconsistent number of columns.";
+    }
+
+    if (this->ghist_) {
+      HostAdapterDispatch(proxy, [&](auto const& batch) { push(batch, missing); });
+    } else {
+      auto& page = pages.emplace_back();
+      HostAdapterDispatch(proxy,
+                          [&](auto const& batch) { page.Push(batch, missing, n_threads); });
+      auto& info = infos.emplace_back(proxy->Info().Copy());
+      info.num_row_ = page.Size();
+      info.num_col_ = n_features;
+      info.num_nonzero_ = page.data.Size();
+      n_buffered_bytes += page.MemCostBytes();
+      if (n_buffered_bytes >= buffer_bytes) {
+        make_index();
+      }
+    }
+    this->info_.Extend(proxy->Info(), false, true);
+  } while (iter.Next());
+  iter.Reset();
+
+  if (!this->ghist_) {
+    // The whole dataset fits in the buffer.
+    make_index();
+  }
+  if (!h_ft.empty()) {
+    CHECK_EQ(h_ft.size(), n_features);
+  }
+  CHECK_GE(n_features, 1) << "Data must has at least 1 column.";
+
+  this->ghist_->Finalize(&ctx_, batch_param_.sparse_thresh);
+  Info().num_row_ = this->ghist_->Size();
+  Info().num_nonzero_ = this->ghist_->row_ptr.back();
+  Info().num_col_ = n_features;
+  collective::Allreduce<collective::Operation::kMax>(&info_.num_col_, 1);
+  Info().feature_types.HostVector() = h_ft;
+}
+
+IterativeDMatrix::IterativeDMatrix(dmlc::SeekStream* fi)
+    : proxy_{nullptr}, reset_{nullptr}, next_{nullptr} {
+  std::int32_t magic{0};
+  CHECK(fi->Read(&magic)) << "Invalid input file format.";
+  CHECK_EQ(magic, kMagic) << "Invalid format, magic number mismatch.";
+  info_.LoadBinary(fi);
+
+  bst_bin_t max_bin{0};
+  double sparse_thresh{0};
+  CHECK(fi->Read(&max_bin));
+  CHECK(fi->Read(&sparse_thresh));
+  batch_param_ = BatchParam{max_bin, sparse_thresh};
+
+  // Categorical info of cuts is not part of the page format.
+  std::uint8_t has_cat{0};
+  float max_cat{-1.0f};
+  CHECK(fi->Read(&has_cat));
+  CHECK(fi->Read(&max_cat));
+
+  ghist_ = std::make_shared<GHistIndexMatrix>();
+  std::unique_ptr<SparsePageFormat<GHistIndexMatrix>> fmt{
+      CreatePageFormat<GHistIndexMatrix>("raw")};
+  CHECK(fmt->Read(ghist_.get(), fi)) << "Invalid input file format.";
+  ghist_->cut.SetCategorical(has_cat, max_cat);
+  CHECK_EQ(ghist_->Size(), info_.num_row_);
+  CHECK_EQ(ghist_->Features(), info_.num_col_);
+}
+
+void IterativeDMatrix::SaveToLocalFile(std::string const& fname) {
+  CHECK(ghist_) << "Saving `QuantileDMatrix` is only supported for CPU.";
+  std::unique_ptr<dmlc::Stream> fo{dmlc::Stream::Create(fname.c_str(), "w")};
+  fo->Write(kMagic);
+  info_.SaveBinary(fo.get());
+  fo->Write(batch_param_.max_bin);
+  fo->Write(batch_param_.sparse_thresh);
+  fo->Write(static_cast<std::uint8_t>(ghist_->cut.HasCategorical()));
+  fo->Write(ghist_->cut.MaxCategory());
+  std::unique_ptr<SparsePageFormat<GHistIndexMatrix>> fmt{
+      CreatePageFormat<GHistIndexMatrix>("raw")};
+  fmt->Write(*ghist_, fo.get());
+}
+
+IterativeDMatrix* IterativeDMatrix::Load(std::string const& fname) {
+  // Memory mapping is only available for local files.
+  if (common::MmapFile::Supported() && fname.find("://") == std::string::npos) {
+    common::MmapFile mmap{fname};
+    auto fi = mmap.Stream(0, mmap.Size());
+    return new IterativeDMatrix{&fi};
+  }
+  std::unique_ptr<dmlc::SeekStream> fi{dmlc::SeekStream::CreateForRead(fname.c_str())};
+  return new IterativeDMatrix{fi.get()};
+}
+
 BatchSet<GHistIndexMatrix> IterativeDMatrix::GetGradientIndex(BatchParam const& param) {
   CheckParam(param);
   if (!ghist_) {
@@ -5,6 +5,8 @@
 #ifndef XGBOOST_DATA_ITERATIVE_DMATRIX_H_
 #define XGBOOST_DATA_ITERATIVE_DMATRIX_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
@@ -70,14 +72,48 @@ class IterativeDMatrix : public DMatrix {
 
   void InitFromCUDA(DataIterHandle iter, float missing, std::shared_ptr<DMatrix> ref);
   void InitFromCPU(DataIterHandle iter_handle, float missing, std::shared_ptr<DMatrix> ref);
+  /**
+   * \brief Construct the gradient index with a single pass over the iterator.
+   *
+   *   Batches are copied into a buffer of at most `buffer_bytes` bytes (plus the last batch)
+   *   until the buffer is full or the iterator is exhausted.  The histogram cuts are then
+   *   sketched from the buffered batches, which are quantized from memory and released.
+   *   Remaining batches are quantized as soon as they arrive.  The cuts are exact when the
+   *   whole dataset fits in the buffer, otherwise they are estimated from the leading
+   *   batches.
+   */
+  void InitSinglePass(DataIterHandle iter_handle, float missing, std::shared_ptr<DMatrix> ref,
+                      std::size_t buffer_bytes);
 
  public:
+  /**
+   * \param sketch_buffer_bytes Size of the buffer used for constructing the CPU gradient
+   *                            index with a single pass over the iterator, see
+   *                            `InitSinglePass`.  0 to iterate over the data multiple times.
+   */
   explicit IterativeDMatrix(DataIterHandle iter_handle, DMatrixHandle proxy,
                             std::shared_ptr<DMatrix> ref, DataIterResetCallback *reset,
                             XGDMatrixCallbackNext *next, float missing, int nthread,
-                            bst_bin_t max_bin);
+                            bst_bin_t max_bin, std::size_t sketch_buffer_bytes = 0);
+  /**
+   * \brief Load a snapshot saved by `SaveToLocalFile`.
+   */
+  explicit IterativeDMatrix(dmlc::SeekStream *fi);
   ~IterativeDMatrix() override = default;
 
+  /**
+   * \brief Save the quantized data including the histogram cuts, the gradient index, the
+   *        column matrix and the meta info. Only the CPU format is supported.
+   */
+  void SaveToLocalFile(std::string const &fname);
+  /**
+   * \brief Load a snapshot, the file is memory mapped when it's supported by the OS.
+   */
+  static IterativeDMatrix *Load(std::string const &fname);
+
+  /*! \brief magic number used to identify IterativeDMatrix binary files */
+  static constexpr std::int32_t kMagic = 0xffffab02;
+
   bool EllpackExists() const override { return static_cast<bool>(ellpack_); }
   bool GHistIndexExists() const override { return static_cast<bool>(ghist_); }
   bool SparsePageExists() const override { return false; }
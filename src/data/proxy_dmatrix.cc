@@ -15,6 +15,14 @@ void DMatrixProxy::SetArrayData(char const *c_interface) {
   this->ctx_.gpu_id = Context::kCpuId;
 }
 
+void DMatrixProxy::SetColumnarData(char const *c_interface) {
+  std::shared_ptr<ColumnarAdapter> adapter{new ColumnarAdapter(StringView{c_interface})};
+  this->batch_ = adapter;
+  this->Info().num_col_ = adapter->NumColumns();
+  this->Info().num_row_ = adapter->NumRows();
+  this->ctx_.gpu_id = Context::kCpuId;
+}
+
 void DMatrixProxy::SetCSRData(char const *c_indptr, char const *c_indices,
                               char const *c_values, bst_feature_t n_features, bool on_host) {
   CHECK(on_host) << "Not implemented on device.";
@@ -68,6 +68,7 @@ class DMatrixProxy : public DMatrix {
   }
 
   void SetArrayData(char const* c_interface);
+  void SetColumnarData(char const* c_interface);
   void SetCSRData(char const *c_indptr, char const *c_indices,
                   char const *c_values, bst_feature_t n_features,
                   bool on_host);
@@ -138,6 +139,12 @@ decltype(auto) HostAdapterDispatch(DMatrixProxy const* proxy, Fn fn, bool* type_
       *type_error = false;
     }
     return fn(value);
+  } else if (proxy->Adapter().type() == typeid(std::shared_ptr<ColumnarAdapter>)) {
+    auto value = std::any_cast<std::shared_ptr<ColumnarAdapter>>(proxy->Adapter())->Value();
+    if (type_error) {
+      *type_error = false;
+    }
+    return fn(value);
   } else {
     if (type_error) {
       *type_error = true;
@@ -0,0 +1,150 @@
+/**
+ * Copyright 2023 by XGBoost Contributors
+ */
+#include "row_subset_dmatrix.h"
+
+#include <algorithm>  // for copy, transform
+#include <cstddef>    // for size_t
+#include <utility>    // for move
+
+#include "../common/numeric.h"             // for PartialSum
+#include "../common/threading_utils.h"     // for ParallelFor
+#include "../common/transform_iterator.h"  // for MakeIndexTransformIter
+#include "simple_batch_iterator.h"         // for SimpleBatchIteratorImpl
+#include "xgboost/logging.h"               // for CHECK, LOG
+
+namespace xgboost::data {
+RowSubsetDMatrix::RowSubsetDMatrix(std::shared_ptr<DMatrix> parent,
+                                   common::Span<std::int32_t const> ridx)
+    : parent_{std::move(parent)}, ridx_(ridx.cbegin(), ridx.cend()) {
+  CHECK(parent_);
+  CHECK(parent_->SingleColBlock()) << "DMatrix view requires the data to be in memory.";
+  CHECK(!parent_->IsColumnSplit()) << "DMatrix view is not supported for column-wise split.";
+  ctx_ = *parent_->Ctx();
+  auto n_samples = parent_->Info().num_row_;
+  for (auto r : ridx_) {
+    CHECK(r >= 0 && static_cast<bst_row_t>(r) < n_samples) << "Invalid row index: " << r;
+  }
+  info_ = parent_->Info().Slice(ridx_);
+
+  // Count the number of entries without gathering the rows.
+  std::size_t nnz{0};
+  auto count = [&](auto const& row_ptr) {
+    for (auto r : ridx_) {
+      nnz += row_ptr[r + 1] - row_ptr[r];
+    }
+  };
+  if (parent_->PageExists<SparsePage>()) {
+    for (auto const& page : parent_->GetBatches<SparsePage>()) {
+      count(page.offset.ConstHostVector());
+    }
+  } else {
+    for (auto const& page : parent_->GetBatches<GHistIndexMatrix>(BatchParam{})) {
+      count(page.row_ptr);
+    }
+  }
+  info_.num_nonzero_ = nnz;
+}
+
+DMatrix* RowSubsetDMatrix::Slice(common::Span<std::int32_t const> ridxs) {
+  std::vector<std::int32_t> ridx(ridxs.size());
+  std::transform(ridxs.cbegin(), ridxs.cend(), ridx.begin(), [&](std::int32_t i) {
+    CHECK(i >= 0 && static_cast<std::size_t>(i) < ridx_.size()) << "Invalid row index: " << i;
+    return ridx_[i];
+  });
+  auto out = new RowSubsetDMatrix{parent_, ridx};
+  // Use the meta info of this view as it might have been changed after construction.
+  auto nnz = out->info_.num_nonzero_;
+  out->info_ = this->info_.Slice(ridxs);
+  out->info_.num_nonzero_ = nnz;
+  return out;
+}
+
+std::shared_ptr<SparsePage> RowSubsetDMatrix::RowPage() {
+  std::lock_guard<std::mutex> guard{gather_lock_};
+  auto out = row_page_.lock();
+  if (out) {
+    return out;
+  }
+  out = std::make_shared<SparsePage>();
+  auto n_threads = ctx_.Threads();
+  for (auto const& page : parent_->GetBatches<SparsePage>()) {
+    auto batch = page.GetView();
+    auto& h_offset = out->offset.HostVector();
+    h_offset.resize(ridx_.size() + 1);
+    auto it = common::MakeIndexTransformIter(
+        [&](std::size_t i) -> std::size_t { return batch[ridx_[i]].size(); });
+    common::PartialSum(n_threads, it, it + ridx_.size(), static_cast<std::size_t>(0),
+                       h_offset.begin());
+    auto& h_data = out->data.HostVector();
+    h_data.resize(h_offset.back());
+    common::ParallelFor(ridx_.size(), n_threads, [&](std::size_t i) {
+      auto inst = batch[ridx_[i]];
+      std::copy(inst.cbegin(), inst.cend(), h_data.begin() + h_offset[i]);
+    });
+  }
+  row_page_ = out;
+  return out;
+}
+
+BatchSet<SparsePage> RowSubsetDMatrix::GetRowBatches() {
+  auto begin_iter =
+      BatchIterator<SparsePage>(new SimpleBatchIteratorImpl<SparsePage>(this->RowPage()));
+  return BatchSet<SparsePage>(begin_iter);
+}
+
+BatchSet<CSCPage> RowSubsetDMatrix::GetColumnBatches() {
+  if (!column_page_) {
+    column_page_.reset(new CSCPage(this->RowPage()->GetTranspose(info_.num_col_, ctx_.Threads())));
+  }
+  auto begin_iter = BatchIterator<CSCPage>(new SimpleBatchIteratorImpl<CSCPage>(column_page_));
+  return BatchSet<CSCPage>(begin_iter);
+}
+
+BatchSet<SortedCSCPage> RowSubsetDMatrix::GetSortedColumnBatches() {
+  if (!sorted_column_page_) {
+    sorted_column_page_.reset(
+        new SortedCSCPage(this->RowPage()->GetTranspose(info_.num_col_, ctx_.Threads())));
+    sorted_column_page_->SortRows(ctx_.Threads());
+  }
+  auto begin_iter = BatchIterator<SortedCSCPage>(
+      new SimpleBatchIteratorImpl<SortedCSCPage>(sorted_column_page_));
+  return BatchSet<SortedCSCPage>(begin_iter);
+}
+
+BatchSet<EllpackPage> RowSubsetDMatrix::GetEllpackBatches(BatchParam const&) {
+  LOG(FATAL) << "`gpu_hist` is not supported by DMatrix view, use `DMatrix.slice` instead.";
+  return BatchSet<EllpackPage>(BatchIterator<EllpackPage>(nullptr));
+}
+
+BatchSet<GHistIndexMatrix> RowSubsetDMatrix::GetGradientIndex(BatchParam const& param) {
+  if (param == BatchParam{} && !gradient_index_) {
+    CHECK(!parent_->PageExists<SparsePage>()) << "Batch parameter is not initialized.";
+  }
+  if (!gradient_index_ || RegenGHist(batch_param_, param)) {
+    if (param.regen || !param.hess.empty()) {
+      // The cuts for approx are weighted by the hessian of this subset, sketch the rows
+      // selected by this view.
+      CHECK_GE(param.max_bin, 2);
+      gradient_index_ = std::make_shared<GHistIndexMatrix>(
+          this, param.max_bin, param.sparse_thresh, param.regen, ctx_.Threads(), param.hess);
+    } else {
+      for (auto const& page : parent_->GetBatches<GHistIndexMatrix>(param)) {
+        gradient_index_ =
+            std::make_shared<GHistIndexMatrix>(&ctx_, page, ridx_, param.sparse_thresh);
+      }
+    }
+    batch_param_ = param;
+  }
+  auto begin_iter = BatchIterator<GHistIndexMatrix>(
+      new SimpleBatchIteratorImpl<GHistIndexMatrix>(gradient_index_));
+  return BatchSet<GHistIndexMatrix>(begin_iter);
+}
+
+BatchSet<ExtSparsePage> RowSubsetDMatrix::GetExtBatches(BatchParam const&) {
+  auto casted = std::make_shared<ExtSparsePage>(this->RowPage());
+  auto begin_iter =
+      BatchIterator<ExtSparsePage>(new SimpleBatchIteratorImpl<ExtSparsePage>(casted));
+  return BatchSet<ExtSparsePage>(begin_iter);
+}
+}  // namespace xgboost::data
@@ -0,0 +1,88 @@
+/**
+ * Copyright 2023 by XGBoost Contributors
+ *
+ * \file row_subset_dmatrix.h
+ * \brief DMatrix view on a subset of rows from another in-memory DMatrix.
+ */
+#ifndef XGBOOST_DATA_ROW_SUBSET_DMATRIX_H_
+#define XGBOOST_DATA_ROW_SUBSET_DMATRIX_H_
+
+#include <cstdint>  // for int32_t
+#include <memory>   // for shared_ptr, weak_ptr
+#include <mutex>    // for mutex
+#include <vector>   // for vector
+
+#include "gradient_index.h"   // for GHistIndexMatrix
+#include "xgboost/base.h"     // for bst_row_t
+#include "xgboost/context.h"  // for Context
+#include "xgboost/data.h"     // for DMatrix, MetaInfo, BatchParam
+#include "xgboost/span.h"     // for Span
+
+namespace xgboost::data {
+/**
+ * \brief A view on selected rows of another in-memory DMatrix, used by cross validation
+ *        to avoid copying the data for each fold.
+ *
+ *   Only the meta info is gathered at construction.  The gradient index for `hist` is
+ *   obtained by gathering the quantized rows of the parent's gradient index, which shares
+ *   the histogram cuts with the parent instead of sketching the subset again.  The row
+ *   storage is gathered on demand and released once no consumer holds it.  The parent
+ *   must not be modified while the view is alive.
+ */
+class RowSubsetDMatrix : public DMatrix {
+  std::shared_ptr<DMatrix> parent_;
+  std::vector<std::int32_t> ridx_;
+  MetaInfo info_;
+  Context ctx_;
+  BatchParam batch_param_;
+
+  std::shared_ptr<GHistIndexMatrix> gradient_index_{nullptr};
+  std::shared_ptr<CSCPage> column_page_{nullptr};
+  std::shared_ptr<SortedCSCPage> sorted_column_page_{nullptr};
+  // Gathered row storage shared by the current consumers.
+  std::weak_ptr<SparsePage> row_page_;
+  std::mutex gather_lock_;
+
+  // Get the selected rows from the parent.
+  std::shared_ptr<SparsePage> RowPage();
+
+ public:
+  /**
+   * \param parent The DMatrix being viewed, must have a single in-memory batch.
+   * \param ridx   Index of selected rows in the parent.
+   */
+  RowSubsetDMatrix(std::shared_ptr<DMatrix> parent, common::Span<std::int32_t const> ridx);
+  ~RowSubsetDMatrix() override = default;
+
+  MetaInfo& Info() override { return info_; }
+  MetaInfo const& Info() const override { return info_; }
+  Context const* Ctx() const override { return &ctx_; }
+
+  bool SingleColBlock() const override { return true; }
+  /**
+   * \brief Slicing a view returns another view on the same parent.
+   */
+  DMatrix* Slice(common::Span<std::int32_t const> ridxs) override;
+  DMatrix* SliceCol(int, int) override {
+    LOG(FATAL) << "Slicing columns is not supported for DMatrix view.";
+    return nullptr;
+  }
+
+  std::shared_ptr<DMatrix> Parent() const { return parent_; }
+  common::Span<std::int32_t const> RowIndex() const { return ridx_; }
+
+ protected:
+  BatchSet<SparsePage> GetRowBatches() override;
+  BatchSet<CSCPage> GetColumnBatches() override;
+  BatchSet<SortedCSCPage> GetSortedColumnBatches() override;
+  BatchSet<EllpackPage> GetEllpackBatches(BatchParam const& param) override;
+  BatchSet<GHistIndexMatrix> GetGradientIndex(BatchParam const& param) override;
+  BatchSet<ExtSparsePage> GetExtBatches(BatchParam const& param) override;
+
+  bool EllpackExists() const override { return false; }
+  bool GHistIndexExists() const override { return static_cast<bool>(gradient_index_); }
+  // Follow the parent so that the predictor reads the same storage as it does on the parent.
+  bool SparsePageExists() const override { return parent_->PageExists<SparsePage>(); }
+};
+}  // namespace xgboost::data
+#endif  // XGBOOST_DATA_ROW_SUBSET_DMATRIX_H_
@@ -7,7 +7,10 @@
 #include "simple_dmatrix.h"
 
 #include <algorithm>
+#include <cstdint>   // for int32_t
+#include <iterator>  // for back_inserter, distance
 #include <limits>
+#include <numeric>   // for iota
 #include <type_traits>
 #include <vector>
 
@@ -73,17 +76,163 @@ DMatrix* SimpleDMatrix::SliceCol(int num_slices, int slice_id) {
   return out;
 }
 
+void SimpleDMatrix::Append(DMatrix* that) {
+  CHECK(that);
+  CHECK_NE(that, this);
+  CHECK(!this->IsColumnSplit() && !that->IsColumnSplit())
+      << "Appending rows is not supported for column-split data.";
+  auto n_features = info_.num_row_ == 0 ? that->Info().num_col_ : info_.num_col_;
+  CHECK_LE(that->Info().num_col_, n_features)
+      << "The appended DMatrix has more columns than the existing one.";
+
+  bool compact = this->IsCompact();
+  if (compact) {
+    this->Decompact();
+  }
+
+  bool sorted{true};
+  for (auto const& page : that->GetBatches<SparsePage>()) {
+    sorted = sorted && page.IsIndicesSorted(ctx_.Threads());
+    sparse_page_->Push(page);
+  }
+  if (!sorted) {
+    sparse_page_->SortIndices(ctx_.Threads());
+  }
+  info_.Extend(that->Info(), true, false);
+  info_.num_col_ = n_features;
+  info_.num_nonzero_ = sparse_page_->data.Size();
+  CHECK_EQ(sparse_page_->Size(), info_.num_row_);
+
+  this->InvalidatePages();
+  if (gradient_index_ && gradient_index_->IsDense() == this->IsDense()) {
+    // Quantize the new rows with existing cuts.
+    gradient_index_->Append(&ctx_, *sparse_page_, info_.feature_types.ConstHostSpan(),
+                            batch_param_.sparse_thresh);
+  } else if (gradient_index_) {
+    // The layout of the index depends on whether the data is dense, rebuild it from the
+    // existing cuts.
+    gradient_index_ = std::make_shared<GHistIndexMatrix>(
+        *sparse_page_, info_.feature_types.ConstHostSpan(), gradient_index_->cut,
+        gradient_index_->max_numeric_bins_per_feat, this->IsDense(), batch_param_.sparse_thresh,
+        ctx_.Threads());
+  }
+  if (compact) {
+    this->Compact();
+  }
+}
+
+void SimpleDMatrix::DropPrefix(bst_row_t n_rows) {
+  CHECK_LE(n_rows, info_.num_row_) << "Dropping more rows than the DMatrix has.";
+  CHECK_LE(info_.num_row_, static_cast<bst_row_t>(std::numeric_limits<std::int32_t>::max()));
+  if (n_rows == 0) {
+    return;
+  }
+
+  std::vector<std::int32_t> ridxs(info_.num_row_ - n_rows);
+  std::iota(ridxs.begin(), ridxs.end(), static_cast<std::int32_t>(n_rows));
+  auto info = info_.Slice(ridxs);
+  if (!info_.group_ptr_.empty()) {
+    auto const& group_ptr = info_.group_ptr_;
+    auto it = std::find(group_ptr.cbegin(), group_ptr.cend(), n_rows);
+    CHECK(it != group_ptr.cend()) << "Dropped rows must end at a query group boundary.";
+    auto n_groups = std::distance(group_ptr.cbegin(), it);
+    std::transform(it, group_ptr.cend(), std::back_inserter(info.group_ptr_),
+                   [&](bst_group_t ptr) { return static_cast<bst_group_t>(ptr - n_rows); });
+    if (info_.weights_.Size() + 1 == group_ptr.size()) {
+      // Weights are assigned to groups.
+      auto const& h_weights = info_.weights_.ConstHostVector();
+      info.weights_.HostVector().assign(h_weights.cbegin() + n_groups, h_weights.cend());
+    }
+  }
+  info.data_split_mode = info_.data_split_mode;
+
+  bool compact = this->IsCompact();
+  if (compact) {
+    this->Decompact();
+  }
+  auto& h_offset = sparse_page_->offset.HostVector();
+  auto& h_data = sparse_page_->data.HostVector();
+  auto n_entries = h_offset[n_rows];
+  h_data.erase(h_data.begin(), h_data.begin() + n_entries);
+  h_offset.erase(h_offset.begin(), h_offset.begin() + n_rows);
+  common::ParallelFor(h_offset.size(), ctx_.Threads(),
+                      [&](std::size_t i) { h_offset[i] -= n_entries; });
+  info.num_nonzero_ = h_data.size();
+  info_ = std::move(info);
+  n_dropped_rows_ += n_rows;
+
+  this->InvalidatePages();
+  if (gradient_index_ && gradient_index_->IsDense() == this->IsDense()) {
+    gradient_index_->DropPrefix(&ctx_, n_rows, batch_param_.sparse_thresh);
+  } else if (gradient_index_) {
+    gradient_index_ = std::make_shared<GHistIndexMatrix>(
+        *sparse_page_, info_.feature_types.ConstHostSpan(), gradient_index_->cut,
+        gradient_index_->max_numeric_bins_per_feat, this->IsDense(), batch_param_.sparse_thresh,
+        ctx_.Threads());
+  }
+  if (compact) {
+    this->Compact();
+  }
+}
+
+void SimpleDMatrix::InvalidatePages() {
+  column_page_.reset();
+  sorted_column_page_.reset();
+  ellpack_page_.reset();
+  if (batch_param_.regen) {
+    // The index is sketched with hessian and regenerated by the caller anyway.
+    gradient_index_.reset();
+  }
+}
+
+void SimpleDMatrix::Compact() {
+  if (this->IsCompact()) {
+    return;
+  }
+  CHECK(sparse_page_);
+  compact_page_ = std::make_unique<CompactPage>(*sparse_page_, info_.num_col_, ctx_.Threads());
+  LOG(INFO) << "Compact row storage: " << sparse_page_->MemCostBytes() << " bytes -> "
+            << compact_page_->MemCostBytes() << " bytes.";
+  sparse_page_.reset();
+}
+
+void SimpleDMatrix::Decompact() {
+  CHECK(compact_page_);
+  // The shared decoded page might still be held by a consumer, decode into a new page that
+  // can be modified.
+  std::lock_guard<std::mutex> guard{decode_lock_};
+  sparse_page_ = std::make_shared<SparsePage>();
+  compact_page_->Decode(ctx_.Threads(), sparse_page_.get());
+  compact_page_.reset();
+  decoded_page_.reset();
+}
+
+std::shared_ptr<SparsePage> SimpleDMatrix::RowPage() {
+  if (sparse_page_) {
+    return sparse_page_;
+  }
+  CHECK(compact_page_);
+  std::lock_guard<std::mutex> guard{decode_lock_};
+  auto page = decoded_page_.lock();
+  if (!page) {
+    page = std::make_shared<SparsePage>();
+    compact_page_->Decode(ctx_.Threads(), page.get());
+    decoded_page_ = page;
+  }
+  return page;
+}
+
 BatchSet<SparsePage> SimpleDMatrix::GetRowBatches() {
   // since csr is the default data structure so `source_` is always available.
   auto begin_iter = BatchIterator<SparsePage>(
-      new SimpleBatchIteratorImpl<SparsePage>(sparse_page_));
+      new SimpleBatchIteratorImpl<SparsePage>(this->RowPage()));
   return BatchSet<SparsePage>(begin_iter);
 }
 
 BatchSet<CSCPage> SimpleDMatrix::GetColumnBatches() {
   // column page doesn't exist, generate it
   if (!column_page_) {
-    column_page_.reset(new CSCPage(sparse_page_->GetTranspose(info_.num_col_, ctx_.Threads())));
+    column_page_.reset(new CSCPage(this->RowPage()->GetTranspose(info_.num_col_, ctx_.Threads())));
   }
   auto begin_iter =
       BatchIterator<CSCPage>(new SimpleBatchIteratorImpl<CSCPage>(column_page_));
@@ -94,7 +243,7 @@ BatchSet<SortedCSCPage> SimpleDMatrix::GetSortedColumnBatches() {
   // Sorted column page doesn't exist, generate it
   if (!sorted_column_page_) {
     sorted_column_page_.reset(
-        new SortedCSCPage(sparse_page_->GetTranspose(info_.num_col_, ctx_.Threads())));
+        new SortedCSCPage(this->RowPage()->GetTranspose(info_.num_col_, ctx_.Threads())));
     sorted_column_page_->SortRows(ctx_.Threads());
   }
   auto begin_iter = BatchIterator<SortedCSCPage>(
@@ -143,7 +292,7 @@ BatchSet<GHistIndexMatrix> SimpleDMatrix::GetGradientIndex(const BatchParam& par
 }
 
 BatchSet<ExtSparsePage> SimpleDMatrix::GetExtBatches(BatchParam const&) {
-  auto casted = std::make_shared<ExtSparsePage>(sparse_page_);
+  auto casted = std::make_shared<ExtSparsePage>(this->RowPage());
   CHECK(casted);
   auto begin_iter =
       BatchIterator<ExtSparsePage>(new SimpleBatchIteratorImpl<ExtSparsePage>(casted));
@@ -268,8 +417,9 @@ void SimpleDMatrix::SaveToLocalFile(const std::string& fname) {
     int tmagic = kMagic;
     fo->Write(tmagic);
     info_.SaveBinary(fo.get());
-    fo->Write(sparse_page_->offset.HostVector());
-    fo->Write(sparse_page_->data.HostVector());
+    auto page = this->RowPage();
+    fo->Write(page->offset.HostVector());
+    fo->Write(page->data.HostVector());
 }
 
 template SimpleDMatrix::SimpleDMatrix(DenseAdapter* adapter, float missing, int nthread);
@@ -11,8 +11,10 @@
 #include <xgboost/data.h>
 
 #include <memory>
+#include <mutex>  // for mutex
 #include <string>
 
+#include "compact_page.h"  // for CompactPage
 #include "gradient_index.h"
 
 namespace xgboost {
@@ -28,6 +30,13 @@ class SimpleDMatrix : public DMatrix {
   ~SimpleDMatrix() override = default;
 
   void SaveToLocalFile(const std::string& fname);
+  /**
+   * \brief Encode the row storage with narrow feature indices, implicit values for binary
+   *        data and 32-bit row offsets.  The page is decoded on demand when accessed and
+   *        released once no consumer holds it.
+   */
+  void Compact();
+  bool IsCompact() const { return static_cast<bool>(compact_page_); }
 
   MetaInfo& Info() override;
   const MetaInfo& Info() const override;
@@ -36,6 +45,9 @@ class SimpleDMatrix : public DMatrix {
   bool SingleColBlock() const override { return true; }
   DMatrix* Slice(common::Span<int32_t const> ridxs) override;
   DMatrix* SliceCol(int num_slices, int slice_id) override;
+  void Append(DMatrix* that) override;
+  void DropPrefix(bst_row_t n_rows) override;
+  bst_row_t NumDroppedRows() const override { return n_dropped_rows_; }
 
   /*! \brief magic number used to identify SimpleDMatrix binary files */
   static const int kMagic = 0xffffab01;
@@ -62,7 +74,20 @@ class SimpleDMatrix : public DMatrix {
   bool SparsePageExists() const override { return true; }
 
  private:
+  // Drop pages derived from the row storage after rows are added or removed.
+  void InvalidatePages();
+  // Get the row storage, decode it if the page is compact.
+  std::shared_ptr<SparsePage> RowPage();
+  // Restore the row storage from the compact page for modification.
+  void Decompact();
+
   Context ctx_;
+  bst_row_t n_dropped_rows_{0};
+  // Encoded row storage, `sparse_page_` is null when it's set.
+  std::unique_ptr<CompactPage> compact_page_{nullptr};
+  // Decoded page shared by the current consumers of the compact page.
+  std::weak_ptr<SparsePage> decoded_page_;
+  std::mutex decode_lock_;
 };
 }  // namespace data
 }  // namespace xgboost
@@ -0,0 +1,297 @@
+/**
+ * Copyright 2023 by XGBoost Contributors
+ *
+ * \file sparse_page_compressed_format.cc
+ * \brief Compressed binary format of pages in the external memory cache. Trades CPU time
+ *        in the prefetch threads for smaller cache files and less disk bandwidth.
+ */
+#include <dmlc/registry.h>
+
+#include <algorithm>    // for max_element, copy_n, transform
+#include <cstddef>      // for size_t
+#include <cstdint>      // for uint8_t, uint32_t, uint64_t, int64_t
+#include <vector>       // for vector
+
+#include "../common/codec.h"       // for VarintEncode, ByteShuffle, BitPack, RleEncode
+#include "gradient_index.h"        // for GHistIndexMatrix
+#include "histogram_cut_format.h"  // for ReadHistogramCuts, WriteHistogramCuts
+#include "sparse_page_writer.h"    // for SparsePageFormat
+#include "xgboost/data.h"          // for SparsePage, CSCPage, SortedCSCPage
+#include "xgboost/logging.h"       // for CHECK_EQ
+
+namespace xgboost {
+namespace data {
+
+DMLC_REGISTRY_FILE_TAG(sparse_page_compressed_format);
+
+namespace {
+using Buffer = std::vector<std::uint8_t>;
+
+enum class BlockType : std::uint8_t { kRaw = 0, kRle = 1 };
+
+/**
+ * \brief Byte shuffle the values, then apply run length encoding if it reduces the size.
+ */
+template <typename T>
+void EncodeValues(common::Span<T const> values, Buffer* out) {
+  Buffer shuffled(values.size_bytes());
+  common::ByteShuffle(values, shuffled.data());
+  Buffer rle;
+  common::RleEncode(common::Span<std::uint8_t const>{shuffled}, &rle);
+  if (rle.size() < shuffled.size()) {
+    out->push_back(static_cast<std::uint8_t>(BlockType::kRle));
+    out->insert(out->end(), rle.cbegin(), rle.cend());
+  } else {
+    out->push_back(static_cast<std::uint8_t>(BlockType::kRaw));
+    out->insert(out->end(), shuffled.cbegin(), shuffled.cend());
+  }
+}
+
+template <typename T>
+void DecodeValues(std::uint8_t const** p, std::uint8_t const* end, common::Span<T> out) {
+  CHECK(*p != end) << "Invalid compressed page.";
+  auto type = static_cast<BlockType>(*(*p)++);
+  Buffer shuffled(out.size_bytes());
+  if (type == BlockType::kRle) {
+    common::RleDecode(p, end, common::Span<std::uint8_t>{shuffled});
+  } else {
+    CHECK(type == BlockType::kRaw) << "Invalid compressed page.";
+    CHECK_LE(shuffled.size(), static_cast<std::size_t>(end - *p)) << "Invalid compressed page.";
+    std::copy_n(*p, shuffled.size(), shuffled.begin());
+    *p += shuffled.size();
+  }
+  common::ByteUnshuffle(shuffled.data(), out);
+}
+
+/**
+ * \brief Write the encoded buffer, returns the number of bytes written.
+ */
+std::size_t WriteBuffer(Buffer const& buf, dmlc::Stream* fo) {
+  fo->Write(buf);
+  return buf.size() + sizeof(std::uint64_t);
+}
+}  // namespace
+
+/**
+ * \brief Compressed format for sparse pages.
+ *
+ *  - Row lengths are varint encoded.
+ *  - Feature indices are delta encoded within each row, followed by zigzag and varint
+ *    encoding.
+ *  - Feature values are byte shuffled and optionally run length encoded.
+ */
+template <typename T>
+class SparsePageCompressedFormat : public SparsePageFormat<T> {
+ public:
+  bool Read(T* page, dmlc::SeekStream* fi) override {
+    Buffer buf;
+    if (!fi->Read(&buf)) {
+      return false;
+    }
+    auto const* p = buf.data();
+    auto const* end = buf.data() + buf.size();
+
+    auto n_rows = common::VarintDecode(&p, end);
+    auto nnz = common::VarintDecode(&p, end);
+    auto& offset_vec = page->offset.HostVector();
+    offset_vec.resize(n_rows + 1);
+    offset_vec[0] = 0;
+    for (std::size_t i = 0; i < n_rows; ++i) {
+      offset_vec[i + 1] = offset_vec[i] + common::VarintDecode(&p, end);
+    }
+    CHECK_EQ(offset_vec.back(), nnz) << "Invalid compressed page.";
+
+    auto& data_vec = page->data.HostVector();
+    data_vec.resize(nnz);
+    for (std::size_t i = 0; i < n_rows; ++i) {
+      std::int64_t prev{0};
+      for (auto j = offset_vec[i]; j < offset_vec[i + 1]; ++j) {
+        prev += common::ZigZagDecode(common::VarintDecode(&p, end));
+        data_vec[j].index = static_cast<bst_feature_t>(prev);
+      }
+    }
+
+    std::vector<float> values(nnz);
+    DecodeValues(&p, end, common::Span<float>{values});
+    for (std::size_t j = 0; j < nnz; ++j) {
+      data_vec[j].fvalue = values[j];
+    }
+    CHECK(p == end) << "Invalid compressed page.";
+
+    if (!fi->Read(&page->base_rowid, sizeof(page->base_rowid))) {
+      return false;
+    }
+    return true;
+  }
+
+  size_t Write(const T& page, dmlc::Stream* fo) override {
+    auto const& offset_vec = page.offset.ConstHostVector();
+    auto const& data_vec = page.data.ConstHostVector();
+    CHECK(page.offset.Size() != 0 && offset_vec[0] == 0);
+    CHECK_EQ(offset_vec.back(), page.data.Size());
+
+    auto n_rows = offset_vec.size() - 1;
+    Buffer buf;
+    // A rough guess, most indices fit in 1 or 2 bytes.
+    buf.reserve(n_rows + data_vec.size() * (2 + sizeof(float)));
+    common::VarintEncode(n_rows, &buf);
+    common::VarintEncode(data_vec.size(), &buf);
+    for (std::size_t i = 0; i < n_rows; ++i) {
+      common::VarintEncode(offset_vec[i + 1] - offset_vec[i], &buf);
+    }
+    for (std::size_t i = 0; i < n_rows; ++i) {
+      std::int64_t prev{0};
+      for (auto j = offset_vec[i]; j < offset_vec[i + 1]; ++j) {
+        auto idx = static_cast<std::int64_t>(data_vec[j].index);
+        common::VarintEncode(common::ZigZagEncode(idx - prev), &buf);
+        prev = idx;
+      }
+    }
+
+    std::vector<float> values(data_vec.size());
+    std::transform(data_vec.cbegin(), data_vec.cend(), values.begin(),
+                   [](Entry const& e) { return e.fvalue; });
+    EncodeValues(common::Span<float const>{values}, &buf);
+
+    auto bytes = WriteBuffer(buf, fo);
+    fo->Write(&page.base_rowid, sizeof(page.base_rowid));
+    bytes += sizeof(page.base_rowid);
+    return bytes;
+  }
+};
+
+/**
+ * \brief Compressed format for the gradient index. Histogram cuts and the column matrix
+ *        are stored as it is, while the bin index is bit packed with the minimum width
+ *        required by the largest bin, and the row pointer is delta encoded.
+ */
+class GHistIndexCompressedFormat : public SparsePageFormat<GHistIndexMatrix> {
+  template <typename Fn>
+  static auto DispatchBinType(common::BinTypeSize type, Fn&& fn) {
+    switch (type) {
+      case common::kUint8BinsTypeSize:
+        return fn(std::uint8_t{});
+      case common::kUint16BinsTypeSize:
+        return fn(std::uint16_t{});
+      case common::kUint32BinsTypeSize:
+        return fn(std::uint32_t{});
+    }
+    LOG(FATAL) << "Invalid bin type: " << static_cast<std::int32_t>(type);
+    return fn(std::uint32_t{});
+  }
+
+ public:
+  bool Read(GHistIndexMatrix* page, dmlc::SeekStream* fi) override {
+    if (!ReadHistogramCuts(&page->cut, fi)) {
+      return false;
+    }
+    Buffer buf;
+    if (!fi->Read(&buf)) {
+      return false;
+    }
+    auto const* p = buf.data();
+    auto const* end = buf.data() + buf.size();
+    // indptr
+    auto n_rows = common::VarintDecode(&p, end);
+    page->row_ptr.resize(n_rows + 1);
+    page->row_ptr[0] = 0;
+    for (std::size_t i = 0; i < n_rows; ++i) {
+      page->row_ptr[i + 1] = page->row_ptr[i] + common::VarintDecode(&p, end);
+    }
+    // data
+    auto size_type = static_cast<common::BinTypeSize>(common::VarintDecode(&p, end));
+    auto n_bits = static_cast<std::uint32_t>(common::VarintDecode(&p, end));
+    auto n_bins = common::VarintDecode(&p, end);
+    auto n_bytes = common::BitPackedBytes(n_bins, n_bits);
+    CHECK_LE(n_bytes, static_cast<std::size_t>(end - p)) << "Invalid compressed page.";
+    std::vector<std::uint32_t> bins(n_bins);
+    common::BitUnpack(p, n_bits, common::Span<std::uint32_t>{bins});
+    p += n_bytes;
+    page->index.SetBinTypeSize(size_type);
+    page->index.Resize(n_bins * size_type);
+    DispatchBinType(size_type, [&](auto t) {
+      using T = decltype(t);
+      std::transform(bins.cbegin(), bins.cend(), page->index.data<T>(),
+                     [](std::uint32_t v) { return static_cast<T>(v); });
+    });
+    // hit count
+    page->hit_count.resize(common::VarintDecode(&p, end));
+    for (auto& c : page->hit_count) {
+      c = common::VarintDecode(&p, end);
+    }
+    // max_bins, base row, is_dense
+    page->max_numeric_bins_per_feat =
+        static_cast<bst_bin_t>(common::ZigZagDecode(common::VarintDecode(&p, end)));
+    page->base_rowid = common::VarintDecode(&p, end);
+    bool is_dense = common::VarintDecode(&p, end) != 0;
+    CHECK(p == end) << "Invalid compressed page.";
+
+    page->SetDense(is_dense);
+    if (is_dense) {
+      page->index.SetBinOffset(page->cut.Ptrs());
+    }
+
+    page->ReadColumnPage(fi);
+    return true;
+  }
+
+  size_t Write(GHistIndexMatrix const& page, dmlc::Stream* fo) override {
+    std::size_t bytes = 0;
+    bytes += WriteHistogramCuts(page.cut, fo);
+
+    Buffer buf;
+    // indptr
+    common::VarintEncode(page.row_ptr.size() - 1, &buf);
+    for (std::size_t i = 1; i < page.row_ptr.size(); ++i) {
+      common::VarintEncode(page.row_ptr[i] - page.row_ptr[i - 1], &buf);
+    }
+    // data
+    auto size_type = page.index.GetBinTypeSize();
+    auto n_bins = page.index.Size();
+    std::vector<std::uint32_t> bins(n_bins);
+    DispatchBinType(size_type, [&](auto t) {
+      using T = decltype(t);
+      auto const* data = page.index.data<T>();
+      std::copy_n(data, n_bins, bins.begin());
+    });
+    auto max_bin = bins.empty() ? 0u : *std::max_element(bins.cbegin(), bins.cend());
+    auto n_bits = common::BitWidth(max_bin);
+    common::VarintEncode(size_type, &buf);
+    common::VarintEncode(n_bits, &buf);
+    common::VarintEncode(n_bins, &buf);
+    auto beg = buf.size();
+    buf.resize(beg + common::BitPackedBytes(n_bins, n_bits));
+    common::BitPack(common::Span<std::uint32_t const>{bins}, n_bits, buf.data() + beg);
+    // hit count
+    common::VarintEncode(page.hit_count.size(), &buf);
+    for (auto c : page.hit_count) {
+      common::VarintEncode(c, &buf);
+    }
+    // max_bins, base row, is_dense
+    common::VarintEncode(common::ZigZagEncode(page.max_numeric_bins_per_feat), &buf);
+    common::VarintEncode(page.base_rowid, &buf);
+    common::VarintEncode(page.IsDense() ? 1 : 0, &buf);
+    bytes += WriteBuffer(buf, fo);
+
+    bytes += page.WriteColumnPage(fo);
+    return bytes;
+  }
+};
+
+XGBOOST_REGISTER_SPARSE_PAGE_FORMAT(compressed)
+    .describe("Compressed binary data format.")
+    .set_body([]() { return new SparsePageCompressedFormat<SparsePage>(); });
+
+XGBOOST_REGISTER_CSC_PAGE_FORMAT(compressed)
+    .describe("Compressed binary data format.")
+    .set_body([]() { return new SparsePageCompressedFormat<CSCPage>(); });
+
+XGBOOST_REGISTER_SORTED_CSC_PAGE_FORMAT(compressed)
+    .describe("Compressed binary data format.")
+    .set_body([]() { return new SparsePageCompressedFormat<SortedCSCPage>(); });
+
+XGBOOST_REGISTER_GHIST_INDEX_PAGE_FORMAT(compressed)
+    .describe("Compressed GHistIndex binary data format.")
+    .set_body([]() { return new GHistIndexCompressedFormat(); });
+}  // namespace data
+}  // namespace xgboost
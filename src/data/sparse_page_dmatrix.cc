@@ -6,7 +6,12 @@
  */
 #include "./sparse_page_dmatrix.h"
 
+#include <cstdio>   // for rename
+#include <fstream>  // for ifstream
+
 #include "../collective/communicator-inl.h"
+#include "../common/io.h"  // for MemoryBufferStream
+#include "../common/threading_utils.h"  // for ParallelFor
 #include "./simple_batch_iterator.h"
 #include "gradient_index.h"
 
@@ -39,13 +44,138 @@ std::size_t NFeaturesDevice(DMatrixProxy *)  // NOLINT
 #endif
 }  // namespace detail
 
+namespace {
+// Bump the version when the layout of the cache or its metadata is changed.
+constexpr std::int32_t kCacheMetaVersion = 4;
+char constexpr kCacheMetaMagic[] = "xgboost-ext-mem-cache";
+
+// FNV-1a hash, a persistent cache must not depend on the implementation of std::hash.
+template <typename T>
+std::uint64_t HashBytes(common::Span<T const> data, std::uint64_t h) {
+  constexpr std::uint64_t kPrime = 1099511628211ul;
+  auto const *bytes = reinterpret_cast<std::uint8_t const *>(data.data());
+  for (std::size_t i = 0; i < data.size_bytes(); ++i) {
+    h ^= bytes[i];
+    h *= kPrime;
+  }
+  return h;
+}
+constexpr std::uint64_t kHashSeed = 14695981039346656037ul;
+template <typename T>
+std::uint64_t HashValue(T const &v, std::uint64_t h) {
+  return HashBytes(common::Span<T const>{&v, 1}, h);
+}
+
+// Rows are hashed in blocks of fixed size, the result doesn't depend on the number of
+// threads.
+template <typename Fn>
+std::uint64_t HashRows(std::size_t n_rows, std::int32_t n_threads, std::uint64_t h, Fn &&fn) {
+  constexpr std::size_t kBlockRows = 4096;
+  std::vector<std::uint64_t> blocks(common::DivRoundUp(n_rows, kBlockRows));
+  common::ParallelFor(blocks.size(), n_threads, [&](auto i) {
+    auto bh = kHashSeed;
+    auto end = std::min(n_rows, (i + 1) * kBlockRows);
+    for (std::size_t ridx = i * kBlockRows; ridx < end; ++ridx) {
+      bh = fn(ridx, bh);
+    }
+    blocks[i] = bh;
+  });
+  return HashBytes(common::Span<std::uint64_t const>{blocks}, h);
+}
+
+// Hash the valid elements of an adapter batch in place.  The result equals `HashPage` of
+// the page obtained by pushing the batch.
+template <typename Batch>
+std::uint64_t HashBatch(Batch const &batch, float missing, std::int32_t n_threads,
+                        std::uint64_t h) {
+  static_assert(Batch::kIsRowMajor, "Column-major batch is not supported.");
+  IsValidFunctor is_valid{missing};
+  return HashRows(batch.Size(), n_threads, h, [&](std::size_t ridx, std::uint64_t bh) {
+    auto line = batch.GetLine(ridx);
+    std::uint64_t n_valid{0};
+    for (std::size_t j = 0; j < line.Size(); ++j) {
+      auto e = line.GetElement(j);
+      if (is_valid(e)) {
+        bh = HashValue(static_cast<bst_feature_t>(e.column_idx), bh);
+        bh = HashValue(e.value, bh);
+        ++n_valid;
+      }
+    }
+    return HashValue(n_valid, bh);
+  });
+}
+
+std::uint64_t HashPage(SparsePage const &page, std::int32_t n_threads, std::uint64_t h) {
+  auto view = page.GetView();
+  return HashRows(page.Size(), n_threads, h, [&](std::size_t ridx, std::uint64_t bh) {
+    auto row = view[ridx];
+    for (auto const &e : row) {
+      bh = HashValue(e.index, bh);
+      bh = HashValue(e.fvalue, bh);
+    }
+    return HashValue(static_cast<std::uint64_t>(row.size()), bh);
+  });
+}
+
+std::uint64_t HashInfo(MetaInfo const &info, std::uint64_t h) {
+  h = HashBytes(info.labels.Data()->ConstHostSpan(), h);
+  h = HashBytes(info.weights_.ConstHostSpan(), h);
+  h = HashBytes(info.base_margin_.Data()->ConstHostSpan(), h);
+  h = HashBytes(common::Span<bst_group_t const>{info.group_ptr_}, h);
+  h = HashBytes(info.labels_lower_bound_.ConstHostSpan(), h);
+  return HashBytes(info.labels_upper_bound_.ConstHostSpan(), h);
+}
+
+/**
+ * \brief Fingerprint of the data source. All batches are hashed along with their meta
+ *        info and the missing value.  This is a pass over the data iterator, but the
+ *        batches are read in place without building any page.  The fingerprint of a new
+ *        cache is obtained from the pages instead, see the constructor.
+ */
+std::uint64_t SourceFingerprint(DataIterProxy<DataIterResetCallback, XGDMatrixCallbackNext> *iter,
+                                DMatrixProxy *proxy, float missing, std::int32_t n_threads) {
+  auto h = HashValue(missing, kHashSeed);
+  std::uint32_t n_batches{0};
+  iter->Reset();
+  while (iter->Next()) {
+    bool type_error{false};
+    HostAdapterDispatch(
+        proxy, [&](auto const &batch) { h = HashBatch(batch, missing, n_threads, h); },
+        &type_error);
+    if (type_error) {
+      SparsePage page;
+      DevicePush(proxy, missing, &page);
+      h = HashPage(page, n_threads, h);
+    }
+    h = HashInfo(proxy->Info(), h);
+    ++n_batches;
+  }
+  CHECK_NE(n_batches, 0) << "Must have at least 1 batch.";
+  iter->Reset();
+  return HashValue(n_batches, h);
+}
+
+std::uint64_t CutsFingerprint(common::HistogramCuts const &cuts) {
+  auto h = HashBytes(common::Span<float const>{cuts.Values()}, kHashSeed);
+  h = HashBytes(common::Span<std::uint32_t const>{cuts.Ptrs()}, h);
+  return HashBytes(common::Span<float const>{cuts.MinValues()}, h);
+}
+
+bool CacheFileValid(Cache const &cache) {
+  std::ifstream fin{cache.ShardName(cache.name, cache.format),
+                    std::ios::binary | std::ios::ate};
+  return fin && static_cast<std::size_t>(fin.tellg()) == cache.offset.back();
+}
+}  // namespace
+
 
 SparsePageDMatrix::SparsePageDMatrix(DataIterHandle iter_handle, DMatrixHandle proxy_handle,
                                      DataIterResetCallback *reset,
                                      XGDMatrixCallbackNext *next, float missing,
-                                     int32_t nthreads, std::string cache_prefix)
+                                     int32_t nthreads, std::string cache_prefix,
+                                     bool persistent_cache)
     : proxy_{proxy_handle}, iter_{iter_handle}, reset_{reset}, next_{next}, missing_{missing},
-      cache_prefix_{std::move(cache_prefix)} {
+      cache_prefix_{std::move(cache_prefix)}, persistent_{persistent_cache} {
   ctx_.nthread = nthreads;
   cache_prefix_ = cache_prefix_.empty() ? "DMatrix" : cache_prefix_;
   if (collective::IsDistributed()) {
@@ -79,32 +209,200 @@ SparsePageDMatrix::SparsePageDMatrix(DataIterHandle iter_handle, DMatrixHandle p
     return n_features;
   };
 
-  // the proxy is iterated together with the sparse page source so we can obtain all
-  // information in 1 pass.
-  for (auto const &page : this->GetRowBatchesImpl()) {
-    this->info_.Extend(std::move(proxy->Info()), false, false);
-    n_features = std::max(n_features, num_cols());
-    n_samples += num_rows();
-    nnz += page.data.Size();
-    n_batches++;
-  }
+  bool loaded = persistent_ && this->LoadCacheMeta();
 
-  iter.Reset();
+  if (loaded) {
+    LOG(INFO) << "Reuse the external memory cache: " << this->MetaName();
+  } else {
+    // The fingerprint of a new cache is obtained from the pages being built.
+    auto h = HashValue(missing_, kHashSeed);
+    // the proxy is iterated together with the sparse page source so we can obtain all
+    // information in 1 pass.
+    for (auto const &page : this->GetRowBatchesImpl()) {
+      if (persistent_) {
+        h = HashInfo(proxy->Info(), HashPage(page, ctx_.Threads(), h));
+      }
+      this->info_.Extend(std::move(proxy->Info()), false, false);
+      n_features = std::max(n_features, num_cols());
+      n_samples += num_rows();
+      nnz += page.data.Size();
+      n_batches++;
+    }
+    fingerprint_ = HashValue(n_batches, h);
 
-  this->n_batches_ = n_batches;
-  this->info_.num_row_ = n_samples;
-  this->info_.num_col_ = n_features;
-  this->info_.num_nonzero_ = nnz;
+    iter.Reset();
+
+    this->n_batches_ = n_batches;
+    this->info_.num_row_ = n_samples;
+    this->info_.num_col_ = n_features;
+    this->info_.num_nonzero_ = nnz;
+  }
+  if (persistent_) {
+    // Keep the meta info from the data source, users might modify it later.
+    common::MemoryBufferStream fo{&source_info_};
+    this->info_.SaveBinary(&fo);
+    // Save the metadata once the row page is built instead of waiting for the destructor.
+    this->SaveCacheMeta();
+  }
 
   collective::Allreduce<collective::Operation::kMax>(&info_.num_col_, 1);
   CHECK_NE(info_.num_col_, 0);
 }
 
+bool SparsePageDMatrix::LoadCacheMeta() {
+  std::unique_ptr<dmlc::Stream> fi{dmlc::Stream::Create(this->MetaName().c_str(), "r", true)};
+  if (!fi) {
+    return false;
+  }
+  try {
+    std::string magic;
+    std::int32_t version{0};
+    std::uint64_t fingerprint{0};
+    if (!fi->Read(&magic) || magic != kCacheMetaMagic || !fi->Read(&version) ||
+        version != kCacheMetaVersion) {
+      LOG(WARNING) << "Invalid external memory cache: " << this->MetaName();
+      return false;
+    }
+    if (!fi->Read(&fingerprint)) {
+      LOG(WARNING) << "Invalid external memory cache: " << this->MetaName();
+      return false;
+    }
+    auto iter = DataIterProxy<DataIterResetCallback, XGDMatrixCallbackNext>{iter_, reset_, next_};
+    fingerprint_ = SourceFingerprint(&iter, MakeProxy(proxy_), missing_, ctx_.Threads());
+    if (fingerprint != fingerprint_) {
+      LOG(INFO) << "The data source has changed, rebuilding the external memory cache.";
+      return false;
+    }
+
+    std::uint32_t n_batches{0};
+    CHECK(fi->Read(&n_batches));
+    MetaInfo info;
+    info.LoadBinary(fi.get());
+    bst_bin_t max_bin{0};
+    double sparse_thresh{0};
+    std::uint64_t cuts_fingerprint{0};
+    CHECK(fi->Read(&max_bin));
+    CHECK(fi->Read(&sparse_thresh));
+    CHECK(fi->Read(&cuts_fingerprint));
+
+    std::uint64_t n_caches{0};
+    CHECK(fi->Read(&n_caches));
+    std::map<std::string, std::shared_ptr<Cache>> cache_info;
+    for (std::uint64_t i = 0; i < n_caches; ++i) {
+      auto cache = Cache::Load(fi.get());
+      CHECK(cache);
+      CHECK_EQ(cache->offset.size(), n_batches + 1);
+      if (!CacheFileValid(*cache)) {
+        // The dependent pages can be regenerated from the row page.
+        LOG(WARNING) << "Invalid external memory cache: " << cache->ShardName();
+        continue;
+      }
+      // The page files keep the name from the DMatrix that wrote them, while the cache is
+      // indexed by the ID of this DMatrix.
+      cache_info[MakeId(cache_prefix_, this) + cache->format] = cache;
+    }
+    if (cache_info.find(MakeId(cache_prefix_, this) + ".row.page") == cache_info.cend()) {
+      return false;
+    }
+
+    this->n_batches_ = n_batches;
+    this->info_ = std::move(info);
+    this->cache_info_ = std::move(cache_info);
+    this->cuts_fingerprint_ = cuts_fingerprint;
+    if (max_bin != 0) {
+      this->batch_param_ = BatchParam{max_bin, sparse_thresh};
+    }
+  } catch (dmlc::Error const &e) {
+    LOG(WARNING) << "Failed to load the external memory cache: " << e.what();
+    return false;
+  }
+  return true;
+}
+
+std::set<std::string> SparsePageDMatrix::SaveCacheMeta() {
+  std::set<std::string> persisted;
+  if (!persistent_) {
+    return persisted;
+  }
+
+  for (auto const &kv : cache_info_) {
+    if (!kv.second->written) {
+      continue;
+    }
+    auto const &fmt = kv.second->format;
+    if (fmt == ".row.page" || fmt == ".col.page" || fmt == ".sorted.col.page") {
+      persisted.insert(kv.first);
+    }
+    // The gradient index for approx is regenerated with hessian in each iteration.
+    if (fmt == ".gradient_index.page" && batch_param_.hess.empty() && !batch_param_.regen) {
+      persisted.insert(kv.first);
+    }
+  }
+  if (persisted.find(MakeId(cache_prefix_, this) + ".row.page") == persisted.cend()) {
+    return {};
+  }
+  bool has_ghist = std::any_of(persisted.cbegin(), persisted.cend(), [&](auto const &id) {
+    return cache_info_.at(id)->format == ".gradient_index.page";
+  });
+
+  if (!meta_dirty_ && persisted == saved_caches_) {
+    return persisted;
+  }
+
+  std::string meta;
+  {
+    common::MemoryBufferStream buf{&meta};
+    dmlc::Stream *fo = &buf;
+    fo->Write(std::string{kCacheMetaMagic});
+    fo->Write(kCacheMetaVersion);
+    fo->Write(fingerprint_);
+    fo->Write(n_batches_);
+    fo->Write(source_info_.data(), source_info_.size());
+    fo->Write(has_ghist ? batch_param_.max_bin : static_cast<bst_bin_t>(0));
+    fo->Write(batch_param_.sparse_thresh);
+    fo->Write(cuts_fingerprint_);
+    fo->Write(static_cast<std::uint64_t>(persisted.size()));
+    for (auto const &id : persisted) {
+      cache_info_.at(id)->Save(fo);
+    }
+  }
+
+  try {
+    // Write to a temporary file first so that a partially written metadata is never
+    // picked up by another process.
+    auto tmp = MakeId(cache_prefix_, this) + ".meta.tmp";
+    {
+      std::unique_ptr<dmlc::Stream> fo{dmlc::Stream::Create(tmp.c_str(), "w")};
+      fo->Write(meta.data(), meta.size());
+    }
+    if (std::rename(tmp.c_str(), this->MetaName().c_str()) != 0) {
+      LOG(WARNING) << "Failed to save the external memory cache: " << this->MetaName();
+      TryDeleteCacheFile(tmp);
+      return {};
+    }
+  } catch (dmlc::Error const &e) {
+    LOG(WARNING) << "Failed to save the external memory cache: " << e.what();
+    return {};
+  }
+  saved_caches_ = persisted;
+  meta_dirty_ = false;
+  return persisted;
+}
+
+void SparsePageDMatrix::DropCache(std::string const &id) {
+  auto n = cache_info_.at(id)->ShardName();
+  if (std::ifstream{n}) {
+    TryDeleteCacheFile(n);
+  }
+  cache_info_.erase(id);
+  meta_dirty_ = true;
+}
+
 void SparsePageDMatrix::InitializeSparsePage() {
   auto id = MakeCache(this, ".row.page", cache_prefix_, &cache_info_);
   // Don't use proxy DMatrix once this is already initialized, this allows users to
   // release the iterator and data.
-  if (cache_info_.at(id)->written) {
+  if (cache_info_.at(id)->written && sparse_page_source_) {
     CHECK(sparse_page_source_);
     sparse_page_source_->Reset();
     return;
@@ -126,10 +424,12 @@ BatchSet<SparsePage> SparsePageDMatrix::GetRowBatchesImpl() {
 }
 
 BatchSet<SparsePage> SparsePageDMatrix::GetRowBatches() {
+  this->SaveCacheMeta();
   return this->GetRowBatchesImpl();
 }
 
 BatchSet<CSCPage> SparsePageDMatrix::GetColumnBatches() {
+  this->SaveCacheMeta();
   auto id = MakeCache(this, ".col.page", cache_prefix_, &cache_info_);
   CHECK_NE(this->Info().num_col_, 0);
   this->InitializeSparsePage();
@@ -145,6 +445,7 @@ BatchSet<CSCPage> SparsePageDMatrix::GetColumnBatches() {
 }
 
 BatchSet<SortedCSCPage> SparsePageDMatrix::GetSortedColumnBatches() {
+  this->SaveCacheMeta();
   auto id = MakeCache(this, ".sorted.col.page", cache_prefix_, &cache_info_);
   CHECK_NE(this->Info().num_col_, 0);
   this->InitializeSparsePage();
@@ -161,10 +462,33 @@ BatchSet<SortedCSCPage> SparsePageDMatrix::GetSortedColumnBatches() {
 
 BatchSet<GHistIndexMatrix> SparsePageDMatrix::GetGradientIndex(const BatchParam &param) {
   CHECK_GE(param.max_bin, 2);
+  this->SaveCacheMeta();
   auto id = MakeCache(this, ".gradient_index.page", cache_prefix_, &cache_info_);
   this->InitializeSparsePage();
+  if (cache_info_.at(id)->written && !ghist_index_source_ && !RegenGHist(batch_param_, param)) {
+    // The cache is loaded from a previous run, validate the histogram cuts stored in it.  The
+    // file might have been replaced by another DMatrix sharing the cache.
+    bool valid = CacheFileValid(*cache_info_.at(id));
+    if (valid) {
+      auto ft = this->info_.feature_types.ConstHostSpan();
+      ghist_index_source_.reset(new GradientIndexPageSource(
+          this->missing_, this->ctx_.Threads(), this->Info().num_col_, this->n_batches_,
+          cache_info_.at(id), batch_param_, common::HistogramCuts{}, this->IsDense(), ft,
+          sparse_page_source_));
+      valid = CutsFingerprint((**ghist_index_source_).cut) == cuts_fingerprint_;
+    }
+    if (!valid) {
+      LOG(WARNING) << "Invalid gradient index in the external memory cache.";
+      ghist_index_source_.reset();
+      this->DropCache(id);
+      MakeCache(this, ".gradient_index.page", cache_prefix_, &cache_info_);
+    }
+    this->InitializeSparsePage();
+  }
   if (!cache_info_.at(id)->written || RegenGHist(batch_param_, param)) {
-    cache_info_.erase(id);
+    // Release the old pages before removing their file.
+    ghist_index_source_.reset();
+    this->DropCache(id);
     MakeCache(this, ".gradient_index.page", cache_prefix_, &cache_info_);
     LOG(INFO) << "Generating new Gradient Index.";
     // Use sorted sketch for approx.
@@ -174,8 +498,8 @@ BatchSet<GHistIndexMatrix> SparsePageDMatrix::GetGradientIndex(const BatchParam
     this->InitializeSparsePage();  // reset after use.
 
     batch_param_ = param;
-    ghist_index_source_.reset();
     CHECK_NE(cuts.Values().size(), 0);
+    cuts_fingerprint_ = CutsFingerprint(cuts);
     auto ft = this->info_.feature_types.ConstHostSpan();
     ghist_index_source_.reset(new GradientIndexPageSource(
         this->missing_, this->ctx_.Threads(), this->Info().num_col_, this->n_batches_,
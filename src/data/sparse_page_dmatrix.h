@@ -10,7 +10,9 @@
 #include <xgboost/data.h>
 #include <xgboost/logging.h>
 #include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -72,16 +74,40 @@ class SparsePageDMatrix : public DMatrix {
   Context ctx_;
   std::string cache_prefix_;
   uint32_t n_batches_ {0};
+  // Keep the cache files along with their metadata after the DMatrix is destroyed, so
+  // that they can be reused by another DMatrix constructed from the same data.
+  bool persistent_{false};
+  // Fingerprint of the data source, used for validating a persistent cache.
+  std::uint64_t fingerprint_{0};
+  // Fingerprint of the histogram cuts used by the gradient index cache.
+  std::uint64_t cuts_fingerprint_{0};
+  // Serialized meta info obtained from the data source.
+  std::string source_info_;
+  // Caches recorded in the last saved metadata.  The metadata is rewritten only when this
+  // set changes or a cache is replaced.
+  std::set<std::string> saved_caches_;
+  bool meta_dirty_{true};
+
   // sparse page is the source to other page types, we make a special member function.
   void InitializeSparsePage();
   // Non-virtual version that can be used in constructor
   BatchSet<SparsePage> GetRowBatchesImpl();
+  // Load the metadata of a persistent cache, returns false if there's no valid cache.
+  bool LoadCacheMeta();
+  // Save the metadata of a persistent cache, returns the ID of caches being kept.  Called
+  // whenever a batch set is requested, so that caches completed by an earlier pass are
+  // recorded without waiting for the destructor.
+  std::set<std::string> SaveCacheMeta();
+  // Remove a cache along with its file, used when the cache is replaced.
+  void DropCache(std::string const &id);
+  [[nodiscard]] std::string MetaName() const { return cache_prefix_ + ".meta"; }
 
  public:
   explicit SparsePageDMatrix(DataIterHandle iter, DMatrixHandle proxy,
                              DataIterResetCallback *reset,
                              XGDMatrixCallbackNext *next, float missing,
-                             int32_t nthreads, std::string cache_prefix);
+                             int32_t nthreads, std::string cache_prefix,
+                             bool persistent_cache = false);
 
   ~SparsePageDMatrix() override {
     // Clear out all resources before deleting the cache file.
@@ -91,13 +117,19 @@ class SparsePageDMatrix : public DMatrix {
     sorted_column_source_.reset();
     ghist_index_source_.reset();
 
+    auto persisted = this->SaveCacheMeta();
     for (auto const &kv : cache_info_) {
       CHECK(kv.second);
+      if (persisted.find(kv.first) != persisted.cend()) {
+        continue;
+      }
       auto n = kv.second->ShardName();
       TryDeleteCacheFile(n);
     }
   }
 
+  [[nodiscard]] bool PersistentCache() const { return persistent_; }
+
   MetaInfo& Info() override;
   const MetaInfo& Info() const override;
   Context const* Ctx() const override { return &ctx_; }
@@ -135,7 +167,9 @@ class SparsePageDMatrix : public DMatrix {
   bool SparsePageExists() const override { return static_cast<bool>(sparse_page_source_); }
 };
 
-inline std::string MakeId(std::string prefix, SparsePageDMatrix *ptr) {
+inline std::string MakeId(std::string prefix, SparsePageDMatrix const *ptr) {
+  // Persistent caches are found through the metadata file named after the prefix, the
+  // pages still have a suffix so that live DMatrix objects don't overwrite each other.
   std::stringstream ss;
   ss << ptr;
   return prefix + "-" + ss.str();
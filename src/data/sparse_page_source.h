@@ -6,22 +6,29 @@
 #define XGBOOST_DATA_SPARSE_PAGE_SOURCE_H_
 
 #include <algorithm>  // std::min
+#include <array>      // for array
+#include <cstdint>    // for uint8_t
+#include <cstdio>     // for remove
 #include <string>
 #include <utility>
 #include <vector>
 #include <future>
 #include <thread>
+#include <type_traits>  // for is_same_v
 #include <map>
 #include <memory>
 
 #include "xgboost/base.h"
 #include "xgboost/data.h"
+#include "xgboost/global_config.h"
 
 #include "adapter.h"
 #include "sparse_page_writer.h"
 #include "proxy_dmatrix.h"
 
 #include "../common/common.h"
+#include "../common/io.h"  // for MmapFile
+#include "../common/threadpool.h"
 #include "../common/timer.h"
 
 namespace xgboost {
@@ -38,8 +45,12 @@ struct Cache {
   bool written;
   std::string name;
   std::string format;
+  // name of the page format used for encoding the pages, see `CreatePageFormat`.
+  std::string page_format{"raw"};
   // offset into binary cache file.
   std::vector<size_t> offset;
+  // size of each page in memory after decoding, used for the prefetch budget.
+  std::vector<std::size_t> decoded_bytes;
 
   Cache(bool w, std::string n, std::string fmt)
       : written{w}, name{std::move(n)}, format{std::move(fmt)} {
@@ -62,8 +73,72 @@ struct Cache {
       written = true;
     }
   }
+
+  // Serialize the metadata of a completed cache, used by the persistent cache.
+  void Save(dmlc::Stream* fo) const {
+    CHECK(written);
+    fo->Write(name);
+    fo->Write(format);
+    fo->Write(page_format);
+    fo->Write(offset);
+    fo->Write(decoded_bytes);
+  }
+
+  static std::shared_ptr<Cache> Load(dmlc::Stream* fi) {
+    std::string name, format, page_format;
+    std::vector<size_t> offset;
+    std::vector<std::size_t> decoded_bytes;
+    if (!fi->Read(&name) || !fi->Read(&format) || !fi->Read(&page_format) ||
+        !fi->Read(&offset) || !fi->Read(&decoded_bytes) ||
+        decoded_bytes.size() + 1 != offset.size()) {
+      return nullptr;
+    }
+    auto cache = std::make_shared<Cache>(true, std::move(name), std::move(format));
+    cache->page_format = std::move(page_format);
+    cache->offset = std::move(offset);
+    cache->decoded_bytes = std::move(decoded_bytes);
+    return cache;
+  }
 };
 
+/**
+ * \brief Size of a decoded page in memory, pages in the compressed formats are larger than
+ *        in the cache file.  Ellpack pages are only held in the host memory in the cache
+ *        layout.
+ */
+template <typename S>
+std::size_t DecodedPageBytes(S const& page, std::size_t n_written) {
+  if constexpr (std::is_same_v<S, EllpackPage>) {
+    return n_written;
+  } else {
+    return page.MemCostBytes();
+  }
+}
+
+/**
+ * \brief Number of pages to be fetched starting from page `begin` (included), such that the
+ *        total size of the pages fits in the memory budget. At least one page is fetched.
+ *
+ * \param page_bytes Size of each page in memory.
+ * \param begin      Index of the first page.
+ * \param budget     Memory budget in bytes.
+ * \param max_depth  Maximum number of pages.
+ */
+inline std::size_t PrefetchDepth(std::vector<std::size_t> const& page_bytes, std::size_t begin,
+                                 std::size_t budget, std::size_t max_depth) {
+  CHECK_GE(page_bytes.size(), 1);
+  std::size_t n_batches = page_bytes.size();
+  std::size_t n = 0, bytes = 0;
+  for (std::size_t it = begin; n < std::min(max_depth, n_batches); ++n, ++it) {
+    it %= n_batches;  // ring
+    if (n != 0 && bytes + page_bytes[it] > budget) {
+      break;
+    }
+    bytes += page_bytes[it];
+  }
+  return std::max(n, static_cast<std::size_t>(1));
+}
+
 // Prevents multi-threaded call.
 class TryLockGuard {
   std::mutex& lock_;
@@ -96,11 +171,24 @@ class SparsePageSourceImpl : public BatchIteratorImpl<S> {
 
   std::shared_ptr<Cache> cache_info_;
   std::unique_ptr<dmlc::Stream> fo_;
+  // Memory mapping of the cache file, pages are decoded directly from the mapping instead
+  // of being read through a new file stream.  Formats with an aligned layout, like the raw
+  // format of the gradient index, refer to the mapping instead of copying the data.
+  std::shared_ptr<common::MmapFile> mmap_;
 
   using Ring = std::vector<std::future<std::shared_ptr<S>>>;
   // A ring storing futures to data.  Since the DMatrix iterator is forward only, so we
   // can pre-fetch data in a ring.
   std::unique_ptr<Ring> ring_{new Ring};
+  // Upper bound for the number of pre-fetched batches, the actual number is determined by
+  // the size of pages and the `ext_mem_prefetch_bytes` global parameter.
+  static constexpr std::size_t kMaxPrefetch = 16;
+  // Number of threads for reading pages.
+  static constexpr std::int32_t kIOThreads = 4;
+  // Threads for reading pages, kept alive between batches.
+  std::unique_ptr<common::ThreadPool> workers_;
+  // Measures the time spent waiting for pages to be read.
+  common::Monitor monitor_;
 
   bool ReadCache() {
     CHECK(!at_end_);
@@ -111,12 +199,16 @@ class SparsePageSourceImpl : public BatchIteratorImpl<S> {
       fo_.reset();  // flush the data to disk.
       ring_->resize(n_batches_);
     }
-    // An heuristic for number of pre-fetched batches.  We can make it part of BatchParam
-    // to let user adjust number of pre-fetched batches when needed.
-    uint32_t constexpr kPreFetch = 4;
-
-    size_t n_prefetch_batches = std::min(kPreFetch, n_batches_);
-    CHECK_GT(n_prefetch_batches, 0) << "total batches:" << n_batches_;
+    if (common::MmapFile::Supported() && !mmap_) {
+      mmap_ = std::make_shared<common::MmapFile>(cache_info_->ShardName());
+    }
+    if (!workers_) {
+      workers_ = std::make_unique<common::ThreadPool>(kIOThreads);
+    }
+    CHECK_GT(n_batches_, 0);
+    auto budget = GlobalConfigThreadLocalStore::Get()->ext_mem_prefetch_bytes;
+    size_t n_prefetch_batches = PrefetchDepth(cache_info_->decoded_bytes, count_,
+                                              static_cast<std::size_t>(budget), kMaxPrefetch);
     size_t fetch_it = count_;
 
     for (size_t i = 0; i < n_prefetch_batches; ++i, ++fetch_it) {
@@ -126,43 +218,85 @@ class SparsePageSourceImpl : public BatchIteratorImpl<S> {
       }
       auto const *self = this;  // make sure it's const
       CHECK_LT(fetch_it, cache_info_->offset.size());
-      ring_->at(fetch_it) = std::async(std::launch::async, [fetch_it, self]() {
+      if (mmap_) {
+        // Start loading the page from disk before the decoding thread touches it.
+        mmap_->WillNeed(this->PageOffset(fetch_it), this->PageBytes(fetch_it));
+      }
+      ring_->at(fetch_it) = workers_->Submit([fetch_it, self, mmap = mmap_]() {
         common::Timer timer;
         timer.Start();
-        std::unique_ptr<SparsePageFormat<S>> fmt{CreatePageFormat<S>("raw")};
-        auto n = self->cache_info_->ShardName();
-        size_t offset = self->cache_info_->offset.at(fetch_it);
-        std::unique_ptr<dmlc::SeekStream> fi{dmlc::SeekStream::CreateForRead(n.c_str())};
-        fi->Seek(offset);
-        CHECK_EQ(fi->Tell(), offset);
+        // Decoding is performed here in the prefetch thread.
+        std::unique_ptr<SparsePageFormat<S>> fmt{
+            CreatePageFormat<S>(self->cache_info_->page_format)};
         auto page = std::make_shared<S>();
-        CHECK(fmt->Read(page.get(), fi.get()));
+        size_t offset = self->PageOffset(fetch_it);
+        if (mmap) {
+          CHECK(fmt->ReadMapped(page.get(), mmap, offset, self->PageBytes(fetch_it)));
+        } else {
+          auto n = self->cache_info_->ShardName();
+          std::unique_ptr<dmlc::SeekStream> fi{dmlc::SeekStream::CreateForRead(n.c_str())};
+          fi->Seek(offset);
+          CHECK_EQ(fi->Tell(), offset);
+          CHECK(fmt->Read(page.get(), fi.get()));
+        }
         LOG(INFO) << "Read a page in " << timer.ElapsedSeconds() << " seconds.";
         return page;
       });
     }
-    CHECK_EQ(std::count_if(ring_->cbegin(), ring_->cend(), [](auto const& f) { return f.valid(); }),
-             n_prefetch_batches)
+    // Pages scheduled by previous calls might exceed the current depth when the page size
+    // varies.
+    CHECK_LE(std::count_if(ring_->cbegin(), ring_->cend(), [](auto const& f) { return f.valid(); }),
+             kMaxPrefetch)
         << "Sparse DMatrix assumes forward iteration.";
+    monitor_.Start("Stall");
     page_ = (*ring_)[count_].get();
+    monitor_.Stop("Stall");
+    if (mmap_ && n_batches_ > 1) {
+      // Iteration has moved past the previous page, release its mapped memory.  The current
+      // page can still refer to the mapping.
+      auto prev = (count_ + n_batches_ - 1) % n_batches_;
+      mmap_->DontNeed(this->PageOffset(prev), this->PageBytes(prev));
+    }
     return true;
   }
 
+  [[nodiscard]] std::size_t PageOffset(std::size_t i) const {
+    return cache_info_->offset.at(i);
+  }
+  [[nodiscard]] std::size_t PageBytes(std::size_t i) const {
+    return cache_info_->offset.at(i + 1) - cache_info_->offset.at(i);
+  }
+
   void WriteCache() {
     CHECK(!cache_info_->written);
     common::Timer timer;
     timer.Start();
-    std::unique_ptr<SparsePageFormat<S>> fmt{CreatePageFormat<S>("raw")};
+    if (cache_info_->offset.size() == 1) {
+      // All pages in a cache share the same format. Fallback to raw for page types that
+      // don't have the requested format.
+      auto const& name = GlobalConfigThreadLocalStore::Get()->ext_mem_page_format;
+      CheckPageFormat(name);
+      cache_info_->page_format = HasPageFormat<S>(name) ? name : "raw";
+    }
+    std::unique_ptr<SparsePageFormat<S>> fmt{CreatePageFormat<S>(cache_info_->page_format)};
     if (!fo_) {
       auto n = cache_info_->ShardName();
+      // Pages loaded from a previous cache can still refer to the mapping of the old file,
+      // replace the file instead of truncating it.
+      std::remove(n.c_str());
       fo_.reset(dmlc::Stream::Create(n.c_str(), "w"));
     }
     auto bytes = fmt->Write(*page_, fo_.get());
+    // Pad the page to keep the next one aligned.
+    auto n_padding = common::DivRoundUp(bytes, kPageAlignment) * kPageAlignment - bytes;
+    std::array<std::uint8_t, kPageAlignment> padding{};
+    fo_->Write(padding.data(), n_padding);
     timer.Stop();
 
     LOG(INFO) << static_cast<double>(bytes) / 1024.0 / 1024.0 << " MB written in "
               << timer.ElapsedSeconds() << " seconds.";
-    cache_info_->offset.push_back(bytes);
+    cache_info_->offset.push_back(bytes + n_padding);
+    cache_info_->decoded_bytes.push_back(DecodedPageBytes(*page_, bytes));
   }
 
   virtual void Fetch() = 0;
@@ -171,7 +305,9 @@ class SparsePageSourceImpl : public BatchIteratorImpl<S> {
   SparsePageSourceImpl(float missing, int nthreads, bst_feature_t n_features,
                        uint32_t n_batches, std::shared_ptr<Cache> cache)
       : missing_{missing}, nthreads_{nthreads}, n_features_{n_features},
-        n_batches_{n_batches}, cache_info_{std::move(cache)} {}
+        n_batches_{n_batches}, cache_info_{std::move(cache)} {
+    monitor_.Init("SparsePageSource");
+  }
 
   SparsePageSourceImpl(SparsePageSourceImpl const &that) = delete;
 
@@ -15,6 +15,9 @@
 #include <utility>
 #include <memory>
 #include <functional>
+#include <sstream>  // for stringstream
+
+#include "../common/io.h"  // for MmapFile
 
 #if DMLC_ENABLE_STD_THREAD
 #include <dmlc/concurrency.h>
@@ -27,6 +30,12 @@ namespace data {
 template<typename T>
 struct SparsePageFormatReg;
 
+/**
+ * \brief Alignment of pages in the external memory cache, formats can align data relative to
+ *        the start of a page so that it can be used directly from a memory mapping.
+ */
+constexpr std::size_t kPageAlignment = 64;
+
 /*!
  * \brief Format specification of SparsePage.
  */
@@ -42,6 +51,16 @@ class SparsePageFormat {
    * \return true of the loading as successful, false if end of file was reached
    */
   virtual bool Read(T* page, dmlc::SeekStream* fi) = 0;
+  /**
+   * \brief Load a page stored in the byte range [offset, offset + n) of a memory mapped
+   *        file.  Formats with a suitable layout can refer to the mapping instead of copying
+   *        the data, the page then keeps the mapping alive.
+   */
+  virtual bool ReadMapped(T* page, std::shared_ptr<common::MmapFile const> mmap,
+                          std::size_t offset, std::size_t n) {
+    auto fi = mmap->Stream(offset, n);
+    return this->Read(page, &fi);
+  }
   /*!
    * \brief save the data to fo, when a page was written.
    * \param fo output stream
@@ -63,6 +82,33 @@ inline SparsePageFormat<T>* CreatePageFormat(const std::string& name) {
   return (e->body)();
 }
 
+/*!
+ * \brief Whether a format is registered for page type T.
+ */
+template <typename T>
+inline bool HasPageFormat(const std::string& name) {
+  return ::dmlc::Registry<SparsePageFormatReg<T>>::Get()->Find(name) != nullptr;
+}
+
+/*!
+ * \brief Check the name of the format for pages in the external memory cache.  All formats
+ *        are registered for the row page, other page types fall back to the raw format.
+ */
+inline void CheckPageFormat(std::string const& name) {
+  if (HasPageFormat<SparsePage>(name)) {
+    return;
+  }
+  auto names = ::dmlc::Registry<SparsePageFormatReg<SparsePage>>::ListAllNames();
+  std::sort(names.begin(), names.end());
+  std::stringstream ss;
+  ss << "Invalid external memory page format: '" << name << "', valid values are: {";
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    ss << (i == 0 ? "" : ", ") << "'" << names[i] << "'";
+  }
+  ss << "}";
+  LOG(FATAL) << ss.str();
+}
+
 /*!
  * \brief Registry entry for sparse page format.
  */
@@ -0,0 +1,376 @@
+/**
+ * Copyright 2023 by XGBoost Contributors
+ *
+ * \file text_parser.cc
+ */
+#include "text_parser.h"
+
+#include <algorithm>     // for find, min, max, copy, transform
+#include <cstdlib>       // for strtof
+#include <cstring>       // for strncmp
+#include <fstream>       // for ifstream
+#include <stdexcept>     // for logic_error
+#include <string>        // for string, stoi
+#include <system_error>  // for errc
+#include <utility>       // for move
+
+#include "../common/charconv.h"         // for from_chars
+#include "../common/common.h"           // for Split
+#include "../common/threading_utils.h"  // for ParallelFor
+#include "xgboost/logging.h"            // for CHECK
+
+namespace xgboost::data {
+namespace {
+// Chunks smaller than this are not worth the scheduling overhead.
+constexpr std::size_t kMinChunkBytes = 1 << 16;
+
+bool IsBlank(char c) { return c == ' ' || c == '\t'; }
+bool IsEol(char c) { return c == '\n' || c == '\r'; }
+
+char const* SkipBlank(char const* beg, char const* end) {
+  while (beg != end && IsBlank(*beg)) {
+    ++beg;
+  }
+  return beg;
+}
+
+char const* TrimBlank(char const* beg, char const* end) {
+  while (end != beg && IsBlank(*(end - 1))) {
+    --end;
+  }
+  return end;
+}
+
+float ParseFloat(char const* beg, char const* end) {
+  if (beg == end) {
+    return 0.0f;
+  }
+  float v;
+  auto res = from_chars(beg, end, v);
+  if (XGBOOST_EXPECT(res.ec == std::errc(), true)) {
+    return v;
+  }
+  // Slow path for inputs that are not handled by `from_chars`, like long mantissa, leading
+  // `+` sign, inf and nan.
+  std::string str{beg, end};
+  char* str_end{nullptr};
+  v = std::strtof(str.c_str(), &str_end);
+  CHECK(str_end == str.c_str() + str.size()) << "Invalid numeric value: `" << str << "`";
+  return v;
+}
+
+template <typename T>
+T ParseUInt(char const* beg, char const* end) {
+  CHECK(beg != end) << "Empty integer value.";
+  // Limit the number of digits to avoid overflowing uint64.
+  CHECK_LE(end - beg, 19) << "Integer value is too large: `" << std::string{beg, end} << "`";
+  std::uint64_t v{0};
+  for (auto it = beg; it != end; ++it) {
+    CHECK(*it >= '0' && *it <= '9') << "Invalid integer value: `" << std::string{beg, end} << "`";
+    v = v * 10 + static_cast<std::uint64_t>(*it - '0');
+  }
+  CHECK_LE(v, std::numeric_limits<T>::max()) << "Integer value is too large.";
+  return static_cast<T>(v);
+}
+
+/**
+ * \brief Return the beginning of the line following `pos`, or `pos` itself if it's
+ *        already at the beginning of a line.
+ */
+std::size_t AlignToLine(char const* data, std::size_t pos, std::size_t end) {
+  if (pos == 0 || pos >= end || data[pos - 1] == '\n') {
+    return std::min(pos, end);
+  }
+  auto it = std::find(data + pos, data + end, '\n');
+  return it == data + end ? end : static_cast<std::size_t>(it - data) + 1;
+}
+
+struct ChunkStat {
+  std::uint32_t min_index{std::numeric_limits<std::uint32_t>::max()};
+  bst_feature_t n_features{0};
+};
+
+void ParseLibSVMLine(char const* beg, char const* end, TextBlock* out, ChunkStat* stat) {
+  end = std::find(beg, end, '#');
+  auto p = beg;
+  char const* tok_beg;
+  char const* tok_end;
+  auto next_token = [&] {
+    p = SkipBlank(p, end);
+    if (p == end) {
+      return false;
+    }
+    tok_beg = p;
+    while (p != end && !IsBlank(*p)) {
+      ++p;
+    }
+    tok_end = p;
+    return true;
+  };
+  if (!next_token()) {
+    // empty line
+    return;
+  }
+  // label[:weight]
+  auto colon = std::find(tok_beg, tok_end, ':');
+  out->label.push_back(ParseFloat(tok_beg, colon));
+  if (colon != tok_end) {
+    out->weight.push_back(ParseFloat(colon + 1, tok_end));
+  }
+  while (next_token()) {
+    if (tok_end - tok_beg > 4 && std::strncmp(tok_beg, "qid:", 4) == 0) {
+      out->qid.push_back(ParseUInt<std::uint64_t>(tok_beg + 4, tok_end));
+      continue;
+    }
+    colon = std::find(tok_beg, tok_end, ':');
+    auto idx = ParseUInt<std::uint32_t>(tok_beg, colon);
+    // Feature without value is treated as an indicator.
+    auto v = colon == tok_end ? 1.0f : ParseFloat(colon + 1, tok_end);
+    out->index.push_back(idx);
+    out->value.push_back(v);
+    stat->min_index = std::min(stat->min_index, idx);
+    stat->n_features = std::max(stat->n_features, static_cast<bst_feature_t>(idx + 1));
+  }
+  out->offset.push_back(out->index.size());
+}
+
+void ParseCSVLine(TextParserParam const& param, char const* beg, char const* end,
+                  TextBlock* out, ChunkStat* stat) {
+  if (beg == end) {
+    return;
+  }
+  std::int32_t column{0};
+  std::uint32_t idx{0};
+  float label{0.0f}, weight{1.0f};
+  auto p = beg;
+  while (p != end) {
+    auto field_end = std::find(p, end, param.delimiter);
+    auto field_beg = SkipBlank(p, field_end);
+    // Empty field is parsed as 0, same as the dmlc parser.
+    auto v = ParseFloat(field_beg, TrimBlank(field_beg, field_end));
+    if (column == param.label_column) {
+      label = v;
+    } else if (column == param.weight_column) {
+      weight = v;
+    } else {
+      out->index.push_back(idx++);
+      out->value.push_back(v);
+    }
+    ++column;
+    p = field_end == end ? end : field_end + 1;
+  }
+  out->label.push_back(label);
+  if (param.weight_column >= 0) {
+    out->weight.push_back(weight);
+  }
+  stat->min_index = 0;
+  stat->n_features = std::max(stat->n_features, static_cast<bst_feature_t>(idx));
+  out->offset.push_back(out->index.size());
+}
+
+void ParseChunk(TextParserParam const& param, char const* beg, char const* end, TextBlock* out,
+                ChunkStat* stat) {
+  auto is_csv = param.format == "csv";
+  while (beg != end) {
+    auto line_end = beg;
+    while (line_end != end && !IsEol(*line_end)) {
+      ++line_end;
+    }
+    if (is_csv) {
+      ParseCSVLine(param, beg, line_end, out, stat);
+    } else {
+      ParseLibSVMLine(beg, line_end, out, stat);
+    }
+    beg = line_end;
+    while (beg != end && IsEol(*beg)) {
+      ++beg;
+    }
+  }
+}
+
+/**
+ * \brief Check the meta info is either present for all rows or not at all.
+ */
+template <typename T>
+void CheckMetaSize(std::vector<T> const& values, std::size_t n_rows, char const* name) {
+  CHECK(values.empty() || values.size() == n_rows)
+      << "The " << name << " field should be specified for all rows or none of them, got "
+      << values.size() << " values for " << n_rows << " rows.";
+}
+}  // anonymous namespace
+
+void TextBlock::Clear() {
+  offset.resize(1);
+  offset.front() = 0;
+  index.clear();
+  value.clear();
+  label.clear();
+  weight.clear();
+  qid.clear();
+  n_features = 0;
+}
+
+bool TextParser::ParseUri(std::string const& uri, std::string const& type,
+                          std::uint32_t n_parts, std::string* path, TextParserParam* param) {
+  if (n_parts != 1 || !common::MmapFile::Supported()) {
+    return false;
+  }
+  auto args = common::Split(uri, '?');
+  if (args.empty() || args.size() > 2) {
+    return false;
+  }
+  *path = args.front();
+  if (path->find("://") != std::string::npos || !std::ifstream{*path}.good()) {
+    // Remote and missing files are left to dmlc, which has better error messages.
+    return false;
+  }
+
+  TextParserParam p;
+  p.format = type;
+  bool has_csv_arg{false}, has_libsvm_arg{false};
+  try {
+    for (auto const& kv : common::Split(args.size() == 2 ? args.back() : "", '&')) {
+      if (kv.empty()) {
+        continue;
+      }
+      auto pair = common::Split(kv, '=');
+      if (pair.size() != 2) {
+        return false;
+      }
+      auto const& key = pair.front();
+      auto const& value = pair.back();
+      if (key == "format") {
+        p.format = value;
+      } else if (key == "label_column") {
+        p.label_column = std::stoi(value);
+        has_csv_arg = true;
+      } else if (key == "weight_column") {
+        p.weight_column = std::stoi(value);
+        has_csv_arg = true;
+      } else if (key == "delimiter") {
+        if (value.size() != 1) {
+          return false;
+        }
+        p.delimiter = value.front();
+        has_csv_arg = true;
+      } else if (key == "indexing_mode") {
+        p.indexing_mode = std::stoi(value);
+        has_libsvm_arg = true;
+      } else {
+        return false;
+      }
+    }
+  } catch (std::logic_error const&) {
+    // invalid_argument or out_of_range from stoi.
+    return false;
+  }
+
+  if (p.format == "auto") {
+    p.format = "libsvm";
+  }
+  if (p.format == "csv") {
+    if (has_libsvm_arg || IsBlank(p.delimiter) || IsEol(p.delimiter)) {
+      return false;
+    }
+  } else if (p.format == "libsvm") {
+    if (has_csv_arg) {
+      return false;
+    }
+  } else {
+    return false;
+  }
+  *param = std::move(p);
+  return true;
+}
+
+TextParser::TextParser(std::string const& path, TextParserParam param, std::int32_t n_threads,
+                       std::size_t block_bytes)
+    : param_{std::move(param)},
+      file_{std::make_unique<common::MmapFile>(path)},
+      n_threads_{std::max(n_threads, 1)},
+      block_bytes_{std::max(block_bytes, static_cast<std::size_t>(1))} {}
+
+bool TextParser::Next() {
+  block_.Clear();
+  auto size = file_->Size();
+  if (cursor_ >= size) {
+    return false;
+  }
+  auto const* data = file_->Data();
+  auto end = AlignToLine(data, cursor_ + std::min(block_bytes_, size - cursor_), size);
+
+  // Split the block into line aligned chunks, more chunks than threads for load balance.
+  auto n_bytes = end - cursor_;
+  auto n_chunks = std::max(static_cast<std::size_t>(1),
+                           std::min(static_cast<std::size_t>(n_threads_) * 4,
+                                    n_bytes / kMinChunkBytes));
+  std::vector<std::size_t> bounds{cursor_};
+  for (std::size_t k = 1; k < n_chunks; ++k) {
+    auto pos = AlignToLine(data, cursor_ + n_bytes * k / n_chunks, end);
+    if (pos > bounds.back() && pos < end) {
+      bounds.push_back(pos);
+    }
+  }
+  bounds.push_back(end);
+
+  n_chunks = bounds.size() - 1;
+  std::vector<TextBlock> chunks(n_chunks);
+  std::vector<ChunkStat> stats(n_chunks);
+  common::ParallelFor(n_chunks, n_threads_, common::Sched::Dyn(), [&](auto i) {
+    ParseChunk(param_, data + bounds[i], data + bounds[i + 1], &chunks[i], &stats[i]);
+  });
+  cursor_ = end;
+
+  // Concatenate the chunks.
+  std::vector<std::size_t> row_ptr(n_chunks + 1, 0), nnz_ptr(n_chunks + 1, 0),
+      weight_ptr(n_chunks + 1, 0), qid_ptr(n_chunks + 1, 0);
+  ChunkStat stat;
+  for (std::size_t i = 0; i < n_chunks; ++i) {
+    row_ptr[i + 1] = row_ptr[i] + chunks[i].Size();
+    nnz_ptr[i + 1] = nnz_ptr[i] + chunks[i].index.size();
+    weight_ptr[i + 1] = weight_ptr[i] + chunks[i].weight.size();
+    qid_ptr[i + 1] = qid_ptr[i] + chunks[i].qid.size();
+    stat.min_index = std::min(stat.min_index, stats[i].min_index);
+    stat.n_features = std::max(stat.n_features, stats[i].n_features);
+  }
+  auto n_rows = row_ptr.back();
+  auto nnz = nnz_ptr.back();
+  block_.offset.resize(n_rows + 1);
+  block_.index.resize(nnz);
+  block_.value.resize(nnz);
+  block_.label.resize(n_rows);
+  block_.weight.resize(weight_ptr.back());
+  block_.qid.resize(qid_ptr.back());
+
+  // Detect 1-based indexing from the data, same as the dmlc LIBSVM parser.
+  auto one_based = param_.format == "libsvm" &&
+                   (param_.indexing_mode > 0 ||
+                    (param_.indexing_mode < 0 && nnz != 0 && stat.min_index > 0));
+  if (one_based) {
+    CHECK(nnz == 0 || stat.min_index > 0)
+        << "Found feature index 0 with `indexing_mode` set to 1-based.";
+    stat.n_features = nnz == 0 ? 0 : stat.n_features - 1;
+  }
+  std::uint32_t shift = one_based ? 1 : 0;
+
+  common::ParallelFor(n_chunks, n_threads_, [&](auto i) {
+    auto const& chunk = chunks[i];
+    auto row_beg = row_ptr[i];
+    for (std::size_t r = 1; r < chunk.offset.size(); ++r) {
+      block_.offset[row_beg + r] = chunk.offset[r] + nnz_ptr[i];
+    }
+    std::transform(chunk.index.cbegin(), chunk.index.cend(), block_.index.begin() + nnz_ptr[i],
+                   [shift](std::uint32_t idx) { return idx - shift; });
+    std::copy(chunk.value.cbegin(), chunk.value.cend(), block_.value.begin() + nnz_ptr[i]);
+    std::copy(chunk.label.cbegin(), chunk.label.cend(), block_.label.begin() + row_beg);
+    std::copy(chunk.weight.cbegin(), chunk.weight.cend(), block_.weight.begin() + weight_ptr[i]);
+    std::copy(chunk.qid.cbegin(), chunk.qid.cend(), block_.qid.begin() + qid_ptr[i]);
+  });
+  block_.n_features = stat.n_features;
+
+  CheckMetaSize(block_.label, n_rows, "label");
+  CheckMetaSize(block_.weight, n_rows, "weight");
+  CheckMetaSize(block_.qid, n_rows, "qid");
+  return true;
+}
+}  // namespace xgboost::data
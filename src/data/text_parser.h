@@ -0,0 +1,84 @@
+/**
+ * Copyright 2023 by XGBoost Contributors
+ *
+ * \file text_parser.h
+ * \brief Multi-threaded parser for local CSV and LIBSVM files.  The file is memory mapped
+ *        and split into line aligned chunks that are parsed in parallel, the output is a
+ *        CSR block that can be consumed by the CSR array adapter without further copies.
+ */
+#ifndef XGBOOST_DATA_TEXT_PARSER_H_
+#define XGBOOST_DATA_TEXT_PARSER_H_
+
+#include <cstddef>  // for size_t
+#include <cstdint>  // for int32_t, uint32_t, uint64_t
+#include <limits>   // for numeric_limits
+#include <memory>   // for unique_ptr
+#include <string>   // for string
+#include <vector>   // for vector
+
+#include "../common/io.h"  // for MmapFile
+#include "xgboost/base.h"  // for bst_feature_t
+
+namespace xgboost::data {
+/**
+ * \brief Rows parsed from a text file in CSR format.  Meta info vectors are empty when
+ *        the field is not present in the input.
+ */
+struct TextBlock {
+  std::vector<std::size_t> offset{0};
+  std::vector<std::uint32_t> index;
+  std::vector<float> value;
+  std::vector<float> label;
+  std::vector<float> weight;
+  std::vector<std::uint64_t> qid;
+  bst_feature_t n_features{0};
+
+  [[nodiscard]] std::size_t Size() const { return offset.size() - 1; }
+  void Clear();
+};
+
+/**
+ * \brief Parameters encoded in the input uri, same as the ones accepted by dmlc parsers.
+ */
+struct TextParserParam {
+  std::string format{"libsvm"};
+  // CSV
+  std::int32_t label_column{-1};
+  std::int32_t weight_column{-1};
+  char delimiter{','};
+  // LIBSVM, >0 for 1-based, 0 for 0-based and <0 for detecting from data.
+  std::int32_t indexing_mode{0};
+};
+
+class TextParser {
+  TextParserParam param_;
+  std::unique_ptr<common::MmapFile> file_;
+  std::int32_t n_threads_;
+  std::size_t block_bytes_;
+  std::size_t cursor_{0};
+  TextBlock block_;
+
+ public:
+  /**
+   * \brief Decode the uri into a local path and parser parameters.
+   *
+   * \return false if the native parser can not handle the input, in which case the dmlc
+   *         parser should be used instead.  Remote files, partitioned loading and unknown
+   *         parameters are left to dmlc.
+   */
+  static bool ParseUri(std::string const& uri, std::string const& type, std::uint32_t n_parts,
+                       std::string* path, TextParserParam* param);
+
+  TextParser(std::string const& path, TextParserParam param, std::int32_t n_threads,
+             std::size_t block_bytes = std::numeric_limits<std::size_t>::max());
+
+  void BeforeFirst() { cursor_ = 0; }
+  /**
+   * \brief Parse the next block of roughly `block_bytes` bytes, returns false at the end of
+   *        the file.
+   */
+  bool Next();
+  [[nodiscard]] TextBlock const& Value() const { return block_; }
+};
+}  // namespace xgboost::data
+#endif  // XGBOOST_DATA_TEXT_PARSER_H_
@@ -24,6 +24,7 @@
 #include <limits>                         // for numeric_limits
 #include <memory>                         // for allocator, unique_ptr, shared_ptr, operator==
 #include <mutex>                          // for mutex, lock_guard
+#include <numeric>                        // for iota
 #include <set>                            // for set
 #include <sstream>                        // for operator<<, basic_ostream, basic_ostream::opera...
 #include <stack>                          // for stack
@@ -1327,6 +1328,7 @@ class LearnerImpl : public LearnerIO {
     this->ValidateDMatrix(train.get(), true);
 
     auto& predt = prediction_container_.Cache(train, ctx_.gpu_id);
+    this->AlignPredictionCache(train.get(), &predt);
     gbm_->DoBoost(train.get(), in_gpair, &predt, obj_.get());
     monitor_.Stop("BoostOneIter");
   }
@@ -1463,9 +1465,55 @@ class LearnerImpl : public LearnerIO {
     CHECK(gbm_ != nullptr) << "Predict must happen after Load or configuration";
     this->CheckModelInitialized();
     this->ValidateDMatrix(data, false);
+    this->AlignPredictionCache(data, out_preds);
     gbm_->PredictBatch(data, out_preds, training, layer_begin, layer_end);
   }
 
+  /**
+   * \brief Align the prediction cache with a DMatrix that has rows appended or dropped
+   *        since the cache was last updated.  Predictions of the remaining rows are kept
+   *        and only the new rows are predicted with the cached number of layers.
+   */
+  void AlignPredictionCache(DMatrix* data, PredictionCacheEntry* predt) const {
+    auto n_dropped = data->NumDroppedRows();
+    auto n_rows = data->Info().num_row_;
+    auto n_outputs = static_cast<std::size_t>(learner_model_param_.OutputLength());
+    if (predt->predictions.Size() == 0 || n_outputs == 0) {
+      predt->n_dropped_rows = n_dropped;
+      return;
+    }
+    auto n_cached = predt->predictions.Size() / n_outputs;
+    if (n_dropped == predt->n_dropped_rows && n_cached == n_rows) {
+      return;
+    }
+
+    CHECK_GE(n_dropped, predt->n_dropped_rows);
+    auto n_retired = n_dropped - predt->n_dropped_rows;
+    predt->n_dropped_rows = n_dropped;
+    if (predt->version == 0 || n_retired > n_cached || n_cached - n_retired > n_rows) {
+      // Nothing can be reused.
+      predt->version = 0;
+      predt->predictions.Resize(0);
+      return;
+    }
+
+    auto& h_predt = predt->predictions.HostVector();
+    h_predt.erase(h_predt.begin(), h_predt.begin() + n_retired * n_outputs);
+    auto n_kept = n_cached - n_retired;
+    if (n_kept == n_rows) {
+      return;
+    }
+    CHECK_LE(n_rows, static_cast<bst_row_t>(std::numeric_limits<std::int32_t>::max()));
+    std::vector<std::int32_t> ridxs(n_rows - n_kept);
+    std::iota(ridxs.begin(), ridxs.end(), static_cast<std::int32_t>(n_kept));
+    std::shared_ptr<DMatrix> p_new{data->Slice(ridxs)};
+    PredictionCacheEntry new_predt;
+    gbm_->PredictBatch(p_new.get(), &new_predt, false, 0, predt->version);
+    auto const& h_new_predt = new_predt.predictions.ConstHostVector();
+    CHECK_EQ(h_new_predt.size(), ridxs.size() * n_outputs);
+    h_predt.insert(h_predt.end(), h_new_predt.cbegin(), h_new_predt.cend());
+  }
+
   void ValidateDMatrix(DMatrix* p_fmat, bool is_training) const {
     MetaInfo const& info = p_fmat->Info();
     info.Validate(ctx_.gpu_id);
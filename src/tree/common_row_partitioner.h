@@ -6,12 +6,18 @@
 #ifndef XGBOOST_TREE_COMMON_ROW_PARTITIONER_H_
 #define XGBOOST_TREE_COMMON_ROW_PARTITIONER_H_
 
-#include <limits>  // std::numeric_limits
+#include <algorithm>   // std::min
+#include <cstdint>     // std::uint8_t
+#include <functional>  // std::less,std::greater_equal
+#include <limits>      // std::numeric_limits
+#include <numeric>     // std::partial_sum
 #include <vector>
 
 #include "../collective/communicator-inl.h"
+#include "../common/common.h"   // DivRoundUp
 #include "../common/numeric.h"  // Iota
 #include "../common/partition_builder.h"
+#include "../common/threading_utils.h"  // ParallelFor
 #include "hist/expand_entry.h"  // CPUExpandEntry
 #include "xgboost/context.h"    // Context
 
@@ -83,7 +89,7 @@ class CommonRowPartitioner {
   CommonRowPartitioner() = default;
   CommonRowPartitioner(Context const* ctx, bst_row_t num_row, bst_row_t _base_rowid,
                        bool is_col_split)
-      : base_rowid{_base_rowid}, is_col_split_{is_col_split} {
+      : base_rowid{_base_rowid}, is_col_split_{is_col_split}, n_rows_{num_row} {
     row_set_collection_.Clear();
     std::vector<size_t>& row_indices = *row_set_collection_.Data();
     row_indices.resize(num_row);
@@ -97,6 +103,52 @@ class CommonRowPartitioner {
     }
   }
 
+  /**
+   * @brief Construct the partitioner with only rows selected by gradient sampling. Rows
+   *        with empty gradient pairs don't contribute to the histogram, hence they are
+   *        excluded from the partitions until `FinalisePosition` is called.
+   *
+   * @param gpair Gradient pairs of all rows in the page, indexed by `row - base_rowid`.
+   */
+  CommonRowPartitioner(Context const* ctx, bst_row_t num_row, bst_row_t _base_rowid,
+                       common::Span<GradientPair const> gpair)
+      : base_rowid{_base_rowid}, is_col_split_{false}, n_rows_{num_row} {
+    CHECK_EQ(gpair.size(), num_row);
+    row_set_collection_.Clear();
+    std::vector<size_t>& row_indices = *row_set_collection_.Data();
+
+    auto is_sampled = [&](std::size_t i) {
+      return gpair[i].GetGrad() != 0.0f || gpair[i].GetHess() != 0.0f;
+    };
+    // Compact the sampled rows in two passes, first count the rows in each block and then
+    // write them to their offsets.
+    auto n_threads = ctx->Threads();
+    std::size_t const block_size = common::DivRoundUp(num_row, n_threads);
+    std::vector<std::size_t> block_offsets(n_threads + 1, 0);
+    common::ParallelFor(n_threads, n_threads, [&](auto tidx) {
+      std::size_t ibegin = std::min(tidx * block_size, static_cast<std::size_t>(num_row));
+      std::size_t iend = std::min(ibegin + block_size, static_cast<std::size_t>(num_row));
+      std::size_t n_sampled = 0;
+      for (std::size_t i = ibegin; i < iend; ++i) {
+        n_sampled += is_sampled(i);
+      }
+      block_offsets[tidx + 1] = n_sampled;
+    });
+    std::partial_sum(block_offsets.cbegin(), block_offsets.cend(), block_offsets.begin());
+    row_indices.resize(block_offsets.back());
+    common::ParallelFor(n_threads, n_threads, [&](auto tidx) {
+      std::size_t ibegin = std::min(tidx * block_size, static_cast<std::size_t>(num_row));
+      std::size_t iend = std::min(ibegin + block_size, static_cast<std::size_t>(num_row));
+      auto out = row_indices.data() + block_offsets[tidx];
+      for (std::size_t i = ibegin; i < iend; ++i) {
+        if (is_sampled(i)) {
+          *out++ = i + base_rowid;
+        }
+      }
+    });
+    row_set_collection_.Init();
+  }
+
   void FindSplitConditions(const std::vector<CPUExpandEntry>& nodes, const RegTree& tree,
                            const GHistIndexMatrix& gmat, std::vector<int32_t>* split_conditions) {
     auto const& ptrs = gmat.cut.Ptrs();
@@ -219,38 +271,129 @@ class CommonRowPartitioner {
     CHECK_EQ(base_rowid, gmat.base_rowid);
 
     // 2.3 Split elements of row_set_collection_ to left and right child-nodes for each node
-    // Store results in intermediate buffers from partition_builder_
     if (is_col_split_) {
+      // Store results in intermediate buffers from partition_builder_
       column_split_helper_.Partition(space, ctx->Threads(), gmat, column_matrix, nodes, p_tree);
+
+      // 3. Compute offsets to copy blocks of row-indexes
+      // from partition_builder_ to row_set_collection_
+      partition_builder_.CalculateRowOffsets();
+
+      // 4. Copy elements from partition_builder_ to row_set_collection_ back
+      // with updated row-indexes for each tree-node
+      common::ParallelFor2d(space, ctx->Threads(), [&](size_t node_in_set, common::Range1d r) {
+        const int32_t nid = nodes[node_in_set].nid;
+        partition_builder_.MergeToArray(node_in_set, r.begin(),
+                                        const_cast<size_t*>(row_set_collection_[nid].begin));
+      });
     } else {
+      // Record the decisions for each row, indexed by the position of the row in its buffer.
+      this->InitArena();
       common::ParallelFor2d(space, ctx->Threads(), [&](size_t node_in_set, common::Range1d r) {
-        size_t begin = r.begin();
         const int32_t nid = nodes[node_in_set].nid;
-        const size_t task_id = partition_builder_.GetTaskIdx(node_in_set, begin);
-        partition_builder_.AllocateForTask(task_id);
+        auto const& elem = row_set_collection_[nid];
         bst_bin_t split_cond = column_matrix.IsInitialized() ? split_conditions[node_in_set] : 0;
-        partition_builder_.template Partition<BinIdxType, any_missing, any_cat>(
-            node_in_set, nodes, r, split_cond, gmat, column_matrix, *p_tree,
-            row_set_collection_[nid].begin);
+        partition_builder_.template PartitionDecision<BinIdxType, any_missing, any_cat>(
+            node_in_set, nodes, r, split_cond, gmat, column_matrix, *p_tree, elem.begin,
+            this->Decisions(elem, r));
       });
-    }
 
-    // 3. Compute offsets to copy blocks of row-indexes
-    // from partition_builder_ to row_set_collection_
-    partition_builder_.CalculateRowOffsets();
+      // 3. Compute offsets of the child nodes for each block of row-indexes
+      partition_builder_.CalculateRowOffsets();
 
-    // 4. Copy elements from partition_builder_ to row_set_collection_ back
-    // with updated row-indexes for each tree-node
-    common::ParallelFor2d(space, ctx->Threads(), [&](size_t node_in_set, common::Range1d r) {
-      const int32_t nid = nodes[node_in_set].nid;
-      partition_builder_.MergeToArray(node_in_set, r.begin(),
-                                      const_cast<size_t*>(row_set_collection_[nid].begin));
-    });
+      // 4. Scatter the row-indexes into the other buffer at the same position, which
+      // becomes the storage of the child nodes. Each row is written only once.
+      common::ParallelFor2d(space, ctx->Threads(), [&](size_t node_in_set, common::Range1d r) {
+        const int32_t nid = nodes[node_in_set].nid;
+        auto const& elem = row_set_collection_[nid];
+        partition_builder_.ScatterToArray(node_in_set, r, elem.begin, this->Decisions(elem, r),
+                                          this->SwapBuffer(elem));
+      });
+      for (auto const& node : nodes) {
+        auto& elem = row_set_collection_[node.nid];
+        if (elem.begin != nullptr && elem.Size() != 0) {
+          auto n_rows = elem.Size();
+          auto const* p_swap = this->SwapBuffer(elem);
+          elem = common::RowSetCollection::Elem{p_swap, p_swap + n_rows, node.nid};
+        }
+      }
+    }
 
     // 5. Add info about splits into row_set_collection_
     AddSplitsToRowSet(nodes, p_tree);
   }
 
+  /**
+   * @brief Put rows excluded by gradient sampling back into the leaf they belong to, so
+   *        that the leaf partition and prediction cache cover all rows in the page.
+   */
+  void FinalisePosition(Context const* ctx, GHistIndexMatrix const& gmat, RegTree const& tree) {
+    auto& row_indices = *row_set_collection_.Data();
+    if (row_indices.size() == n_rows_) {
+      return;
+    }
+    CHECK_EQ(base_rowid, gmat.base_rowid);
+    auto n_nodes = static_cast<bst_node_t>(tree.GetNodes().size());
+    std::vector<bst_node_t> position(n_rows_, -1);
+    common::ParallelFor(this->Size(), ctx->Threads(), [&](auto nidx) {
+      auto const& node = row_set_collection_[nidx];
+      if (node.node_id < 0) {
+        return;
+      }
+      for (auto it = node.begin; it != node.end; ++it) {
+        position[*it - base_rowid] = node.node_id;
+      }
+    });
+
+    auto const& cut_values = gmat.cut.Values();
+    common::ParallelFor(n_rows_, ctx->Threads(), [&](auto i) {
+      if (position[i] >= 0) {
+        return;
+      }
+      auto ridx = i + base_rowid;
+      bst_node_t nidx = RegTree::kRoot;
+      while (!tree[nidx].IsLeaf()) {
+        auto fid = tree[nidx].SplitIndex();
+        auto gidx = gmat.GetGindex(ridx, fid);
+        bool go_left = tree[nidx].DefaultLeft();
+        if (gidx > -1) {
+          if (tree.GetSplitTypes()[nidx] == FeatureType::kCategorical) {
+            go_left = common::Decision(tree.NodeCats(nidx), cut_values[gidx]);
+          } else {
+            go_left = cut_values[gidx] <= tree[nidx].SplitCond();
+          }
+        }
+        nidx = go_left ? tree[nidx].LeftChild() : tree[nidx].RightChild();
+      }
+      position[i] = nidx;
+    });
+
+    // Group the rows by leaf with a counting sort, the partitions are rebuilt afterward.
+    std::vector<std::size_t> node_ptr(n_nodes + 1, 0);
+    for (auto nidx : position) {
+      node_ptr[nidx + 1]++;
+    }
+    std::partial_sum(node_ptr.cbegin(), node_ptr.cend(), node_ptr.begin());
+    std::vector<std::size_t> sorted(n_rows_);
+    std::vector<std::size_t> cursor(node_ptr.cbegin(), node_ptr.cend() - 1);
+    for (std::size_t i = 0; i < position.size(); ++i) {
+      sorted[cursor[position[i]]++] = i + base_rowid;
+    }
+    row_indices = std::move(sorted);
+
+    auto const* p_begin = row_indices.data();
+    CHECK_EQ(this->Size(), static_cast<std::size_t>(n_nodes));
+    for (bst_node_t nidx = 0; nidx < n_nodes; ++nidx) {
+      auto& node = row_set_collection_[nidx];
+      if (!tree[nidx].IsLeaf() || tree[nidx].IsDeleted()) {
+        node = common::RowSetCollection::Elem{nullptr, nullptr, -1};
+        continue;
+      }
+      node = common::RowSetCollection::Elem{p_begin + node_ptr[nidx], p_begin + node_ptr[nidx + 1],
+                                            nidx};
+    }
+  }
+
   auto const& Partitions() const { return row_set_collection_; }
 
   size_t Size() const {
@@ -275,10 +418,48 @@ class CommonRowPartitioner {
   }
 
  private:
+  /**
+   * @brief Rows of a node are stored either in the row set collection or in the arena, at
+   *        the same offset. Partitioning a node writes its children into the other one,
+   *        so the arena is allocated once per tree and reused across all levels.
+   */
+  void InitArena() {
+    auto n_rows = row_set_collection_.Data()->size();
+    if (arena_.size() != n_rows) {
+      arena_.resize(n_rows);
+      decisions_.resize(n_rows);
+    }
+  }
+
+  bool InArena(common::RowSetCollection::Elem const& elem) const {
+    return !arena_.empty() && std::greater_equal<>{}(elem.begin, arena_.data()) &&
+           std::less<>{}(elem.begin, arena_.data() + arena_.size());
+  }
+
+  std::size_t BufferOffset(common::RowSetCollection::Elem const& elem) const {
+    return InArena(elem) ? elem.begin - arena_.data()
+                         : elem.begin - row_set_collection_.Data()->data();
+  }
+
+  std::size_t* SwapBuffer(common::RowSetCollection::Elem const& elem) {
+    auto offset = this->BufferOffset(elem);
+    return InArena(elem) ? row_set_collection_.Data()->data() + offset : arena_.data() + offset;
+  }
+
+  common::Span<std::uint8_t> Decisions(common::RowSetCollection::Elem const& elem,
+                                       common::Range1d r) {
+    return {decisions_.data() + this->BufferOffset(elem) + r.begin(), r.end() - r.begin()};
+  }
+
   common::PartitionBuilder<kPartitionBlockSize> partition_builder_;
   common::RowSetCollection row_set_collection_;
   bool is_col_split_;
   ColumnSplitHelper column_split_helper_;
+  // number of rows in the page, including the ones excluded by sampling.
+  bst_row_t n_rows_{0};
+  // swap buffer for row indexes and the decision for each row
+  std::vector<std::size_t> arena_;
+  std::vector<std::uint8_t> decisions_;
 };
 
 }  // namespace tree
@@ -4,8 +4,15 @@
 #ifndef XGBOOST_TREE_DRIVER_H_
 #define XGBOOST_TREE_DRIVER_H_
 #include <xgboost/span.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <queue>
+#include <utility>
 #include <vector>
+
 #include "./param.h"
 
 namespace xgboost {
@@ -25,6 +32,20 @@ inline bool LossGuide(const ExpandEntryT& lhs, const ExpandEntryT& rhs) {
   }
 }
 
+/**
+ * \brief Counters for the node batches produced by the driver.
+ */
+struct DriverBatchStats {
+  /*! \brief number of non-empty batches returned by `Pop`. */
+  std::size_t n_batches{0};
+  /*! \brief total number of nodes returned by `Pop`. */
+  std::size_t n_nodes{0};
+  /*! \brief size of the largest batch. */
+  std::size_t max_batch_size{0};
+  /*! \brief number of batches extended past the node limit since the nodes are small. */
+  std::size_t n_grouped{0};
+};
+
 // Drives execution of tree building on device
 template <typename ExpandEntryT>
 class Driver {
@@ -33,11 +54,33 @@ class Driver {
                           std::function<bool(ExpandEntryT, ExpandEntryT)>>;
 
  public:
+  using RowEstimator = std::function<std::size_t(ExpandEntryT const&)>;
+  // Minimum number of rows per thread for a batch to be considered as having enough work.
+  static constexpr std::size_t kMinRowsPerThread = 1024;
+  // Limit for growing a batch of small nodes, as a multiple of the maximum batch size.
+  static constexpr std::size_t kMaxGroupFactor = 4;
+
   explicit Driver(TrainParam param, std::size_t max_node_batch_size = 256)
       : param_(param),
         max_node_batch_size_(max_node_batch_size),
         queue_(param.grow_policy == TrainParam::kDepthWise ? DepthWise<ExpandEntryT>
                                                            : LossGuide<ExpandEntryT>) {}
+  /**
+   * \brief Enable adaptive node batching.
+   *
+   *   With an estimate of the number of rows in each node, batches of small nodes can grow
+   *   past `max_node_batch_size` until there's enough work for all threads. For the loss
+   *   guided policy without a leaf limit, the expansion order doesn't change the resulting
+   *   tree structure, so nodes from different levels are returned in the same batch.
+   *
+   * \param estimator Returns the (estimated) number of rows in a node.
+   * \param n_threads Number of threads used for building the tree.
+   */
+  void SetRowEstimator(RowEstimator estimator, std::int32_t n_threads) {
+    row_estimator_ = std::move(estimator);
+    min_batch_rows_ = static_cast<std::size_t>(std::max(n_threads, 1)) * kMinRowsPerThread;
+  }
+  [[nodiscard]] DriverBatchStats const& BatchStats() const { return stats_; }
   template <typename EntryIterT>
   void Push(EntryIterT begin, EntryIterT end) {
     for (auto it = begin; it != end; ++it) {
@@ -69,6 +112,11 @@ class Driver {
   // parallel or asynchronously
   std::vector<ExpandEntryT> Pop() {
     if (queue_.empty()) return {};
+    if (row_estimator_) {
+      auto result = this->PopAdaptive();
+      this->Record(result);
+      return result;
+    }
     // Return a single entry for loss guided mode
     if (param_.grow_policy == TrainParam::kLossGuide) {
       ExpandEntryT e = queue_.top();
@@ -76,6 +124,7 @@ class Driver {
 
       if (e.IsValid(param_, num_leaves_)) {
         num_leaves_++;
+        this->Record({e});
         return {e};
       } else {
         return {};
@@ -96,14 +145,68 @@ class Driver {
         e = queue_.top();
       }
     }
+    this->Record(result);
     return result;
   }
 
  private:
+  std::vector<ExpandEntryT> PopAdaptive() {
+    // With a leaf limit, the next node for the loss guided policy might be a child of the
+    // current one.
+    bool single = param_.grow_policy == TrainParam::kLossGuide && param_.max_leaves > 0;
+    bool same_level = param_.grow_policy == TrainParam::kDepthWise;
+    std::size_t const max_grouped = max_node_batch_size_ * kMaxGroupFactor;
+
+    std::vector<ExpandEntryT> result;
+    std::size_t n_rows = 0;
+    auto level = queue_.top().depth;
+    while (!queue_.empty()) {
+      ExpandEntryT const& e = queue_.top();
+      if (same_level && e.depth != level) {
+        break;
+      }
+      if (!result.empty()) {
+        if (single) {
+          break;
+        }
+        auto enough_work = n_rows >= min_batch_rows_;
+        if (result.size() >= max_grouped ||
+            (result.size() >= max_node_batch_size_ && enough_work)) {
+          break;
+        }
+      }
+      ExpandEntryT entry = e;
+      queue_.pop();
+      if (entry.IsValid(param_, num_leaves_)) {
+        num_leaves_++;
+        n_rows += row_estimator_(entry);
+        result.emplace_back(std::move(entry));
+      } else if (single) {
+        break;
+      }
+    }
+    if (result.size() > max_node_batch_size_) {
+      stats_.n_grouped++;
+    }
+    return result;
+  }
+
+  void Record(std::vector<ExpandEntryT> const& batch) {
+    if (batch.empty()) {
+      return;
+    }
+    stats_.n_batches++;
+    stats_.n_nodes += batch.size();
+    stats_.max_batch_size = std::max(stats_.max_batch_size, batch.size());
+  }
+
   TrainParam param_;
   bst_node_t num_leaves_ = 1;
   std::size_t max_node_batch_size_;
   ExpandQueue queue_;
+  RowEstimator row_estimator_;
+  std::size_t min_batch_rows_{0};
+  DriverBatchStats stats_;
 };
 }  // namespace tree
 }  // namespace xgboost
@@ -4,14 +4,18 @@
 #ifndef XGBOOST_TREE_HIST_EVALUATE_SPLITS_H_
 #define XGBOOST_TREE_HIST_EVALUATE_SPLITS_H_
 
-#include <algorithm>                   // for copy
+#include <algorithm>                   // for copy, copy_n
 #include <cstddef>                     // for size_t
+#include <cstdint>                     // for uint32_t, int32_t
+#include <iterator>                    // for back_inserter, distance
 #include <limits>                      // for numeric_limits
 #include <memory>                      // for shared_ptr
 #include <numeric>                     // for accumulate
-#include <utility>                     // for move
+#include <utility>                     // for move, pair
 #include <vector>                      // for vector
 
+#include "../../collective/communicator-inl.h"  // for Allgather, GetRank, GetWorldSize
+
 #include "../../common/categorical.h"  // for CatBitField
 #include "../../common/hist_util.h"    // for GHistRow, HistogramCuts
 #include "../../common/linalg_op.h"    // for cbegin, cend, begin
@@ -20,6 +24,7 @@
 #include "../param.h"                  // for TrainParam
 #include "../split_evaluator.h"        // for TreeEvaluator
 #include "expand_entry.h"              // for MultiExpandEntry
+#include "feature_pruner.h"            // for FeaturePruner
 #include "xgboost/base.h"              // for bst_node_t, bst_target_t, bst_feature_t
 #include "xgboost/context.h"           // for COntext
 #include "xgboost/linalg.h"            // for Constants, Vector
@@ -41,8 +46,13 @@ class HistEvaluator {
   std::shared_ptr<common::ColumnSampler> column_sampler_;
   TreeEvaluator tree_evaluator_;
   bool is_col_split_{false};
+  // Whether each worker evaluates only a shard of features in distributed row-split
+  // training, the best splits are gathered afterward.
+  bool shard_features_{false};
   FeatureInteractionConstraintHost interaction_constraints_;
   std::vector<NodeEntry> snode_;
+  // Skips unpromising features in the subtree of each node, null if disabled.
+  std::shared_ptr<FeaturePruner> pruner_;
 
   // if sum of statistics for non-missing values in the node
   // is equal to sum of statistics for all values:
@@ -211,6 +221,108 @@ class HistEvaluator {
     p_best->Update(best);
   }
 
+  /**
+   * \brief Whether the split gain can be computed by the blocked enumeration. The gain
+   *        has a closed form only without monotone constraints and `max_delta_step`, see
+   *        `SplitEvaluator::CalcGainGivenWeight`.
+   */
+  [[nodiscard]] bool CanEnumerateBlocked(
+      TreeEvaluator::SplitEvaluator<TrainParam> const &evaluator) const {
+    return !evaluator.has_constraint && param_->max_delta_step == 0.0f;
+  }
+
+  /**
+   * \brief Same as `SplitEvaluator::CalcGainGivenWeight` for the unconstrained case, with
+   *        branches replaced by selects so that the loop over a block can be vectorized.
+   */
+  static float BlockedGain(double grad, double hess, float alpha, float lambda) {
+    double g = grad > alpha ? grad - alpha : (grad < -alpha ? grad + alpha : 0.0);
+    auto a = static_cast<float>(g * g);
+    auto b = static_cast<float>(hess + lambda);
+    return hess <= 0 ? 0.0f : a / b;
+  }
+
+  /**
+   * \brief Blocked version of `EnumerateSplit` for numerical features without
+   *        constraint. Bins are processed in blocks of `kBlockBins`: the prefix sums are
+   *        accumulated in bin order (keeping the floating point results identical to the
+   *        scalar code), then the gains of the whole block are computed in a branch-free
+   *        loop, and finally the candidates are offered to the split entry in bin order
+   *        so that tie-breaking is unchanged.
+   */
+  template <int d_step>
+  GradStats EnumerateSplitBlocked(common::HistogramCuts const &cut, const common::GHistRow &hist,
+                                  bst_feature_t fidx, bst_node_t nidx, SplitEntry *p_best) const {
+    static_assert(d_step == +1 || d_step == -1, "Invalid step.");
+    constexpr bst_bin_t kBlockBins = 8;
+
+    auto const &cut_ptr = cut.Ptrs();
+    auto const &cut_val = cut.Values();
+    auto const &parent = snode_[nidx];
+    auto const alpha = param_->reg_alpha;
+    auto const lambda = param_->reg_lambda;
+    auto const min_child_weight = param_->min_child_weight;
+
+    GradStats left_sum;
+    GradStats right_sum;
+    SplitEntry best;
+
+    CHECK_LE(cut_ptr[fidx], static_cast<uint32_t>(std::numeric_limits<bst_bin_t>::max()));
+    CHECK_LE(cut_ptr[fidx + 1], static_cast<uint32_t>(std::numeric_limits<bst_bin_t>::max()));
+    auto const imin = static_cast<bst_bin_t>(cut_ptr[fidx]);
+    bst_bin_t ibegin, iend;
+    if (d_step > 0) {
+      ibegin = static_cast<bst_bin_t>(cut_ptr[fidx]);
+      iend = static_cast<bst_bin_t>(cut_ptr.at(fidx + 1));
+    } else {
+      ibegin = static_cast<bst_bin_t>(cut_ptr[fidx + 1]) - 1;
+      iend = static_cast<bst_bin_t>(cut_ptr[fidx]) - 1;
+    }
+
+    // Statistics of the scanned side (left for forward, right for backward) and the
+    // opposite side, for each bin in the block. Unused lanes stay empty.
+    double s_grad[kBlockBins], s_hess[kBlockBins], o_grad[kBlockBins], o_hess[kBlockBins];
+    float gain[kBlockBins];
+
+    for (bst_bin_t i = ibegin; i != iend;) {
+      bst_bin_t n = std::min(kBlockBins, (iend - i) * d_step);
+      for (bst_bin_t k = 0; k < kBlockBins; ++k) {
+        if (k < n) {
+          auto const &g = hist[i + k * d_step];
+          left_sum.Add(g.GetGrad(), g.GetHess());
+          right_sum.SetSubstract(parent.stats, left_sum);
+          s_grad[k] = left_sum.GetGrad();
+          s_hess[k] = left_sum.GetHess();
+          o_grad[k] = right_sum.GetGrad();
+          o_hess[k] = right_sum.GetHess();
+        } else {
+          s_grad[k] = s_hess[k] = o_grad[k] = o_hess[k] = 0.0;
+        }
+      }
+      for (bst_bin_t k = 0; k < kBlockBins; ++k) {
+        gain[k] = (BlockedGain(s_grad[k], s_hess[k], alpha, lambda) +
+                   BlockedGain(o_grad[k], o_hess[k], alpha, lambda)) -
+                  parent.root_gain;
+      }
+      for (bst_bin_t k = 0; k < n; ++k, i += d_step) {
+        if (!(s_hess[k] >= min_child_weight && o_hess[k] >= min_child_weight)) {
+          continue;
+        }
+        GradStats scanned{s_grad[k], s_hess[k]};
+        GradStats other{o_grad[k], o_hess[k]};
+        if (d_step > 0) {
+          best.Update(gain[k], fidx, cut_val[i], false, false, scanned, other);
+        } else {
+          float split_pt = i == imin ? cut.MinValues()[fidx] : cut_val[i - 1];
+          best.Update(gain[k], fidx, split_pt, true, false, other, scanned);
+        }
+      }
+    }
+
+    p_best->Update(best);
+    return left_sum;
+  }
+
   // Enumerate/Scan the split values of specific feature
   // Returns the sum of gradients corresponding to the data points that contains
   // a non-missing value for the particular feature fid.
@@ -220,6 +332,9 @@ class HistEvaluator {
                            TreeEvaluator::SplitEvaluator<TrainParam> const &evaluator,
                            SplitEntry *p_best) const {
     static_assert(d_step == +1 || d_step == -1, "Invalid step.");
+    if (this->CanEnumerateBlocked(evaluator)) {
+      return this->EnumerateSplitBlocked<d_step>(cut, hist, fidx, nidx, p_best);
+    }
 
     // aliases
     const std::vector<uint32_t> &cut_ptr = cut.Ptrs();
@@ -300,10 +415,27 @@ class HistEvaluator {
           column_sampler_->GetFeatureSet(tree.GetDepth(nidx));
     }
     CHECK(!features.empty());
+    std::vector<common::Span<bst_feature_t const>> feature_sets(entries.size());
+    // Sampled features that belong to the shard of this worker.
+    std::vector<std::vector<bst_feature_t>> shard_sets;
+    if (shard_features_) {
+      auto [fbegin, fend] = this->FeatureShard(cut);
+      shard_sets.resize(entries.size());
+      for (std::size_t i = 0; i < entries.size(); ++i) {
+        auto const &h_features = features[i]->ConstHostVector();
+        std::copy_if(h_features.cbegin(), h_features.cend(), std::back_inserter(shard_sets[i]),
+                     [&](bst_feature_t fidx) { return fidx >= fbegin && fidx < fend; });
+        feature_sets[i] = shard_sets[i];
+      }
+    } else {
+      for (std::size_t i = 0; i < entries.size(); ++i) {
+        feature_sets[i] = features[i]->ConstHostSpan();
+      }
+    }
     const size_t grain_size =
-        std::max<size_t>(1, features.front()->Size() / n_threads);
+        std::max<size_t>(1, feature_sets.front().size() / n_threads);
     common::BlockedSpace2d space(entries.size(), [&](size_t nidx_in_set) {
-      return features[nidx_in_set]->Size();
+      return feature_sets[nidx_in_set].size();
     }, grain_size);
 
     std::vector<ExpandEntry> tloc_candidates(n_threads * entries.size());
@@ -314,20 +446,43 @@ class HistEvaluator {
     }
     auto evaluator = tree_evaluator_.GetEvaluator();
     auto const& cut_ptrs = cut.Ptrs();
+    // Features used by each node and the buffer for the best gain of each feature.
+    std::vector<common::Span<std::uint8_t const>> feature_masks(entries.size());
+    std::vector<common::Span<float>> feature_gains(entries.size());
+    std::vector<float> gains_storage;
+    if (pruner_) {
+      auto n_features = cut_ptrs.size() - 1;
+      gains_storage.resize(entries.size() * n_features, FeaturePruner::kNotEvaluated);
+      for (std::size_t i = 0; i < entries.size(); ++i) {
+        feature_masks[i] = pruner_->FeatureMask(entries[i].nid);
+        feature_gains[i] = {gains_storage.data() + i * n_features, n_features};
+      }
+    }
 
     common::ParallelFor2d(space, n_threads, [&](size_t nidx_in_set, common::Range1d r) {
       auto tidx = omp_get_thread_num();
       auto entry = &tloc_candidates[n_threads * nidx_in_set + tidx];
-      auto best = &entry->split;
       auto nidx = entry->nid;
       auto histogram = hist[nidx];
-      auto features_set = features[nidx_in_set]->ConstHostSpan();
+      auto features_set = feature_sets[nidx_in_set];
+      auto feature_mask = feature_masks[nidx_in_set];
+      auto feature_gain = feature_gains[nidx_in_set];
+      // With feature pruning, each feature is evaluated separately to obtain its best gain.
+      decltype(entry->split) feature_best;
       for (auto fidx_in_set = r.begin(); fidx_in_set < r.end(); fidx_in_set++) {
         auto fidx = features_set[fidx_in_set];
         bool is_cat = common::IsCat(feature_types, fidx);
         if (!interaction_constraints_.Query(nidx, fidx)) {
           continue;
         }
+        if (!feature_mask.empty() && !feature_mask[fidx]) {
+          continue;
+        }
+        auto best = &entry->split;
+        if (pruner_) {
+          feature_best = decltype(feature_best){};
+          best = &feature_best;
+        }
         if (is_cat) {
           auto n_bins = cut_ptrs.at(fidx + 1) - cut_ptrs[fidx];
           if (common::UseOneHot(n_bins, param_->max_cat_to_onehot)) {
@@ -351,6 +506,10 @@ class HistEvaluator {
             EnumerateSplit<-1>(cut, histogram, fidx, nidx, evaluator, best);
           }
         }
+        if (pruner_) {
+          feature_gain[fidx] = feature_best.loss_chg;
+          entry->split.Update(feature_best);
+        }
       }
     });
 
@@ -362,19 +521,124 @@ class HistEvaluator {
       }
     }
 
-    if (is_col_split_) {
-      // With column-wise data split, we gather the best splits from all the workers and update the
-      // expand entries accordingly.
-      auto const world = collective::GetWorldSize();
-      auto const rank = collective::GetRank();
-      auto const num_entries = entries.size();
-      std::vector<ExpandEntry> buffer{num_entries * world};
-      std::copy_n(entries.cbegin(), num_entries, buffer.begin() + num_entries * rank);
-      collective::Allgather(buffer.data(), buffer.size() * sizeof(ExpandEntry));
-      for (auto worker = 0; worker < world; ++worker) {
-        for (std::size_t nidx_in_set = 0; nidx_in_set < entries.size(); ++nidx_in_set) {
-          entries[nidx_in_set].split.Update(buffer[worker * num_entries + nidx_in_set].split);
-        }
+    if (is_col_split_ || shard_features_) {
+      // With column-wise data split or sharded features, we gather the best splits from all
+      // the workers and update the expand entries accordingly.
+      this->AllgatherSplits(&entries);
+    }
+    if (pruner_ && shard_features_) {
+      // The histograms are synchronized, all workers must skip the same features.
+      this->AllreduceFeatureGains(feature_gains);
+    }
+    if (pruner_) {
+      for (std::size_t i = 0; i < entries.size(); ++i) {
+        pruner_->Evaluated(entries[i].nid, feature_gains[i], entries[i].split.loss_chg);
+      }
+    }
+  }
+
+  /**
+   * \brief Gather the best gain of features evaluated by other workers.  Gains of features
+   *        not evaluated are negative.
+   */
+  static void AllreduceFeatureGains(std::vector<common::Span<float>> const &feature_gains) {
+    std::vector<float> buffer;
+    for (auto const &gains : feature_gains) {
+      buffer.insert(buffer.end(), gains.cbegin(), gains.cend());
+    }
+    collective::Allreduce<collective::Operation::kMax>(buffer.data(), buffer.size());
+    auto it = buffer.cbegin();
+    for (auto const &gains : feature_gains) {
+      std::copy_n(it, gains.size(), gains.begin());
+      it += gains.size();
+    }
+  }
+
+  /**
+   * \brief Range of features evaluated by this worker.  Features are partitioned into
+   *        contiguous ranges with roughly the same number of histogram bins.
+   */
+  [[nodiscard]] std::pair<bst_feature_t, bst_feature_t> FeatureShard(
+      common::HistogramCuts const &cut) const {
+    auto const world = static_cast<std::size_t>(collective::GetWorldSize());
+    auto const rank = static_cast<std::size_t>(collective::GetRank());
+    auto const &ptrs = cut.Ptrs();
+    auto n_features = static_cast<bst_feature_t>(ptrs.size() - 1);
+    auto first_feature = [&](std::size_t r) {
+      if (r == world) {
+        return n_features;
+      }
+      auto bin = static_cast<std::size_t>(ptrs.back()) * r / world;
+      auto it = std::lower_bound(ptrs.cbegin(), ptrs.cend() - 1, bin);
+      return static_cast<bst_feature_t>(std::distance(ptrs.cbegin(), it));
+    };
+    return {first_feature(rank), first_feature(rank + 1)};
+  }
+
+  /**
+   * \brief Gather the best split of each node from all workers.  The categories of the
+   *        splits are gathered separately since the split entry is not trivially copyable.
+   */
+  void AllgatherSplits(std::vector<ExpandEntry> *p_entries) const {
+    using GradientT = decltype(ExpandEntry{}.split.left_sum);
+    struct SplitSummary {
+      GradientT left_sum;
+      GradientT right_sum;
+      bst_float loss_chg;
+      bst_feature_t sindex;
+      bst_float split_value;
+      std::uint32_t n_cats;
+      std::int32_t is_cat;
+    };
+
+    auto &entries = *p_entries;
+    auto const world = collective::GetWorldSize();
+    auto const rank = collective::GetRank();
+    auto const n_entries = entries.size();
+    std::vector<SplitSummary> summary(n_entries * world, SplitSummary{});
+    for (std::size_t i = 0; i < n_entries; ++i) {
+      auto const &split = entries[i].split;
+      auto &out = summary[rank * n_entries + i];
+      out.left_sum = split.left_sum;
+      out.right_sum = split.right_sum;
+      out.loss_chg = split.loss_chg;
+      out.sindex = split.sindex;
+      out.split_value = split.split_value;
+      out.n_cats = static_cast<std::uint32_t>(split.cat_bits.size());
+      out.is_cat = split.is_cat;
+    }
+    collective::Allgather(summary.data(), summary.size() * sizeof(SplitSummary));
+
+    std::size_t max_cats = 0;
+    for (auto const &v : summary) {
+      max_cats = std::max(max_cats, static_cast<std::size_t>(v.n_cats));
+    }
+    std::vector<std::uint32_t> cats;
+    if (max_cats != 0) {
+      // All workers see the same summary, so either all or none of them run this.
+      cats.resize(summary.size() * max_cats, 0);
+      for (std::size_t i = 0; i < n_entries; ++i) {
+        auto const &cat_bits = entries[i].split.cat_bits;
+        std::copy(cat_bits.cbegin(), cat_bits.cend(),
+                  cats.begin() + (rank * n_entries + i) * max_cats);
+      }
+      collective::Allgather(cats.data(), cats.size() * sizeof(std::uint32_t));
+    }
+
+    for (std::int32_t worker = 0; worker < world; ++worker) {
+      for (std::size_t i = 0; i < n_entries; ++i) {
+        auto k = worker * n_entries + i;
+        auto const &v = summary[k];
+        decltype(ExpandEntry{}.split) split;
+        split.left_sum = v.left_sum;
+        split.right_sum = v.right_sum;
+        split.loss_chg = v.loss_chg;
+        split.sindex = v.sindex;
+        split.split_value = v.split_value;
+        split.is_cat = v.is_cat != 0;
+        auto cat_begin = cats.cbegin() + k * max_cats;
+        split.cat_bits.assign(cat_begin, cat_begin + v.n_cats);
+        entries[i].split.Update(split);
       }
     }
   }
@@ -424,13 +688,24 @@ class HistEvaluator {
     interaction_constraints_.Split(candidate.nid,
                                    tree[candidate.nid].SplitIndex(), left_child,
                                    right_child);
+    if (pruner_) {
+      pruner_->Split(candidate.nid, left_child, right_child);
+    }
   }
 
   auto Evaluator() const { return tree_evaluator_.GetEvaluator(); }
   auto const& Stats() const { return snode_; }
+  /**
+   * \brief Features skipped for each node, shared with the histogram builder.  Null if
+   *        feature pruning is disabled.
+   */
+  [[nodiscard]] std::shared_ptr<FeaturePruner const> Pruner() const { return pruner_; }
 
   float InitRoot(GradStats const &root_sum) {
     snode_.resize(1);
+    if (pruner_) {
+      pruner_->Reset();
+    }
     auto root_evaluator = tree_evaluator_.GetEvaluator();
 
     snode_[0].stats = GradStats{root_sum.GetGrad(), root_sum.GetHess()};
@@ -449,11 +724,17 @@ class HistEvaluator {
         param_{param},
         column_sampler_{std::move(sampler)},
         tree_evaluator_{*param, static_cast<bst_feature_t>(info.num_col_), Context::kCpuId},
-        is_col_split_{info.data_split_mode == DataSplitMode::kCol} {
+        is_col_split_{info.data_split_mode == DataSplitMode::kCol},
+        shard_features_{param->shard_split_evaluation && !is_col_split_ &&
+                        collective::IsDistributed()} {
     interaction_constraints_.Configure(*param, info.num_col_);
     column_sampler_->Init(ctx, info.num_col_, info.feature_weights.HostVector(),
                           param_->colsample_bynode, param_->colsample_bylevel,
                           param_->colsample_bytree);
+    if (param_->feature_gain_tolerance > 0.0f) {
+      pruner_ = std::make_shared<FeaturePruner>(param_->feature_gain_tolerance,
+                                                static_cast<bst_feature_t>(info.num_col_));
+    }
   }
 };
 
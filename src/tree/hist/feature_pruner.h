@@ -0,0 +1,107 @@
+/**
+ * Copyright 2023 by XGBoost Contributors
+ */
+#ifndef XGBOOST_TREE_HIST_FEATURE_PRUNER_H_
+#define XGBOOST_TREE_HIST_FEATURE_PRUNER_H_
+
+#include <algorithm>  // for max
+#include <cstddef>    // for size_t
+#include <cstdint>    // for uint8_t
+#include <memory>     // for shared_ptr, make_shared
+#include <utility>    // for move
+#include <vector>     // for vector
+
+#include "xgboost/base.h"  // for bst_feature_t, bst_node_t
+#include "xgboost/span.h"  // for Span
+
+namespace xgboost::tree {
+/**
+ * \brief Skip features that are unpromising in the subtree of a node.
+ *
+ *   After a node is evaluated, features with best gain lower than `tolerance` times the gain
+ *   of the best split are recorded.  When the node is split, these features are excluded
+ *   from both children and all their descendants, neither the histogram nor the split of
+ *   those features is computed.  The root always uses all features.  This is a heuristic, a
+ *   feature that is weak in the parent can still be the best one in a child.
+ */
+class FeaturePruner {
+ public:
+  // Gain of a feature that is not evaluated for a node.
+  static constexpr float kNotEvaluated = -1.0f;
+
+ private:
+  float tolerance_;
+  bst_feature_t n_features_;
+  // Features pruned by each node, indexed by node.  Released once the node is split, leaves
+  // keep only the features weaker than their best split.
+  std::vector<std::vector<bst_feature_t>> pruned_;
+  // Features used by each node, a null mask means all features are used.  The children of
+  // a node share the same mask.
+  std::vector<std::shared_ptr<std::vector<std::uint8_t> const>> masks_;
+
+ public:
+  FeaturePruner(float tolerance, bst_feature_t n_features)
+      : tolerance_{tolerance}, n_features_{n_features} {}
+
+  /**
+   * \brief Start a new tree.
+   */
+  void Reset() {
+    pruned_.clear();
+    masks_.clear();
+  }
+  /**
+   * \brief Features used by a node, empty if all features are used.
+   */
+  [[nodiscard]] common::Span<std::uint8_t const> FeatureMask(bst_node_t nidx) const {
+    auto i = static_cast<std::size_t>(nidx);
+    if (i >= masks_.size() || !masks_[i]) {
+      return {};
+    }
+    return {masks_[i]->data(), masks_[i]->size()};
+  }
+  /**
+   * \brief Record the features to be pruned from the children of an evaluated node.
+   *
+   * \param gains    Best gain of each feature, `kNotEvaluated` for features not evaluated.
+   * \param loss_chg Gain of the best split of the node.
+   */
+  void Evaluated(bst_node_t nidx, common::Span<float const> gains, float loss_chg) {
+    auto i = static_cast<std::size_t>(nidx);
+    if (i >= pruned_.size()) {
+      pruned_.resize(i + 1);
+    }
+    auto threshold = tolerance_ * loss_chg;
+    std::vector<bst_feature_t> pruned;
+    for (bst_feature_t fidx = 0; fidx < gains.size(); ++fidx) {
+      if (gains[fidx] != kNotEvaluated && gains[fidx] < threshold) {
+        pruned.push_back(fidx);
+      }
+    }
+    pruned_[i] = std::move(pruned);
+  }
+  /**
+   * \brief Derive the features used by the children after a node is split.
+   */
+  void Split(bst_node_t nidx, bst_node_t left_nidx, bst_node_t right_nidx) {
+    auto i = static_cast<std::size_t>(nidx);
+    auto mask = i < masks_.size() ? masks_[i] : nullptr;
+    if (i < pruned_.size() && !pruned_[i].empty()) {
+      auto child = mask ? std::make_shared<std::vector<std::uint8_t>>(*mask)
+                        : std::make_shared<std::vector<std::uint8_t>>(n_features_, 1);
+      for (auto fidx : pruned_[i]) {
+        (*child)[fidx] = 0;
+      }
+      mask = std::move(child);
+      pruned_[i] = std::vector<bst_feature_t>{};
+    }
+    auto n_nodes = static_cast<std::size_t>(std::max(left_nidx, right_nidx)) + 1;
+    if (masks_.size() < n_nodes) {
+      masks_.resize(n_nodes);
+    }
+    masks_[left_nidx] = mask;
+    masks_[right_nidx] = mask;
+  }
+};
+}  // namespace xgboost::tree
+#endif  // XGBOOST_TREE_HIST_FEATURE_PRUNER_H_
@@ -5,17 +5,125 @@
 #define XGBOOST_TREE_HIST_HISTOGRAM_H_
 
 #include <algorithm>
+#include <cstddef>      // for size_t
+#include <cstdint>      // for uint16_t, uint32_t, uint64_t
+#include <cstring>      // for memcpy
+#include <future>       // for future
 #include <limits>
+#include <memory>       // for unique_ptr
+#include <numeric>      // for iota
+#include <type_traits>  // for is_same_v
+#include <utility>      // for move
 #include <vector>
 
 #include "../../collective/communicator-inl.h"
 #include "../../common/hist_util.h"
+#include "../../common/threadpool.h"  // for ThreadPool
 #include "../../data/gradient_index.h"
+#include "../param.h"  // for TrainParam
 #include "expand_entry.h"
+#include "feature_pruner.h"  // for FeaturePruner
 #include "xgboost/tree_model.h"  // for RegTree
 
 namespace xgboost {
 namespace tree {
+namespace detail {
+/**
+ * \brief Encoding of histogram values for the allreduce, each codec defines the type being
+ *        transmitted and the summation of it, the sums are returned in double.
+ *
+ *   `AllreduceBytes` estimates the bytes sent by each worker to sum `n` values, a ring
+ *   allreduce sends every value about twice.
+ */
+struct DoubleCodec {
+  using Type = double;
+  static Type Encode(double v) { return v; }
+  static double Decode(Type v) { return v; }
+  static std::size_t AllreduceBytes(std::size_t n, std::int32_t) { return 2 * n * sizeof(Type); }
+  static void Allreduce(Type *data, std::size_t n, double *out) {
+    collective::Allreduce<collective::Operation::kSum>(data, n);
+    std::copy_n(data, n, out);
+  }
+};
+
+struct FloatCodec {
+  using Type = float;
+  static Type Encode(double v) { return static_cast<float>(v); }
+  static double Decode(Type v) { return v; }
+  static std::size_t AllreduceBytes(std::size_t n, std::int32_t) { return 2 * n * sizeof(Type); }
+  static void Allreduce(Type *data, std::size_t n, double *out) {
+    collective::Allreduce<collective::Operation::kSum>(data, n);
+    std::copy_n(data, n, out);
+  }
+};
+
+/**
+ * \brief The upper half of a float, rounded to the nearest even.
+ *
+ *   Summing in bfloat16 would round again at every hop of the allreduce, which the error
+ *   feedback can't correct.  The encoded values are gathered and summed in double by each
+ *   worker if that sends fewer bytes than summing them as float, otherwise they are summed
+ *   as float.  Either way only the local encoding is rounded to bfloat16.
+ */
+struct BFloat16Codec {
+  using Type = std::uint16_t;
+  static Type Encode(double v) {
+    auto f = static_cast<float>(v);
+    std::uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    if (f != f) {
+      return static_cast<Type>((bits >> 16) | 0x40);
+    }
+    bits += 0x7fff + ((bits >> 16) & 1);
+    return static_cast<Type>(bits >> 16);
+  }
+  static double Decode(Type v) {
+    auto bits = static_cast<std::uint32_t>(v) << 16;
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+  }
+  [[nodiscard]] static bool UseGather(std::int32_t world) {
+    return static_cast<std::size_t>(world) * sizeof(Type) < FloatCodec::AllreduceBytes(1, world);
+  }
+  static std::size_t AllreduceBytes(std::size_t n, std::int32_t world) {
+    return UseGather(world) ? static_cast<std::size_t>(world) * n * sizeof(Type)
+                            : FloatCodec::AllreduceBytes(n, world);
+  }
+  static void Allreduce(Type *data, std::size_t n, double *out) {
+    auto world = collective::GetWorldSize();
+    if (!UseGather(world)) {
+      std::vector<float> values(n);
+      std::transform(data, data + n, values.begin(), Decode);
+      collective::Allreduce<collective::Operation::kSum>(values.data(), n);
+      std::copy(values.cbegin(), values.cend(), out);
+      return;
+    }
+    std::vector<Type> gathered(n * world);
+    std::copy_n(data, n, gathered.begin() + n * collective::GetRank());
+    collective::Allgather(gathered.data(), gathered.size() * sizeof(Type));
+    std::fill_n(out, n, 0.0);
+    for (std::int32_t rank = 0; rank < world; ++rank) {
+      auto in = gathered.cbegin() + n * rank;
+      for (std::size_t i = 0; i < n; ++i) {
+        out[i] += Decode(in[i]);
+      }
+    }
+  }
+};
+
+/**
+ * \brief A non-empty histogram bin in the sparse encoding.
+ */
+template <typename T>
+struct SparseBin {
+  static constexpr std::uint32_t kPadding = std::numeric_limits<std::uint32_t>::max();
+  std::uint32_t bin_idx{kPadding};
+  T grad{};
+  T hess{};
+};
+}  // namespace detail
+
 template <typename ExpandEntry>
 class HistogramBuilder {
   /*! \brief culmulative histogram of gradients. */
@@ -30,6 +138,24 @@ class HistogramBuilder {
   // Whether XGBoost is running in distributed environment.
   bool is_distributed_{false};
   bool is_col_split_{false};
+  // Whether the last page is built by partitioning features among threads, in which case
+  // the node histograms are written directly without thread local buffers.
+  bool feature_parallel_{false};
+  // Minimum number of features assigned to each thread in the feature parallel mode.
+  static constexpr bst_feature_t kMinFeaturesPerThread = 64;
+  // Maximum number of node groups for overlapping the histogram allreduce with building.
+  static constexpr std::size_t kMaxSyncGroups = 4;
+  // Worker for building histograms while the calling thread runs the allreduce.  The
+  // communicator is thread local, so collective calls stay in the calling thread.
+  std::unique_ptr<common::ThreadPool> sync_worker_;
+  // Compression of the histogram allreduce.
+  int sync_precision_{TrainParam::kDoubleSync};
+  bool sync_sparse_{false};
+  // Difference between the transmitted and the local histogram of each node, only used
+  // for the error feedback of reduced precision.
+  common::HistCollection sync_residual_;
+  // Features skipped for each node, null if all features are built.
+  std::shared_ptr<FeaturePruner const> pruner_;
 
  public:
   /**
@@ -52,10 +178,28 @@ class HistogramBuilder {
     builder_ = common::GHistBuilder(total_bins);
     is_distributed_ = is_distributed;
     is_col_split_ = is_col_split;
+    sync_residual_.Init(total_bins);
     // Workaround s390x gcc 7.5.0
     auto DMLC_ATTRIBUTE_UNUSED __force_instantiation = &GradientPairPrecise::Reduce;
   }
 
+  /**
+   * \brief Set the encoding of histograms for the allreduce in distributed training.
+   */
+  void ConfigureSync(TrainParam const &param) {
+    sync_precision_ = param.hist_sync_precision;
+    sync_sparse_ = param.hist_sync_sparse;
+  }
+  /**
+   * \brief Skip the features excluded by the split evaluator when building histograms.
+   */
+  void SetFeaturePruner(std::shared_ptr<FeaturePruner const> pruner) {
+    pruner_ = std::move(pruner);
+  }
+  [[nodiscard]] common::Span<std::uint8_t const> FeatureMask(bst_node_t nidx) const {
+    return pruner_ ? pruner_->FeatureMask(nidx) : common::Span<std::uint8_t const>{};
+  }
+
   template <bool any_missing>
   void BuildLocalHistograms(size_t page_idx, common::BlockedSpace2d space,
                             GHistIndexMatrix const &gidx,
@@ -76,6 +220,13 @@ class HistogramBuilder {
       // has significant variance.
       buffer_.Reset(this->n_threads_, n_nodes, space, target_hists);
     }
+    // Decided for each page, external memory pages can differ in density.
+    feature_parallel_ = !any_missing && this->UseFeatureParallel(gidx, space);
+    if (feature_parallel_) {
+      this->BuildFeatureParallel(gidx, nodes_for_explicit_hist_build, row_set_collection,
+                                 gpair_h);
+      return;
+    }
 
     // Parallel processing by nodes and data in each node
     common::ParallelFor2d(space, this->n_threads_, [&](size_t nid_in_set, common::Range1d r) {
@@ -89,7 +240,64 @@ class HistogramBuilder {
       auto hist = buffer_.GetInitializedHist(tid, nid_in_set);
       if (rid_set.Size() != 0) {
         builder_.template BuildHist<any_missing>(gpair_h, rid_set, gidx, hist,
-                                                 force_read_by_column);
+                                                 force_read_by_column, this->FeatureMask(nid));
+      }
+    });
+  }
+
+  /**
+   * \brief Whether to build the histograms by partitioning features instead of rows among
+   *        threads. For wide and short data, initializing and reducing one full width
+   *        histogram per thread costs more than building the histogram itself.
+   */
+  [[nodiscard]] bool UseFeatureParallel(GHistIndexMatrix const &gidx,
+                                        common::BlockedSpace2d const &space) const {
+    if (this->n_threads_ <= 1 || !gidx.IsDense()) {
+      return false;
+    }
+    auto n_features = gidx.Features();
+    if (n_features < kMinFeaturesPerThread * static_cast<bst_feature_t>(this->n_threads_)) {
+      return false;
+    }
+    // Number of rows to be processed, each row block of the space is at most 256 rows.
+    std::size_t n_rows = 0;
+    for (std::size_t i = 0; i < space.Size(); ++i) {
+      auto r = space.GetRange(i);
+      n_rows += r.end() - r.begin();
+    }
+    auto n_bins = static_cast<std::size_t>(builder_.GetNumBins());
+    return n_rows < n_bins * static_cast<std::size_t>(this->n_threads_);
+  }
+
+  /**
+   * \brief Each thread owns a disjoint range of features of a node and scans all rows of
+   *        the node for those features, writing directly into the node histogram.  The
+   *        node histogram is shared with the row-wise building of other pages.
+   */
+  void BuildFeatureParallel(GHistIndexMatrix const &gidx,
+                            std::vector<ExpandEntry> const &nodes_for_explicit_hist_build,
+                            common::RowSetCollection const &row_set_collection,
+                            common::Span<GradientPair const> gpair_h) {
+    std::vector<std::uint8_t> first_use(nodes_for_explicit_hist_build.size());
+    for (std::size_t i = 0; i < first_use.size(); ++i) {
+      first_use[i] = buffer_.ClaimTargetHist(i);
+    }
+    auto n_features = gidx.Features();
+    auto const &ptrs = gidx.cut.Ptrs();
+    std::size_t grain = std::max<std::size_t>(
+        kMinFeaturesPerThread, common::DivRoundUp(n_features, this->n_threads_));
+    common::BlockedSpace2d space(
+        nodes_for_explicit_hist_build.size(), [&](std::size_t) { return n_features; }, grain);
+    common::ParallelFor2d(space, this->n_threads_, [&](std::size_t nid_in_set, common::Range1d r) {
+      auto nid = nodes_for_explicit_hist_build[nid_in_set].nid;
+      auto elem = row_set_collection[nid];
+      auto hist = hist_[nid];
+      if (first_use[nid_in_set]) {
+        common::InitilizeHistByZeroes(hist, ptrs[r.begin()], ptrs[r.end()]);
+      }
+      if (elem.Size() != 0) {
+        builder_.BuildHistForFeatures(gpair_h, elem, gidx, r.begin(), r.end(), hist,
+                                      this->FeatureMask(nid));
       }
     });
   }
@@ -119,6 +327,12 @@ class HistogramBuilder {
       this->AddHistRows(&starting_index, &sync_count, nodes_for_explicit_hist_build,
                         nodes_for_subtraction_trick, p_tree);
     }
+    if (is_distributed_ && !is_col_split_ && n_batches_ == 1 &&
+        nodes_for_explicit_hist_build.size() > 1) {
+      this->BuildHistOverlapSync(gidx, p_tree, row_set_collection, nodes_for_explicit_hist_build,
+                                 nodes_for_subtraction_trick, gpair, force_read_by_column);
+      return;
+    }
     if (gidx.IsDense()) {
       this->BuildLocalHistograms<false>(page_id, space, gidx, nodes_for_explicit_hist_build,
                                         row_set_collection, gpair, force_read_by_column);
@@ -166,6 +380,294 @@ class HistogramBuilder {
     const size_t nbins = builder_.GetNumBins();
     common::BlockedSpace2d space(
         nodes_for_explicit_hist_build.size(), [&](size_t) { return nbins; }, 1024);
+    this->ReduceLocalHistograms(space, p_tree, nodes_for_explicit_hist_build,
+                                nodes_for_subtraction_trick);
+
+    std::vector<bst_node_t> left_nidx;
+    for (std::size_t i = 0; i < nodes_for_explicit_hist_build.size(); ++i) {
+      auto nidx = nodes_for_explicit_hist_build[i].nid;
+      left_nidx.push_back(p_tree->IsRoot(nidx) || p_tree->IsLeftChild(nidx)
+                              ? nidx
+                              : nodes_for_subtraction_trick[i].nid);
+    }
+    std::sort(left_nidx.begin(), left_nidx.end());
+    this->AllreduceHist(p_tree, left_nidx);
+
+    this->SubtractSyncedHistograms(space, p_tree, nodes_for_explicit_hist_build,
+                                   nodes_for_subtraction_trick);
+  }
+
+  /**
+   * \brief Build the histograms in groups of nodes and synchronize each group while the
+   *        next one is being built.  Only used with a single page, the allreduce can start
+   *        only after all pages are processed otherwise.
+   */
+  void BuildHistOverlapSync(GHistIndexMatrix const &gidx, RegTree const *p_tree,
+                            common::RowSetCollection const &row_set_collection,
+                            std::vector<ExpandEntry> const &nodes_for_explicit_hist_build,
+                            std::vector<ExpandEntry> const &nodes_for_subtraction_trick,
+                            common::Span<GradientPair const> gpair, bool force_read_by_column) {
+    // Only the left children are synchronized, the rows of them are allocated contiguously
+    // in the order of node index.  Sort the node pairs by the left child so that each
+    // group covers a contiguous range of histogram rows.
+    auto left_nidx = [&](std::size_t i) {
+      auto nidx = nodes_for_explicit_hist_build[i].nid;
+      return p_tree->IsLeftChild(nidx) ? nidx : nodes_for_subtraction_trick[i].nid;
+    };
+    std::vector<std::size_t> sorted_idx(nodes_for_explicit_hist_build.size());
+    std::iota(sorted_idx.begin(), sorted_idx.end(), 0);
+    std::sort(sorted_idx.begin(), sorted_idx.end(),
+              [&](std::size_t l, std::size_t r) { return left_nidx(l) < left_nidx(r); });
+
+    auto n_groups = std::min(sorted_idx.size(), kMaxSyncGroups);
+    auto group_size = common::DivRoundUp(sorted_idx.size(), n_groups);
+    n_groups = common::DivRoundUp(sorted_idx.size(), group_size);
+    std::vector<std::vector<ExpandEntry>> build_groups(n_groups);
+    std::vector<std::vector<ExpandEntry>> sub_groups(n_groups);
+    for (std::size_t i = 0; i < sorted_idx.size(); ++i) {
+      build_groups[i / group_size].push_back(nodes_for_explicit_hist_build[sorted_idx[i]]);
+      sub_groups[i / group_size].push_back(nodes_for_subtraction_trick[sorted_idx[i]]);
+    }
+
+    auto const nbins = builder_.GetNumBins();
+    auto build_group = [&](std::size_t g) {
+      auto const &build = build_groups[g];
+      common::BlockedSpace2d space(
+          build.size(), [&](std::size_t i) { return row_set_collection[build[i].nid].Size(); },
+          256);
+      if (gidx.IsDense()) {
+        this->BuildLocalHistograms<false>(0, space, gidx, build, row_set_collection, gpair,
+                                          force_read_by_column);
+      } else {
+        this->BuildLocalHistograms<true>(0, space, gidx, build, row_set_collection, gpair,
+                                         force_read_by_column);
+      }
+      common::BlockedSpace2d hist_space(
+          build.size(), [&](std::size_t) { return nbins; }, 1024);
+      this->ReduceLocalHistograms(hist_space, p_tree, build, sub_groups[g]);
+    };
+
+    if (!sync_worker_) {
+      sync_worker_ = std::make_unique<common::ThreadPool>(1);
+    }
+    build_group(0);
+    for (std::size_t g = 0; g < n_groups; ++g) {
+      std::future<void> next;
+      if (g + 1 < n_groups) {
+        next = sync_worker_->Submit([&, g] { build_group(g + 1); });
+      }
+      std::vector<bst_node_t> group_nidx(build_groups[g].size());
+      for (std::size_t i = 0; i < group_nidx.size(); ++i) {
+        group_nidx[i] = left_nidx(sorted_idx[g * group_size + i]);
+      }
+      try {
+        this->AllreduceHist(p_tree, group_nidx);
+      } catch (...) {
+        // The pending task refers to the local variables.
+        if (next.valid()) {
+          next.wait();
+        }
+        throw;
+      }
+      if (next.valid()) {
+        next.get();
+      }
+    }
+
+    common::BlockedSpace2d space(
+        nodes_for_explicit_hist_build.size(), [&](std::size_t) { return nbins; }, 1024);
+    this->SubtractSyncedHistograms(space, p_tree, nodes_for_explicit_hist_build,
+                                   nodes_for_subtraction_trick);
+  }
+
+  /**
+   * \brief Allreduce the histograms of left children.  The nodes must be sorted, their rows
+   *        are allocated contiguously in the same order.
+   */
+  void AllreduceHist(RegTree const *p_tree, std::vector<bst_node_t> const &left_nidx) {
+    if (sync_precision_ == TrainParam::kDoubleSync && !sync_sparse_) {
+      collective::Allreduce<collective::Operation::kSum>(
+          reinterpret_cast<double *>(this->hist_[left_nidx.front()].data()),
+          builder_.GetNumBins() * left_nidx.size() * 2);
+      return;
+    }
+    switch (sync_precision_) {
+      case TrainParam::kDoubleSync:
+        this->AllreduceHistEncoded<detail::DoubleCodec>(p_tree, left_nidx);
+        break;
+      case TrainParam::kFloatSync:
+        this->AllreduceHistEncoded<detail::FloatCodec>(p_tree, left_nidx);
+        break;
+      case TrainParam::kBFloat16Sync:
+        this->AllreduceHistEncoded<detail::BFloat16Codec>(p_tree, left_nidx);
+        break;
+      default:
+        LOG(FATAL) << "Unknown histogram sync precision: " << sync_precision_;
+    }
+  }
+
+  /**
+   * \brief Allreduce the histograms with reduced precision or sparse encoding.
+   *
+   *   With reduced precision, the error of a node is divided between its children.  Half
+   *   of the parent error is added to the non-empty bins of the left child before encoding,
+   *   the right child obtained by subtraction receives the rest.  Bins empty in the left
+   *   child are not modified to keep the histogram sparse.
+   *
+   *   With sparse encoding, the maximum number of non-empty bins of each node across workers
+   *   decides whether the node is sent as padded (index, value) pairs with allgather, which
+   *   are then summed locally in the order of rank.
+   */
+  template <typename Codec>
+  void AllreduceHistEncoded(RegTree const *p_tree, std::vector<bst_node_t> const &left_nidx) {
+    using T = typename Codec::Type;
+    constexpr bool kFeedback = !std::is_same_v<T, double>;
+    auto const nbins = builder_.GetNumBins();
+    auto const n_nodes = left_nidx.size();
+    auto is_empty = [](GradientPairPrecise const &g) {
+      return g.GetGrad() == 0.0 && g.GetHess() == 0.0;
+    };
+
+    if constexpr (kFeedback) {
+      for (auto nidx : left_nidx) {
+        sync_residual_.AddHistRow(nidx);
+        sync_residual_.AllocateData(nidx);
+        if (!p_tree->IsRoot(nidx)) {
+          auto sibling = p_tree->RightChild(p_tree->Parent(nidx));
+          sync_residual_.AddHistRow(sibling);
+          sync_residual_.AllocateData(sibling);
+        }
+      }
+    }
+    // Encode the local histograms.
+    std::vector<T> values(n_nodes * nbins * 2);
+    common::BlockedSpace2d space(
+        n_nodes, [&](std::size_t) { return nbins; }, 1024);
+    common::ParallelFor2d(space, n_threads_, [&](std::size_t node, common::Range1d r) {
+      auto nidx = left_nidx[node];
+      auto hist = this->hist_[nidx];
+      auto out = values.data() + node * nbins * 2;
+      // Error of the parent, this node and the sibling.
+      common::GHistRow parent_error, error, sibling_error;
+      if constexpr (kFeedback) {
+        error = sync_residual_[nidx];
+        if (!p_tree->IsRoot(nidx)) {
+          auto parent = p_tree->Parent(nidx);
+          parent_error = sync_residual_[parent];
+          sibling_error = sync_residual_[p_tree->RightChild(parent)];
+        }
+      }
+      for (auto i = r.begin(); i < r.end(); ++i) {
+        auto g = hist[i];
+        if (!parent_error.empty() && !is_empty(g)) {
+          g += parent_error[i] * 0.5f;
+        }
+        out[i * 2] = Codec::Encode(g.GetGrad());
+        out[i * 2 + 1] = Codec::Encode(g.GetHess());
+        if constexpr (kFeedback) {
+          GradientPairPrecise e;
+          if (!is_empty(hist[i])) {
+            e = GradientPairPrecise{Codec::Decode(out[i * 2]), Codec::Decode(out[i * 2 + 1])};
+            e -= hist[i];
+          }
+          error[i] = e;
+          if (!parent_error.empty()) {
+            sibling_error[i] = parent_error[i] - e;
+          }
+        }
+      }
+    });
+
+    // Choose the encoding for each node.
+    std::vector<std::uint64_t> max_nnz(n_nodes, 0);
+    if (sync_sparse_) {
+      common::ParallelFor(n_nodes, n_threads_, [&](std::size_t node) {
+        auto hist = this->hist_[left_nidx[node]];
+        max_nnz[node] = std::count_if(hist.cbegin(), hist.cend(),
+                                      [&](auto const &g) { return !is_empty(g); });
+      });
+      collective::Allreduce<collective::Operation::kMax>(max_nnz.data(), max_nnz.size());
+    }
+    auto world = static_cast<std::uint64_t>(collective::GetWorldSize());
+    auto is_sparse = [&](std::size_t node) {
+      return sync_sparse_ && world * max_nnz[node] * sizeof(detail::SparseBin<T>) <
+                                 Codec::AllreduceBytes(nbins * 2, static_cast<std::int32_t>(world));
+    };
+
+    // Dense nodes, the values are summed by the communicator.
+    std::vector<std::size_t> dense_nodes;
+    std::vector<std::size_t> sparse_nodes;
+    for (std::size_t node = 0; node < n_nodes; ++node) {
+      (is_sparse(node) ? sparse_nodes : dense_nodes).push_back(node);
+    }
+    if (!dense_nodes.empty()) {
+      std::vector<T> dense;
+      T *p_dense = values.data();
+      if (!sparse_nodes.empty()) {
+        dense.resize(dense_nodes.size() * nbins * 2);
+        for (std::size_t k = 0; k < dense_nodes.size(); ++k) {
+          auto beg = values.cbegin() + dense_nodes[k] * nbins * 2;
+          std::copy(beg, beg + nbins * 2, dense.begin() + k * nbins * 2);
+        }
+        p_dense = dense.data();
+      }
+      std::vector<double> summed(dense_nodes.size() * nbins * 2);
+      Codec::Allreduce(p_dense, summed.size(), summed.data());
+      common::BlockedSpace2d dense_space(
+          dense_nodes.size(), [&](std::size_t) { return nbins; }, 1024);
+      common::ParallelFor2d(dense_space, n_threads_, [&](std::size_t k, common::Range1d r) {
+        auto hist = this->hist_[left_nidx[dense_nodes[k]]];
+        auto in = summed.cbegin() + k * nbins * 2;
+        for (auto i = r.begin(); i < r.end(); ++i) {
+          hist[i] = GradientPairPrecise{in[i * 2], in[i * 2 + 1]};
+        }
+      });
+    }
+    if (sparse_nodes.empty()) {
+      return;
+    }
+
+    // Sparse nodes, each worker fills its own segment with the non-empty bins.
+    std::vector<std::size_t> bin_ptr(sparse_nodes.size() + 1, 0);
+    for (std::size_t k = 0; k < sparse_nodes.size(); ++k) {
+      bin_ptr[k + 1] = bin_ptr[k] + max_nnz[sparse_nodes[k]];
+    }
+    auto const n_local = bin_ptr.back();
+    std::vector<detail::SparseBin<T>> bins(n_local * world);
+    auto local = bins.data() + n_local * collective::GetRank();
+    common::ParallelFor(sparse_nodes.size(), n_threads_, [&](std::size_t k) {
+      auto node = sparse_nodes[k];
+      auto hist = this->hist_[left_nidx[node]];
+      auto in = values.cbegin() + node * nbins * 2;
+      auto out = local + bin_ptr[k];
+      for (std::uint32_t i = 0; i < nbins; ++i) {
+        if (!is_empty(hist[i])) {
+          *out++ = detail::SparseBin<T>{i, in[i * 2], in[i * 2 + 1]};
+        }
+      }
+    });
+    collective::Allgather(bins.data(), bins.size() * sizeof(detail::SparseBin<T>));
+    common::ParallelFor(sparse_nodes.size(), n_threads_, [&](std::size_t k) {
+      auto hist = this->hist_[left_nidx[sparse_nodes[k]]];
+      std::fill(hist.begin(), hist.end(), GradientPairPrecise{});
+      for (std::uint64_t rank = 0; rank < world; ++rank) {
+        auto beg = bins.cbegin() + rank * n_local + bin_ptr[k];
+        auto end = bins.cbegin() + rank * n_local + bin_ptr[k + 1];
+        for (auto it = beg; it != end && it->bin_idx != detail::SparseBin<T>::kPadding; ++it) {
+          hist[it->bin_idx] +=
+              GradientPairPrecise{Codec::Decode(it->grad), Codec::Decode(it->hess)};
+        }
+      }
+    });
+  }
+
+  /**
+   * \brief Merge the thread local histograms and apply the subtraction trick with the
+   *        local parent histogram, the results are kept for the next level.
+   */
+  void ReduceLocalHistograms(common::BlockedSpace2d const &space, RegTree const *p_tree,
+                             std::vector<ExpandEntry> const &nodes_for_explicit_hist_build,
+                             std::vector<ExpandEntry> const &nodes_for_subtraction_trick) {
     common::ParallelFor2d(space, n_threads_, [&](size_t node, common::Range1d r) {
       const auto &entry = nodes_for_explicit_hist_build[node];
       auto this_hist = this->hist_[entry.nid];
@@ -186,11 +688,15 @@ class HistogramBuilder {
         common::CopyHist(sibling_local, sibling_hist, r.begin(), r.end());
       }
     });
+  }
 
-    collective::Allreduce<collective::Operation::kSum>(
-        reinterpret_cast<double *>(this->hist_[starting_index].data()),
-        builder_.GetNumBins() * sync_count * 2);
-
+  /**
+   * \brief Obtain the right children from the synchronized left children.
+   */
+  void SubtractSyncedHistograms(common::BlockedSpace2d const &space, RegTree const *p_tree,
+                                std::vector<ExpandEntry> const &nodes_for_explicit_hist_build,
+                                std::vector<ExpandEntry> const &nodes_for_subtraction_trick) {
+    auto const nbins = builder_.GetNumBins();
     ParallelSubtractionHist(space, nodes_for_explicit_hist_build, nodes_for_subtraction_trick,
                             p_tree);
 
@@ -227,6 +733,7 @@ class HistogramBuilder {
   /* Getters for tests. */
   common::HistCollection const &Histogram() { return hist_; }
   auto& Buffer() { return buffer_; }
+  [[nodiscard]] bool IsFeatureParallel() const { return feature_parallel_; }
 
  private:
   void
@@ -4,16 +4,22 @@
 #ifndef XGBOOST_TREE_HIST_SAMPLER_H_
 #define XGBOOST_TREE_HIST_SAMPLER_H_
 
-#include <cstddef>  // std::size-t
-#include <cstdint>  // std::uint64_t
-#include <random>   // bernoulli_distribution, linear_congruential_engine
+#include <cmath>       // std::sqrt
+#include <cstddef>     // std::size-t
+#include <cstdint>     // std::uint64_t
+#include <functional>  // std::less
+#include <limits>      // std::numeric_limits
+#include <random>      // bernoulli_distribution, linear_congruential_engine
+#include <vector>      // std::vector
 
-#include "../../common/random.h"  // GlobalRandom
-#include "../param.h"             // TrainParam
-#include "xgboost/base.h"         // GradientPair
-#include "xgboost/context.h"      // Context
-#include "xgboost/data.h"         // MetaInfo
-#include "xgboost/linalg.h"       // TensorView
+#include "../../common/algorithm.h"        // Sort
+#include "../../common/random.h"           // GlobalRandom
+#include "../../common/threading_utils.h"  // ParallelFor
+#include "../param.h"                      // TrainParam
+#include "xgboost/base.h"                  // GradientPair
+#include "xgboost/context.h"               // Context
+#include "xgboost/data.h"                  // MetaInfo
+#include "xgboost/linalg.h"                // TensorView
 
 namespace xgboost {
 namespace tree {
@@ -44,16 +50,8 @@ struct RandomReplace {
   }
 };
 
-// Only uniform sampling, no gradient-based yet.
-inline void SampleGradient(Context const* ctx, TrainParam param,
-                           linalg::MatrixView<GradientPair> out) {
-  CHECK(out.Contiguous());
-  CHECK_EQ(param.sampling_method, TrainParam::kUniform)
-      << "Only uniform sampling is supported, gradient-based sampling is only support by GPU Hist.";
-
-  if (param.subsample >= 1.0) {
-    return;
-  }
+inline void UniformSample(Context const* ctx, TrainParam const& param,
+                          linalg::MatrixView<GradientPair> out) {
   bst_row_t n_samples = out.Shape(0);
   auto& rnd = common::GlobalRandom();
 
@@ -104,6 +102,135 @@ inline void SampleGradient(Context const* ctx, TrainParam param,
   exc.Rethrow();
 #endif  // XGBOOST_CUSTOMIZE_GLOBAL_PRNG
 }
+
+/**
+ * \brief Combine the gradient pair into a single value, same as the `CombineGradientPair`
+ *        used by the GPU gradient-based sampler (minimal variance sampling with lambda=0.1).
+ */
+inline float CombineGradientPair(GradientPair const& gpair) {
+  constexpr float kLambda = 0.1f;
+  return std::sqrt(gpair.GetGrad() * gpair.GetGrad() +
+                   kLambda * gpair.GetHess() * gpair.GetHess());
+}
+
+/**
+ * \brief Calculate the threshold `u` such that the expected number of selected rows
+ *        \sum_i min(1, c_i / u) equals `sample_rows`, where c_i is the combined gradient.
+ *
+ * \param combined Combined gradient for each row, sorted in place.
+ *
+ * \return The threshold, rows with c_i >= u are always selected.
+ */
+inline float CalcThreshold(Context const* ctx, std::vector<float>* p_combined,
+                           std::size_t sample_rows) {
+  auto& combined = *p_combined;
+  std::size_t n_rows = combined.size();
+  if (sample_rows >= n_rows || n_rows == 0) {
+    return 0.0f;
+  }
+  common::Sort(ctx, combined.begin(), combined.end(), std::less<>{});
+  double grad_sum{0.0};
+  for (std::size_t i = 0; i < n_rows; ++i) {
+    grad_sum += combined[i];
+    // The top n_rows - i - 1 rows are selected with probability 1, the rest are selected
+    // with probability proportional to their combined gradient.
+    auto n_rest = static_cast<double>(sample_rows) - static_cast<double>(n_rows - i - 1);
+    if (n_rest <= 0.0) {
+      continue;
+    }
+    auto u = static_cast<float>(grad_sum / n_rest);
+    float lower = combined[i];
+    float upper = i + 1 == n_rows ? std::numeric_limits<float>::max() : combined[i + 1];
+    if (u > lower && u <= upper) {
+      return u;
+    }
+  }
+  return static_cast<float>(grad_sum / static_cast<double>(sample_rows));
+}
+
+/**
+ * \brief Gradient-based sampling. Rows with large gradient are always selected, while the
+ *        rest are selected with probability proportional to their gradient and then
+ *        re-weighted by the inverse of the probability to keep the gradient sum unbiased.
+ */
+inline void GradientBasedSample(Context const* ctx, TrainParam const& param,
+                                linalg::MatrixView<GradientPair> out) {
+  CHECK_EQ(out.Shape(1), 1) << "Multi-target with gradient-based sampling is not yet supported.";
+  bst_row_t n_samples = out.Shape(0);
+  std::vector<float> combined(n_samples);
+  common::ParallelFor(n_samples, ctx->Threads(),
+                      [&](std::size_t i) { combined[i] = CombineGradientPair(out(i, 0)); });
+  auto sample_rows = static_cast<std::size_t>(static_cast<double>(n_samples) * param.subsample);
+  float const threshold = CalcThreshold(ctx, &combined, sample_rows);
+
+  auto sample = [&](std::size_t i, float rnd) {
+    auto& gpair = out(i, 0);
+    // Empty rows are never selected.
+    if (gpair.GetGrad() == 0.0f && gpair.GetHess() == 0.0f) {
+      return;
+    }
+    float p = CombineGradientPair(gpair) / threshold;
+    if (p >= 1.0f) {
+      return;
+    }
+    if (rnd <= p) {
+      gpair = gpair / p;
+    } else {
+      gpair = GradientPair{};
+    }
+  };
+
+  auto& rnd = common::GlobalRandom();
+#if XGBOOST_CUSTOMIZE_GLOBAL_PRNG
+  std::uniform_real_distribution<float> dist;
+  for (std::size_t i = 0; i < n_samples; ++i) {
+    sample(i, dist(rnd));
+  }
+#else
+  std::uint64_t initial_seed = rnd();
+
+  auto n_threads = static_cast<size_t>(ctx->Threads());
+  std::size_t const discard_size = n_samples / n_threads;
+
+  dmlc::OMPException exc;
+#pragma omp parallel num_threads(n_threads)
+  {
+    exc.Run([&]() {
+      const size_t tid = omp_get_thread_num();
+      const size_t ibegin = tid * discard_size;
+      const size_t iend = (tid == (n_threads - 1)) ? n_samples : ibegin + discard_size;
+
+      const uint64_t displaced_seed = RandomReplace::SimpleSkip(
+          ibegin, initial_seed, RandomReplace::kBase, RandomReplace::kMod);
+      RandomReplace::EngineT eng(displaced_seed);
+      std::uniform_real_distribution<float> dist;
+      for (std::size_t i = ibegin; i < iend; ++i) {
+        // Always draw a number so that the result doesn't depend on the number of threads.
+        sample(i, dist(eng));
+      }
+    });
+  }
+  exc.Rethrow();
+#endif  // XGBOOST_CUSTOMIZE_GLOBAL_PRNG
+}
+
+inline void SampleGradient(Context const* ctx, TrainParam param,
+                           linalg::MatrixView<GradientPair> out) {
+  CHECK(out.Contiguous());
+  if (param.subsample >= 1.0) {
+    return;
+  }
+  switch (param.sampling_method) {
+    case TrainParam::kUniform:
+      UniformSample(ctx, param, out);
+      break;
+    case TrainParam::kGradientBased:
+      GradientBasedSample(ctx, param, out);
+      break;
+    default:
+      LOG(FATAL) << "Unknown sampling method.";
+  }
+}
 }  // namespace tree
 }  // namespace xgboost
 #endif  // XGBOOST_TREE_HIST_SAMPLER_H_
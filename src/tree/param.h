@@ -39,6 +39,8 @@ struct TrainParam : public XGBoostParameter<TrainParam> {
   // growing policy
   enum TreeGrowPolicy { kDepthWise = 0, kLossGuide = 1 };
   int grow_policy;
+  // whether small nodes are grouped into larger batches when growing the tree
+  bool adaptive_node_batch{false};
 
   uint32_t max_cat_to_onehot{4};
 
@@ -68,6 +70,8 @@ struct TrainParam : public XGBoostParameter<TrainParam> {
   float colsample_bytree;
   // accuracy of sketch
   float sketch_ratio;
+  // maximum change of the sketch weights before approx re-sketches the data
+  float sketch_drift_tolerance;
   // option to open cacheline optimization
   bool cache_opt;
   // whether refresh updater needs to update the leaf values
@@ -83,6 +87,15 @@ struct TrainParam : public XGBoostParameter<TrainParam> {
   static constexpr double DftSparseThreshold() { return 0.2; }
 
   double sparse_threshold{DftSparseThreshold()};
+  // precision of the histograms sent between workers in distributed training
+  enum HistSyncPrecision { kDoubleSync = 0, kFloatSync = 1, kBFloat16Sync = 2 };
+  int hist_sync_precision{kDoubleSync};
+  // whether to send the non-empty bins only for histograms that are mostly empty
+  bool hist_sync_sparse{false};
+  // whether each worker evaluates splits for a shard of features only
+  bool shard_split_evaluation{false};
+  // features with gain below this fraction of the chosen split are skipped in the subtree
+  float feature_gain_tolerance{0.0f};
 
   // declare the parameters
   DMLC_DECLARE_PARAMETER(TrainParam) {
@@ -113,6 +126,10 @@ struct TrainParam : public XGBoostParameter<TrainParam> {
             "Tree growing policy. 0: favor splitting at nodes closest to the node, "
             "i.e. grow depth-wise. 1: favor splitting at nodes with highest loss "
             "change. (cf. LightGBM)");
+    DMLC_DECLARE_FIELD(adaptive_node_batch)
+        .set_default(false)
+        .describe("Group small nodes into larger batches when growing the tree, the order of "
+                  "node expansion and the node numbering can differ from the default.");
     DMLC_DECLARE_FIELD(max_cat_to_onehot)
         .set_default(4)
         .set_lower_bound(1)
@@ -168,6 +185,12 @@ struct TrainParam : public XGBoostParameter<TrainParam> {
         .set_lower_bound(0.0f)
         .set_default(2.0f)
         .describe("EXP Param: Sketch accuracy related parameter of approximate algorithm.");
+    DMLC_DECLARE_FIELD(sketch_drift_tolerance)
+        .set_range(0.0f, 1.0f)
+        .set_default(0.0f)
+        .describe(
+            "Maximum total variation distance between the normalized sketch weights of the "
+            "current and the last sketch before approx re-sketches the data.");
     DMLC_DECLARE_FIELD(cache_opt)
         .set_default(true)
         .describe("EXP Param: Cache aware optimization.");
@@ -190,6 +213,26 @@ struct TrainParam : public XGBoostParameter<TrainParam> {
         .set_range(0, 1.0)
         .set_default(DftSparseThreshold())
         .describe("percentage threshold for treating a feature as sparse");
+    DMLC_DECLARE_FIELD(hist_sync_precision)
+        .set_default(kDoubleSync)
+        .add_enum("double", kDoubleSync)
+        .add_enum("float", kFloatSync)
+        .add_enum("bfloat16", kBFloat16Sync)
+        .describe("Precision of the histograms transmitted between workers in distributed "
+                  "training, the quantization error is fed back into the child nodes.");
+    DMLC_DECLARE_FIELD(hist_sync_sparse)
+        .set_default(false)
+        .describe("Transmit (index, value) pairs of the non-empty bins for histograms that are "
+                  "mostly empty in distributed training.");
+    DMLC_DECLARE_FIELD(shard_split_evaluation)
+        .set_default(false)
+        .describe("Evaluate the splits of a shard of features on each worker in distributed "
+                  "training with data split by rows, the best splits are gathered afterward.");
+    DMLC_DECLARE_FIELD(feature_gain_tolerance)
+        .set_range(0.0f, 1.0f)
+        .set_default(0.0f)
+        .describe("Features with best gain lower than this fraction of the gain of the chosen "
+                  "split are skipped in the subtree of the split node.  0 disables it.");
 
     // add alias of parameters
     DMLC_DECLARE_ALIAS(reg_lambda, lambda);
@@ -4,10 +4,17 @@
  * \brief Implementation for the approx tree method.
  */
 #include <algorithm>
+#include <cmath>       // for abs
+#include <functional>  // for multiplies
+#include <limits>      // for numeric_limits
 #include <memory>
 #include <vector>
 
+#include "../collective/communicator-inl.h"  // for Allreduce, IsDistributed
+#include "../common/numeric.h"               // for cpu_impl::Reduce
+#include "../common/quantile.h"              // for detail::UnrollGroupWeights
 #include "../common/random.h"
+#include "../common/transform_iterator.h"    // for MakeIndexTransformIter
 #include "../data/gradient_index.h"
 #include "common_row_partitioner.h"
 #include "constraints.h"
@@ -30,13 +37,52 @@ DMLC_REGISTRY_FILE_TAG(updater_approx);
 
 namespace {
 // Return the BatchParam used by DMatrix.
-auto BatchSpec(TrainParam const &p, common::Span<float> hess, ObjInfo const task) {
-  return BatchParam{p.max_bin, hess, !task.const_hess};
+auto BatchSpec(TrainParam const &p, common::Span<float> hess, bool regen) {
+  return BatchParam{p.max_bin, hess, regen};
 }
 
 auto BatchSpec(TrainParam const &p, common::Span<float> hess) {
   return BatchParam{p.max_bin, hess, false};
 }
+
+// Weights used by the sketch, hessian merged with sample or group weights.
+std::vector<float> SketchWeights(MetaInfo const &info, common::Span<float const> hess) {
+  auto const &weights = info.group_ptr_.empty() ? info.weights_.ConstHostVector()
+                                                : common::detail::UnrollGroupWeights(info);
+  std::vector<float> out(hess.cbegin(), hess.cend());
+  if (!weights.empty()) {
+    CHECK_EQ(weights.size(), out.size());
+    std::transform(out.cbegin(), out.cend(), weights.cbegin(), out.begin(), std::multiplies<>{});
+  }
+  return out;
+}
+
+/**
+ * \brief Total variation distance between two sets of normalized sketch weights.
+ *
+ *   The weighted rank of any value changes by at most this distance, so it bounds the
+ *   additional rank error of existing cuts for every feature.
+ */
+double SketchWeightDrift(Context const *ctx, std::vector<float> const &old_weights,
+                         std::vector<float> const &new_weights, bool row_split) {
+  CHECK_EQ(old_weights.size(), new_weights.size());
+  double sums[2] = {common::cpu_impl::Reduce(ctx, old_weights.cbegin(), old_weights.cend(), 0.0),
+                    common::cpu_impl::Reduce(ctx, new_weights.cbegin(), new_weights.cend(), 0.0)};
+  if (row_split) {
+    collective::Allreduce<collective::Operation::kSum>(sums, 2);
+  }
+  if (!(sums[0] > 0.0 && sums[1] > 0.0)) {
+    return std::numeric_limits<double>::infinity();
+  }
+  auto it = common::MakeIndexTransformIter([&](std::size_t i) {
+    return std::abs(old_weights[i] / sums[0] - new_weights[i] / sums[1]);
+  });
+  double drift = common::cpu_impl::Reduce(ctx, it, it + old_weights.size(), 0.0);
+  if (row_split) {
+    collective::Allreduce<collective::Operation::kSum>(&drift, 1);
+  }
+  return drift / 2.0;
+}
 }  // anonymous namespace
 
 class GloablApproxBuilder {
@@ -57,15 +103,14 @@ class GloablApproxBuilder {
   common::HistogramCuts feature_values_;
 
  public:
-  void InitData(DMatrix *p_fmat, common::Span<float> hess) {
+  void InitData(DMatrix *p_fmat, common::Span<float> hess, bool regen) {
     monitor_->Start(__func__);
 
     n_batches_ = 0;
     bst_bin_t n_total_bins = 0;
     partitioner_.clear();
     // Generating the GHistIndexMatrix is quite slow, is there a way to speed it up?
-    for (auto const &page :
-         p_fmat->GetBatches<GHistIndexMatrix>(BatchSpec(*param_, hess, *task_))) {
+    for (auto const &page : p_fmat->GetBatches<GHistIndexMatrix>(BatchSpec(*param_, hess, regen))) {
       if (n_total_bins == 0) {
         n_total_bins = page.cut.TotalBins();
         feature_values_ = page.cut;
@@ -78,6 +123,8 @@ class GloablApproxBuilder {
 
     histogram_builder_.Reset(n_total_bins, BatchSpec(*param_, hess), ctx_->Threads(), n_batches_,
                              collective::IsDistributed(), p_fmat->IsColumnSplit());
+    histogram_builder_.ConfigureSync(*param_);
+    histogram_builder_.SetFeaturePruner(evaluator_.Pruner());
     monitor_->Stop(__func__);
   }
 
@@ -180,11 +227,22 @@ class GloablApproxBuilder {
         monitor_{monitor} {}
 
   void UpdateTree(DMatrix *p_fmat, std::vector<GradientPair> const &gpair, common::Span<float> hess,
-                  RegTree *p_tree, HostDeviceVector<bst_node_t> *p_out_position) {
+                  bool regen, RegTree *p_tree, HostDeviceVector<bst_node_t> *p_out_position) {
     p_last_tree_ = p_tree;
-    this->InitData(p_fmat, hess);
+    this->InitData(p_fmat, hess, regen);
 
     Driver<CPUExpandEntry> driver(*param_);
+    if (param_->adaptive_node_batch) {
+      driver.SetRowEstimator(
+          [&](CPUExpandEntry const &e) {
+            std::size_t n = 0;
+            for (auto const &part : partitioner_) {
+              n += part.Partitions()[e.nid].Size();
+            }
+            return n;
+          },
+          ctx_->Threads());
+    }
     auto &tree = *p_tree;
     driver.Push({this->InitRoot(p_fmat, gpair, hess, p_tree)});
     auto expand_set = driver.Pop();
@@ -240,6 +298,10 @@ class GloablApproxBuilder {
       driver.Push(best_splits.begin(), best_splits.end());
       expand_set = driver.Pop();
     }
+    auto const &batch_stats = driver.BatchStats();
+    LOG(DEBUG) << "[GlobalApprox]: Expanded " << batch_stats.n_nodes << " nodes in "
+               << batch_stats.n_batches << " batches, largest batch: "
+               << batch_stats.max_batch_size << ", grouped batches: " << batch_stats.n_grouped;
 
     auto &h_position = p_out_position->HostVector();
     this->LeafPartition(tree, hess, &h_position);
@@ -248,7 +310,7 @@ class GloablApproxBuilder {
 
 /**
  * \brief Implementation for the approx tree method.  It constructs quantile for every
- *        iteration.
+ *        iteration unless the hessian is close to the one used by the last sketch.
  */
 class GlobalApproxUpdater : public TreeUpdater {
   common::Monitor monitor_;
@@ -259,6 +321,37 @@ class GlobalApproxUpdater : public TreeUpdater {
   std::shared_ptr<common::ColumnSampler> column_sampler_ =
       std::make_shared<common::ColumnSampler>();
   ObjInfo const *task_;
+  // The DMatrix last sketched by this updater and the weights used by the sketch.
+  DMatrix const *sketched_{nullptr};
+  bst_bin_t sketched_max_bin_{0};
+  std::vector<float> sketch_weights_;
+
+  /**
+   * \brief Whether the data should be sketched again with the current hessian.  The
+   *        existing cuts are reused when the sketch weights drift within the tolerance.
+   */
+  bool NeedRegen(TrainParam const &param, DMatrix *p_fmat, common::Span<float const> hess) {
+    if (task_->const_hess) {
+      return false;
+    }
+    auto weights = SketchWeights(p_fmat->Info(), hess);
+    std::int32_t comparable = p_fmat == sketched_ && param.max_bin == sketched_max_bin_ &&
+                              weights.size() == sketch_weights_.size();
+    if (collective::IsDistributed()) {
+      collective::Allreduce<collective::Operation::kMin>(&comparable, 1);
+    }
+    bool regen = true;
+    if (comparable) {
+      auto drift = SketchWeightDrift(ctx_, sketch_weights_, weights, p_fmat->IsRowSplit());
+      regen = drift > param.sketch_drift_tolerance;
+    }
+    if (regen) {
+      sketched_ = p_fmat;
+      sketched_max_bin_ = param.max_bin;
+      sketch_weights_ = std::move(weights);
+    }
+    return regen;
+  }
 
  public:
   explicit GlobalApproxUpdater(Context const *ctx, ObjInfo const *task)
@@ -295,10 +388,13 @@ class GlobalApproxUpdater : public TreeUpdater {
                    [](auto g) { return g.GetHess(); });
 
     cached_ = m;
+    // Trees in the same iteration share the hessian, sketch at most once.
+    auto regen = this->NeedRegen(*param, m, hess);
 
     std::size_t t_idx = 0;
     for (auto p_tree : trees) {
-      this->pimpl_->UpdateTree(m, s_gpair, hess, p_tree, &out_position[t_idx]);
+      this->pimpl_->UpdateTree(m, s_gpair, hess, regen, p_tree, &out_position[t_idx]);
+      regen = false;
       ++t_idx;
     }
   }
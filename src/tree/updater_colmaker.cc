@@ -6,7 +6,9 @@
  */
 #include <vector>
 #include <cmath>
+#include <cstdint>
 #include <algorithm>
+#include <numeric>
 
 #include "xgboost/parameter.h"
 #include "xgboost/tree_updater.h"
@@ -14,7 +16,9 @@
 #include "xgboost/json.h"
 #include "param.h"
 #include "constraints.h"
+#include "../common/common.h"
 #include "../common/random.h"
+#include "../common/threading_utils.h"
 #include "split_evaluator.h"
 
 namespace xgboost::tree {
@@ -131,6 +135,13 @@ class ColMaker: public TreeUpdater {
     // constructor
     ThreadEntry() = default;
   };
+  /*! \brief entry of a sorted column gathered for the expanding nodes */
+  struct GatheredEntry {
+    /*! \brief feature value */
+    bst_float fvalue;
+    /*! \brief gradient of the row */
+    GradientPair gpair;
+  };
   struct NodeEntry {
     /*! \brief statics for node entry */
     GradStats stats;
@@ -302,10 +313,10 @@ class ColMaker: public TreeUpdater {
     // update enumeration solution
     inline void UpdateEnumeration(
         int nid, GradientPair gstats, bst_float fvalue, int d_step,
-        bst_uint fid, GradStats &c, std::vector<ThreadEntry> &temp, // NOLINT(*)
+        bst_uint fid, GradStats &c, ThreadEntry *p_e, // NOLINT(*)
         TreeEvaluator::SplitEvaluator<TrainParam> const &evaluator) const {
       // get the statistics of nid
-      ThreadEntry &e = temp[nid];
+      ThreadEntry &e = *p_e;
       // test if first hit, this is fine, because we set 0 during init
       if (e.stats.Empty()) {
         e.stats.Add(gstats);
@@ -349,114 +360,191 @@ class ColMaker: public TreeUpdater {
         e.last_fvalue = fvalue;
       }
     }
-    // same as EnumerateSplit, with cacheline prefetch optimization
-    void EnumerateSplit(
-        const Entry *begin, const Entry *end, int d_step, bst_uint fid,
-        const std::vector<GradientPair> &gpair,
-        std::vector<ThreadEntry> &temp, // NOLINT(*)
-        TreeEvaluator::SplitEvaluator<TrainParam> const &evaluator) const {
+    // enumerate the split candidates of a node on a gathered column
+    void EnumerateSplit(const GatheredEntry *begin, const GatheredEntry *end, int d_step,
+                        bst_uint fid, int nid, ThreadEntry *p_e,
+                        TreeEvaluator::SplitEvaluator<TrainParam> const &evaluator) const {
       CHECK(param_.cache_opt) << "Support for `cache_opt' is removed in 1.0.0";
-      const std::vector<int> &qexpand = qexpand_;
-      // clear all the temp statistics
-      for (auto nid : qexpand) {
-        temp[nid].stats = GradStats();
-      }
+      ThreadEntry &e = *p_e;
+      // clear the temp statistics
+      e.stats = GradStats();
       // left statistics
       GradStats c;
-      // local cache buffer for position and gradient pair
-      constexpr int kBuffer = 32;
-      int buf_position[kBuffer] = {};
-      GradientPair buf_gpair[kBuffer] = {};
-      // aligned ending position
-      const Entry *align_end;
-      if (d_step > 0) {
-        align_end = begin + (end - begin) / kBuffer * kBuffer;
-      } else {
-        align_end = begin - (begin - end) / kBuffer * kBuffer;
+      for (const GatheredEntry *it = begin; it != end; it += d_step) {
+        this->UpdateEnumeration(nid, it->gpair, it->fvalue, d_step, fid, c, p_e, evaluator);
       }
-      int i;
-      const Entry *it;
-      const int align_step = d_step * kBuffer;
-      // internal cached loop
-      for (it = begin; it != align_end; it += align_step) {
-        const Entry *p;
-        for (i = 0, p = it; i < kBuffer; ++i, p += d_step) {
-          buf_position[i] = position_[p->index];
-          buf_gpair[i] = gpair[p->index];
-        }
-        for (i = 0, p = it; i < kBuffer; ++i, p += d_step) {
-          const int nid = buf_position[i];
-          if (nid < 0 || !interaction_constraints_.Query(nid, fid)) { continue; }
-          this->UpdateEnumeration(nid, buf_gpair[i],
-                                  p->fvalue, d_step,
-                                  fid, c, temp, evaluator);
+      // finish updating all statistics, check if it is possible to include all sum statistics
+      c.SetSubstract(snode_[nid].stats, e.stats);
+      if (e.stats.sum_hess >= param_.min_child_weight &&
+          c.sum_hess >= param_.min_child_weight) {
+        bst_float loss_chg;
+        const bst_float gap = std::abs(e.last_fvalue) + kRtEps;
+        const bst_float delta = d_step == +1 ? gap: -gap;
+        if (d_step == -1) {
+          loss_chg = static_cast<bst_float>(
+              evaluator.CalcSplitGain(param_, nid, fid, c, e.stats) -
+              snode_[nid].root_gain);
+          e.best.Update(loss_chg, fid, e.last_fvalue + delta, d_step == -1,
+                        false, c, e.stats);
+        } else {
+          loss_chg = static_cast<bst_float>(
+              evaluator.CalcSplitGain(param_, nid, fid, e.stats, c) -
+              snode_[nid].root_gain);
+          e.best.Update(loss_chg, fid, e.last_fvalue + delta, d_step == -1,
+                        false, e.stats, c);
         }
       }
+    }
 
-      // finish up the ending piece
-      for (it = align_end, i = 0; it != end; ++i, it += d_step) {
-        buf_position[i] = position_[it->index];
-        buf_gpair[i] = gpair[it->index];
+    /*!
+     * \brief Gather the entries of a block of sorted columns that belong to the expanding
+     *        nodes, along with their gradient.
+     *
+     *  Entries are grouped by feature first then by node, preserving the sorted order
+     *  within each group.  Rows that are deleted or don't belong to any expanding node are
+     *  dropped, as are rows forbidden by interaction constraints.  The columns are split
+     *  into chunks, entries of each chunk are counted for each node first, then scattered
+     *  into the buffer in parallel.
+     *
+     * \param features Features in this block.
+     * \param node_idx Index into the expand queue for each tree node, -1 if not expanding.
+     * \param p_node_ptr Output, the range of entries for the i^th feature and j^th node is
+     *                   given by [node_ptr[i * (n_nodes + 1) + j],
+     *                   node_ptr[i * (n_nodes + 1) + j + 1]).
+     */
+    void GatherColumns(HostSparsePageView const &page, common::Span<bst_feature_t const> features,
+                       std::vector<int> const &node_idx, const std::vector<GradientPair> &gpair,
+                       std::vector<GatheredEntry> *p_buffer, std::vector<std::size_t> *p_node_ptr) {
+      constexpr std::size_t kChunkSize = 8192;
+      auto n_threads = ctx_->Threads();
+      auto n_nodes = qexpand_.size();
+      auto n_features = features.size();
+      // the first chunk of each feature
+      std::vector<std::size_t> chunk_ptr(n_features + 1, 0);
+      for (std::size_t i = 0; i < n_features; ++i) {
+        chunk_ptr[i + 1] = chunk_ptr[i] + common::DivRoundUp(page[features[i]].size(), kChunkSize);
       }
-      for (it = align_end, i = 0; it != end; ++i, it += d_step) {
-        const int nid = buf_position[i];
-        if (nid < 0 || !interaction_constraints_.Query(nid, fid)) { continue; }
-        this->UpdateEnumeration(nid, buf_gpair[i],
-                                it->fvalue, d_step,
-                                fid, c, temp, evaluator);
+      auto n_chunks = chunk_ptr.back();
+      std::vector<std::size_t> chunk_feature(n_chunks);
+      for (std::size_t i = 0; i < n_features; ++i) {
+        std::fill(chunk_feature.begin() + chunk_ptr[i], chunk_feature.begin() + chunk_ptr[i + 1],
+                  i);
       }
-      // finish updating all statistics, check if it is possible to include all sum statistics
-      for (int nid : qexpand) {
-        ThreadEntry &e = temp[nid];
-        c.SetSubstract(snode_[nid].stats, e.stats);
-        if (e.stats.sum_hess >= param_.min_child_weight &&
-            c.sum_hess >= param_.min_child_weight) {
-          bst_float loss_chg;
-          const bst_float gap = std::abs(e.last_fvalue) + kRtEps;
-          const bst_float delta = d_step == +1 ? gap: -gap;
-          if (d_step == -1) {
-            loss_chg = static_cast<bst_float>(
-                evaluator.CalcSplitGain(param_, nid, fid, c, e.stats) -
-                snode_[nid].root_gain);
-            e.best.Update(loss_chg, fid, e.last_fvalue + delta, d_step == -1,
-                          false, c, e.stats);
-          } else {
-            loss_chg = static_cast<bst_float>(
-                evaluator.CalcSplitGain(param_, nid, fid, e.stats, c) -
-                snode_[nid].root_gain);
-            e.best.Update(loss_chg, fid, e.last_fvalue + delta, d_step == -1,
-                          false, e.stats, c);
+      // whether the feature can be used by the node
+      std::vector<std::uint8_t> allowed(n_features * n_nodes);
+      common::ParallelFor(allowed.size(), n_threads, [&](auto k) {
+        allowed[k] = interaction_constraints_.Query(qexpand_[k % n_nodes], features[k / n_nodes]);
+      });
+      auto for_each_entry = [&](std::size_t chunk, auto &&fn) {
+        auto i = chunk_feature[chunk];
+        auto col = page[features[i]];
+        auto begin = (chunk - chunk_ptr[i]) * kChunkSize;
+        auto end = std::min(begin + kChunkSize, col.size());
+        for (auto j = begin; j < end; ++j) {
+          auto ridx = col[j].index;
+          int nid = position_[ridx];
+          if (nid < 0 || node_idx[nid] < 0 || !allowed[i * n_nodes + node_idx[nid]]) {
+            continue;
           }
+          fn(node_idx[nid], col[j].fvalue, ridx);
         }
+      };
+
+      // count the entries of each node in each chunk
+      std::vector<std::size_t> chunk_offsets(n_chunks * n_nodes, 0);
+      common::ParallelFor(n_chunks, n_threads, common::Sched::Dyn(), [&](auto chunk) {
+        auto *counts = chunk_offsets.data() + chunk * n_nodes;
+        for_each_entry(chunk, [&](int n, bst_float, bst_uint) { ++counts[n]; });
+      });
+      // the beginning of each feature in the buffer
+      std::vector<std::size_t> feature_ptr(n_features + 1, 0);
+      for (std::size_t i = 0; i < n_features; ++i) {
+        auto beg = chunk_offsets.cbegin() + chunk_ptr[i] * n_nodes;
+        auto end = chunk_offsets.cbegin() + chunk_ptr[i + 1] * n_nodes;
+        feature_ptr[i + 1] = feature_ptr[i] + std::accumulate(beg, end, std::size_t{0});
       }
+      // exclusive scan over nodes then chunks for each feature
+      auto &node_ptr = *p_node_ptr;
+      node_ptr.resize(n_features * (n_nodes + 1));
+      common::ParallelFor(n_features, n_threads, [&](auto i) {
+        auto sum = feature_ptr[i];
+        for (std::size_t n = 0; n < n_nodes; ++n) {
+          node_ptr[i * (n_nodes + 1) + n] = sum;
+          for (auto chunk = chunk_ptr[i]; chunk < chunk_ptr[i + 1]; ++chunk) {
+            auto cnt = chunk_offsets[chunk * n_nodes + n];
+            chunk_offsets[chunk * n_nodes + n] = sum;
+            sum += cnt;
+          }
+        }
+        node_ptr[i * (n_nodes + 1) + n_nodes] = sum;
+      });
+
+      auto &buffer = *p_buffer;
+      buffer.resize(feature_ptr.back());
+      common::ParallelFor(n_chunks, n_threads, common::Sched::Dyn(), [&](auto chunk) {
+        auto *cursor = chunk_offsets.data() + chunk * n_nodes;
+        for_each_entry(chunk, [&](int n, bst_float fvalue, bst_uint ridx) {
+          buffer[cursor[n]++] = GatheredEntry{fvalue, gpair[ridx]};
+        });
+      });
     }
 
     // update the solution candidate
     virtual void UpdateSolution(const SortedCSCPage &batch,
                                 const std::vector<bst_feature_t> &feat_set,
                                 const std::vector<GradientPair> &gpair, DMatrix *) {
-      // start enumeration
-      const auto num_features = feat_set.size();
+      // bound the size of the gathered columns by processing the features in blocks
+      constexpr std::size_t kBlockEntries = static_cast<std::size_t>(1) << 24;
       CHECK(this->ctx_);
-      const int batch_size =  // NOLINT
-          std::max(static_cast<int>(num_features / this->ctx_->Threads() / 32), 1);
       auto page = batch.GetView();
-      common::ParallelFor(
-          num_features, ctx_->Threads(), common::Sched::Dyn(batch_size), [&](auto i) {
-            auto evaluator = tree_evaluator_.GetEvaluator();
-            bst_feature_t const fid = feat_set[i];
-            int32_t const tid = omp_get_thread_num();
-            auto c = page[fid];
-            const bool ind = c.size() != 0 && c[0].fvalue == c[c.size() - 1].fvalue;
-            if (colmaker_train_param_.NeedForwardSearch(column_densities_[fid], ind)) {
-              this->EnumerateSplit(c.data(), c.data() + c.size(), +1, fid, gpair, stemp_[tid],
-                                   evaluator);
-            }
-            if (colmaker_train_param_.NeedBackwardSearch()) {
-              this->EnumerateSplit(c.data() + c.size() - 1, c.data() - 1, -1, fid, gpair,
-                                   stemp_[tid], evaluator);
-            }
-          });
+      auto n_nodes = qexpand_.size();
+      std::vector<int> node_idx(snode_.size(), -1);
+      for (std::size_t n = 0; n < n_nodes; ++n) {
+        node_idx[qexpand_[n]] = static_cast<int>(n);
+      }
+
+      std::vector<GatheredEntry> buffer;
+      std::vector<std::size_t> node_ptr;
+      std::size_t fbegin = 0;
+      while (fbegin < feat_set.size()) {
+        std::size_t fend = fbegin;
+        std::size_t n_entries = 0;
+        do {
+          n_entries += page[feat_set[fend]].size();
+          ++fend;
+        } while (fend < feat_set.size() &&
+                 n_entries + page[feat_set[fend]].size() <= kBlockEntries);
+        common::Span<bst_feature_t const> features{feat_set.data() + fbegin, fend - fbegin};
+        this->GatherColumns(page, features, node_idx, gpair, &buffer, &node_ptr);
+
+        // enumerate the splits for each pair of feature and node
+        common::ParallelFor(
+            features.size() * n_nodes, ctx_->Threads(), common::Sched::Dyn(), [&](auto k) {
+              auto i = k / n_nodes;
+              auto n = k % n_nodes;
+              auto beg = node_ptr[i * (n_nodes + 1) + n];
+              auto end = node_ptr[i * (n_nodes + 1) + n + 1];
+              if (beg == end) {
+                return;
+              }
+              auto evaluator = tree_evaluator_.GetEvaluator();
+              bst_feature_t const fid = features[i];
+              int const nid = qexpand_[n];
+              int32_t const tid = omp_get_thread_num();
+              auto c = page[fid];
+              const bool ind = c.size() != 0 && c[0].fvalue == c[c.size() - 1].fvalue;
+              auto *p_e = &stemp_[tid][nid];
+              if (colmaker_train_param_.NeedForwardSearch(column_densities_[fid], ind)) {
+                this->EnumerateSplit(buffer.data() + beg, buffer.data() + end, +1, fid, nid, p_e,
+                                     evaluator);
+              }
+              if (colmaker_train_param_.NeedBackwardSearch()) {
+                this->EnumerateSplit(buffer.data() + end - 1, buffer.data() + beg - 1, -1, fid,
+                                     nid, p_e, evaluator);
+              }
+            });
+        fbegin = fend;
+      }
     }
     // find splits at current level, do split per level
     inline void FindSplit(int depth,
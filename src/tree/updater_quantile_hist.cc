@@ -77,8 +77,7 @@ CPUExpandEntry QuantileHistMaker::Builder::InitRoot(
        * Specialized code for dense data: For dense data (with no missing value), the sum
        * of gradient histogram is equal to snode[nid]
        */
-      auto const &gmat = *(p_fmat->GetBatches<GHistIndexMatrix>(HistBatch(param_)).begin());
-      std::vector<uint32_t> const &row_ptr = gmat.cut.Ptrs();
+      std::vector<uint32_t> const &row_ptr = cuts_.Ptrs();
       CHECK_GE(row_ptr.size(), 2);
       uint32_t const ibegin = row_ptr[0];
       uint32_t const iend = row_ptr[1];
@@ -103,10 +102,7 @@ CPUExpandEntry QuantileHistMaker::Builder::InitRoot(
     std::vector<CPUExpandEntry> entries{node};
     monitor_->Start("EvaluateSplits");
     auto ft = p_fmat->Info().feature_types.ConstHostSpan();
-    for (auto const &gmat : p_fmat->GetBatches<GHistIndexMatrix>(HistBatch(param_))) {
-      evaluator_->EvaluateSplits(histogram_builder_->Histogram(), gmat.cut, ft, *p_tree, &entries);
-      break;
-    }
+    evaluator_->EvaluateSplits(histogram_builder_->Histogram(), cuts_, ft, *p_tree, &entries);
     monitor_->Stop("EvaluateSplits");
     node = entries.front();
   }
@@ -114,11 +110,18 @@ CPUExpandEntry QuantileHistMaker::Builder::InitRoot(
   return node;
 }
 
-void QuantileHistMaker::Builder::BuildHistogram(DMatrix *p_fmat, RegTree *p_tree,
-                                                std::vector<CPUExpandEntry> const &valid_candidates,
-                                                std::vector<GradientPair> const &gpair) {
-  std::vector<CPUExpandEntry> nodes_to_build(valid_candidates.size());
-  std::vector<CPUExpandEntry> nodes_to_sub(valid_candidates.size());
+namespace {
+/**
+ * \brief Choose the child with fewer samples for building histogram, the other one is
+ *        obtained by the subtraction trick.
+ */
+void AssignHistNodes(RegTree const *p_tree, std::vector<CPUExpandEntry> const &valid_candidates,
+                     std::vector<CPUExpandEntry> *p_nodes_to_build,
+                     std::vector<CPUExpandEntry> *p_nodes_to_sub) {
+  auto &nodes_to_build = *p_nodes_to_build;
+  auto &nodes_to_sub = *p_nodes_to_sub;
+  nodes_to_build.resize(valid_candidates.size());
+  nodes_to_sub.resize(valid_candidates.size());
 
   size_t n_idx = 0;
   for (auto const &c : valid_candidates) {
@@ -135,6 +138,15 @@ void QuantileHistMaker::Builder::BuildHistogram(DMatrix *p_fmat, RegTree *p_tree
     nodes_to_sub[n_idx] = CPUExpandEntry{subtract_nidx, p_tree->GetDepth(subtract_nidx), {}};
     n_idx++;
   }
+}
+}  // anonymous namespace
+
+void QuantileHistMaker::Builder::BuildHistogram(DMatrix *p_fmat, RegTree *p_tree,
+                                                std::vector<CPUExpandEntry> const &valid_candidates,
+                                                std::vector<GradientPair> const &gpair) {
+  std::vector<CPUExpandEntry> nodes_to_build;
+  std::vector<CPUExpandEntry> nodes_to_sub;
+  AssignHistNodes(p_tree, valid_candidates, &nodes_to_build, &nodes_to_sub);
 
   size_t page_id{0};
   auto space = ConstructHistSpace(partitioner_, nodes_to_build);
@@ -146,6 +158,36 @@ void QuantileHistMaker::Builder::BuildHistogram(DMatrix *p_fmat, RegTree *p_tree
   }
 }
 
+void QuantileHistMaker::Builder::UpdatePositionAndBuildHist(
+    DMatrix *p_fmat, RegTree *p_tree, std::vector<CPUExpandEntry> const &applied,
+    std::vector<CPUExpandEntry> const &valid_candidates, std::vector<GradientPair> const &gpair) {
+  std::vector<CPUExpandEntry> nodes_to_build;
+  std::vector<CPUExpandEntry> nodes_to_sub;
+  AssignHistNodes(p_tree, valid_candidates, &nodes_to_build, &nodes_to_sub);
+
+  // The work space has to be known before the first page is partitioned, use the size of
+  // the parent node as an upper bound of the size of the child node in each page.
+  std::vector<CPUExpandEntry> parents(nodes_to_build.size());
+  std::transform(nodes_to_build.cbegin(), nodes_to_build.cend(), parents.begin(),
+                 [&](CPUExpandEntry const &e) {
+                   return CPUExpandEntry{p_tree->Parent(e.nid), e.depth - 1, {}};
+                 });
+  auto space = ConstructHistSpace(partitioner_, parents);
+
+  size_t page_id{0};
+  for (auto const &page : p_fmat->GetBatches<GHistIndexMatrix>(HistBatch(param_))) {
+    monitor_->Start("UpdatePosition");
+    partitioner_.at(page_id).UpdatePosition(ctx_, page, applied, p_tree);
+    monitor_->Stop("UpdatePosition");
+    if (!nodes_to_build.empty()) {
+      histogram_builder_->BuildHist(page_id, space, page, p_tree,
+                                    partitioner_.at(page_id).Partitions(), nodes_to_build,
+                                    nodes_to_sub, gpair);
+    }
+    ++page_id;
+  }
+}
+
 void QuantileHistMaker::Builder::LeafPartition(RegTree const &tree,
                                                common::Span<GradientPair const> gpair,
                                                std::vector<bst_node_t> *p_out_position) {
@@ -165,6 +207,17 @@ void QuantileHistMaker::Builder::ExpandTree(DMatrix *p_fmat, RegTree *p_tree,
   monitor_->Start(__func__);
 
   Driver<CPUExpandEntry> driver(*param_);
+  if (param_->adaptive_node_batch) {
+    driver.SetRowEstimator(
+        [&](CPUExpandEntry const &e) {
+          std::size_t n = 0;
+          for (auto const &part : partitioner_) {
+            n += part.Partitions()[e.nid].Size();
+          }
+          return n;
+        },
+        ctx_->Threads());
+  }
   driver.Push(this->InitRoot(p_fmat, p_tree, gpair_h));
   auto const &tree = *p_tree;
   auto expand_set = driver.Pop();
@@ -174,7 +227,6 @@ void QuantileHistMaker::Builder::ExpandTree(DMatrix *p_fmat, RegTree *p_tree,
     std::vector<CPUExpandEntry> valid_candidates;
     // candidaates that can be applied.
     std::vector<CPUExpandEntry> applied;
-    int32_t depth = expand_set.front().depth + 1;
     for (auto const& candidate : expand_set) {
       evaluator_->ApplyTreeSplit(candidate, p_tree);
       applied.push_back(candidate);
@@ -183,35 +235,51 @@ void QuantileHistMaker::Builder::ExpandTree(DMatrix *p_fmat, RegTree *p_tree,
       }
     }
 
-    monitor_->Start("UpdatePosition");
-    size_t page_id{0};
-    for (auto const &page : p_fmat->GetBatches<GHistIndexMatrix>(HistBatch(param_))) {
-      partitioner_.at(page_id).UpdatePosition(ctx_, page, applied, p_tree);
-      ++page_id;
+    if (page_major_) {
+      this->UpdatePositionAndBuildHist(p_fmat, p_tree, applied, valid_candidates, gpair_h);
+    } else {
+      monitor_->Start("UpdatePosition");
+      size_t page_id{0};
+      for (auto const &page : p_fmat->GetBatches<GHistIndexMatrix>(HistBatch(param_))) {
+        partitioner_.at(page_id).UpdatePosition(ctx_, page, applied, p_tree);
+        ++page_id;
+      }
+      monitor_->Stop("UpdatePosition");
     }
-    monitor_->Stop("UpdatePosition");
 
     std::vector<CPUExpandEntry> best_splits;
     if (!valid_candidates.empty()) {
-      this->BuildHistogram(p_fmat, p_tree, valid_candidates, gpair_h);
+      if (!page_major_) {
+        this->BuildHistogram(p_fmat, p_tree, valid_candidates, gpair_h);
+      }
       for (auto const &candidate : valid_candidates) {
         int left_child_nidx = tree[candidate.nid].LeftChild();
         int right_child_nidx = tree[candidate.nid].RightChild();
-        CPUExpandEntry l_best{left_child_nidx, depth};
-        CPUExpandEntry r_best{right_child_nidx, depth};
+        // Nodes in the same batch might come from different levels.
+        CPUExpandEntry l_best{left_child_nidx, candidate.depth + 1};
+        CPUExpandEntry r_best{right_child_nidx, candidate.depth + 1};
         best_splits.push_back(l_best);
         best_splits.push_back(r_best);
       }
       auto const &histograms = histogram_builder_->Histogram();
       auto ft = p_fmat->Info().feature_types.ConstHostSpan();
-      for (auto const &gmat : p_fmat->GetBatches<GHistIndexMatrix>(HistBatch(param_))) {
-        evaluator_->EvaluateSplits(histograms, gmat.cut, ft, *p_tree, &best_splits);
-        break;
-      }
+      evaluator_->EvaluateSplits(histograms, cuts_, ft, *p_tree, &best_splits);
     }
     driver.Push(best_splits.begin(), best_splits.end());
     expand_set = driver.Pop();
   }
+  auto const &batch_stats = driver.BatchStats();
+  LOG(DEBUG) << "[QuantileHistMaker]: Expanded " << batch_stats.n_nodes << " nodes in "
+             << batch_stats.n_batches << " batches, largest batch: " << batch_stats.max_batch_size
+             << ", grouped batches: " << batch_stats.n_grouped;
+
+  monitor_->Start("FinalisePosition");
+  size_t page_id{0};
+  for (auto const &page : p_fmat->GetBatches<GHistIndexMatrix>(HistBatch(param_))) {
+    partitioner_.at(page_id).FinalisePosition(ctx_, page, tree);
+    ++page_id;
+  }
+  monitor_->Stop("FinalisePosition");
 
   auto &h_out_position = p_out_position->HostVector();
   this->LeafPartition(tree, gpair_h, &h_out_position);
@@ -259,28 +327,44 @@ void QuantileHistMaker::Builder::InitData(DMatrix *fmat, const RegTree &tree,
   const auto& info = fmat->Info();
 
   {
+    auto m_gpair = linalg::MakeTensorView(ctx_, *gpair, gpair->size(), static_cast<std::size_t>(1));
+    SampleGradient(ctx_, *param_, m_gpair);
+    // Rows dropped by sampling have empty gradient, exclude them from the partitioner so
+    // that they don't participate in histogram building.
+    bool const exclude_unsampled = param_->subsample < 1.0f && !fmat->IsColumnSplit();
+    common::Span<GradientPair const> s_gpair{*gpair};
+
     size_t page_id{0};
     int32_t n_total_bins{0};
     partitioner_.clear();
     for (auto const &page : fmat->GetBatches<GHistIndexMatrix>(HistBatch(param_))) {
       if (n_total_bins == 0) {
         n_total_bins = page.cut.TotalBins();
+        cuts_ = page.cut;
       } else {
         CHECK_EQ(n_total_bins, page.cut.TotalBins());
       }
-      partitioner_.emplace_back(this->ctx_, page.Size(), page.base_rowid, fmat->IsColumnSplit());
+      if (exclude_unsampled) {
+        partitioner_.emplace_back(this->ctx_, page.Size(), page.base_rowid,
+                                  s_gpair.subspan(page.base_rowid, page.Size()));
+      } else {
+        partitioner_.emplace_back(this->ctx_, page.Size(), page.base_rowid,
+                                  fmat->IsColumnSplit());
+      }
       ++page_id;
     }
     histogram_builder_->Reset(n_total_bins, HistBatch(param_), ctx_->Threads(), page_id,
                               collective::IsDistributed(), fmat->IsColumnSplit());
-
-    auto m_gpair = linalg::MakeTensorView(ctx_, *gpair, gpair->size(), static_cast<std::size_t>(1));
-    SampleGradient(ctx_, *param_, m_gpair);
+    histogram_builder_->ConfigureSync(*param_);
+    // Partitioning rows with column split requires synchronization for each page, which
+    // can not be interleaved with the histogram synchronization.
+    page_major_ = page_id > 1 && !fmat->IsColumnSplit();
   }
 
   // store a pointer to the tree
   p_last_tree_ = &tree;
   evaluator_.reset(new HistEvaluator<CPUExpandEntry>{ctx_, param_, info, column_sampler_});
+  histogram_builder_->SetFeaturePruner(evaluator_->Pruner());
 
   monitor_->Stop(__func__);
 }
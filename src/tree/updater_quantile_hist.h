@@ -94,6 +94,15 @@ class QuantileHistMaker: public TreeUpdater {
     void BuildHistogram(DMatrix* p_fmat, RegTree* p_tree,
                         std::vector<CPUExpandEntry> const& valid_candidates,
                         std::vector<GradientPair> const& gpair);
+    /**
+     * \brief Page-major scheduling for external memory.  Update the row partitions and
+     *        build the histograms of all nodes in a level in a single pass over the pages,
+     *        so that each page is loaded only once per level.
+     */
+    void UpdatePositionAndBuildHist(DMatrix* p_fmat, RegTree* p_tree,
+                                    std::vector<CPUExpandEntry> const& applied,
+                                    std::vector<CPUExpandEntry> const& valid_candidates,
+                                    std::vector<GradientPair> const& gpair);
 
     void LeafPartition(RegTree const& tree, common::Span<GradientPair const> gpair,
                        std::vector<bst_node_t>* p_out_position);
@@ -111,6 +120,10 @@ class QuantileHistMaker: public TreeUpdater {
 
     std::unique_ptr<HistEvaluator<CPUExpandEntry>> evaluator_;
     std::vector<CommonRowPartitioner> partitioner_;
+    // Histogram cuts shared by all pages, kept here to avoid loading a page for evaluation.
+    common::HistogramCuts cuts_;
+    // Whether to process all nodes of a level for one page before moving to the next one.
+    bool page_major_{false};
 
     // back pointers to tree and data matrix
     const RegTree* p_last_tree_{nullptr};
@@ -355,6 +355,19 @@ TEST(CAPI, XGBGlobalConfig) {
     ASSERT_NE(err.find("foo"), std::string::npos);
     ASSERT_EQ(err.find("verbosity"), std::string::npos);
   }
+  {
+    const char *config_str = R"json(
+    {
+      "ext_mem_page_format": "zip"
+    }
+  )json";
+    ret = XGBSetGlobalConfig(config_str);
+    ASSERT_EQ(ret, -1);
+    auto err = std::string{XGBGetLastError()};
+    ASSERT_NE(err.find("'zip'"), std::string::npos);
+    ASSERT_NE(err.find("'compressed', 'raw'"), std::string::npos);
+    ASSERT_EQ(GlobalConfigThreadLocalStore::Get()->ext_mem_page_format, "raw");
+  }
 }
 
 TEST(CAPI, BuildInfo) {
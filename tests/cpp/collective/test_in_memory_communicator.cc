@@ -4,7 +4,9 @@
 #include <dmlc/parameter.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <bitset>
+#include <cstdint>
 #include <thread>
 
 #include "../../../src/collective/in_memory_communicator.h"
@@ -92,6 +94,29 @@ class InMemoryCommunicatorTest : public ::testing::Test {
     EXPECT_EQ(actual, expected);
   }
 
+  static void AllreduceCustom(int rank) {
+    InMemoryCommunicator comm{kWorldSize, rank};
+    struct Range {
+      std::int32_t lower;
+      std::int32_t upper;
+    };
+    Range buffer[] = {{rank, rank}, {rank * 2, rank * 2}};
+    auto reducer = [](void const *src, void *dst, std::size_t count, std::size_t type_bytes) {
+      EXPECT_EQ(type_bytes, sizeof(Range));
+      auto const *lhs = static_cast<Range const *>(src);
+      auto *rhs = static_cast<Range *>(dst);
+      for (std::size_t i = 0; i < count; ++i) {
+        rhs[i].lower = std::min(lhs[i].lower, rhs[i].lower);
+        rhs[i].upper = std::max(lhs[i].upper, rhs[i].upper);
+      }
+    };
+    comm.AllReduceCustom(buffer, sizeof(Range), 2, reducer);
+    EXPECT_EQ(buffer[0].lower, 0);
+    EXPECT_EQ(buffer[0].upper, kWorldSize - 1);
+    EXPECT_EQ(buffer[1].lower, 0);
+    EXPECT_EQ(buffer[1].upper, (kWorldSize - 1) * 2);
+  }
+
   static void Broadcast(int rank) {
     InMemoryCommunicator comm{kWorldSize, rank};
     if (rank == 0) {
@@ -171,6 +196,8 @@ TEST_F(InMemoryCommunicatorTest, AllreduceBitwiseOR) { Verify(&AllreduceBitwiseO
 
 TEST_F(InMemoryCommunicatorTest, AllreduceBitwiseXOR) { Verify(&AllreduceBitwiseXOR); }
 
+TEST_F(InMemoryCommunicatorTest, AllreduceCustom) { Verify(&AllreduceCustom); }
+
 TEST_F(InMemoryCommunicatorTest, Broadcast) { Verify(&Broadcast); }
 
 }  // namespace collective
@@ -0,0 +1,96 @@
+/**
+ * Copyright 2023 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+
+#include <cstdint>  // for uint8_t, uint32_t, uint64_t, int64_t
+#include <limits>   // for numeric_limits
+#include <random>   // for mt19937, uniform_real_distribution
+#include <vector>   // for vector
+
+#include "../../../src/common/codec.h"
+
+namespace xgboost::common {
+TEST(Codec, Varint) {
+  std::vector<std::uint64_t> values{0, 1, 127, 128, 300, 1ul << 35,
+                                    std::numeric_limits<std::uint64_t>::max()};
+  std::vector<std::uint8_t> buf;
+  for (auto v : values) {
+    VarintEncode(v, &buf);
+  }
+  // 1 + 1 + 1 + 2 + 2 + 6 + 10
+  ASSERT_EQ(buf.size(), 23);
+  auto const* p = buf.data();
+  for (auto v : values) {
+    ASSERT_EQ(VarintDecode(&p, buf.data() + buf.size()), v);
+  }
+  ASSERT_EQ(p, buf.data() + buf.size());
+
+  for (std::int64_t v : {std::int64_t{0}, std::int64_t{-1}, std::int64_t{1}, std::int64_t{-64},
+                         std::numeric_limits<std::int64_t>::min(),
+                         std::numeric_limits<std::int64_t>::max()}) {
+    ASSERT_EQ(ZigZagDecode(ZigZagEncode(v)), v);
+  }
+  ASSERT_EQ(ZigZagEncode(-1), 1);
+  ASSERT_EQ(ZigZagEncode(1), 2);
+}
+
+TEST(Codec, ByteShuffle) {
+  std::vector<float> values(17);
+  std::mt19937 rng{0};
+  std::uniform_real_distribution<float> dist{-1.0f, 1.0f};
+  for (auto& v : values) {
+    v = dist(rng);
+  }
+  std::vector<std::uint8_t> shuffled(values.size() * sizeof(float));
+  ByteShuffle(Span<float const>{values}, shuffled.data());
+  std::vector<float> restored(values.size());
+  ByteUnshuffle(shuffled.data(), Span<float>{restored});
+  ASSERT_EQ(values, restored);
+}
+
+TEST(Codec, Rle) {
+  std::vector<std::uint8_t> data;
+  for (std::uint8_t i = 0; i < 3; ++i) {
+    data.push_back(i);
+  }
+  data.resize(data.size() + 1000, 7);
+  data.push_back(1);
+  data.push_back(1);
+
+  std::vector<std::uint8_t> encoded;
+  RleEncode(Span<std::uint8_t const>{data}, &encoded);
+  ASSERT_LT(encoded.size(), 16);
+
+  std::vector<std::uint8_t> decoded(data.size());
+  auto const* p = encoded.data();
+  RleDecode(&p, encoded.data() + encoded.size(), Span<std::uint8_t>{decoded});
+  ASSERT_EQ(p, encoded.data() + encoded.size());
+  ASSERT_EQ(data, decoded);
+
+  // empty input
+  encoded.clear();
+  RleEncode(Span<std::uint8_t const>{}, &encoded);
+  ASSERT_TRUE(encoded.empty());
+}
+
+TEST(Codec, BitPack) {
+  ASSERT_EQ(BitWidth(0), 0);
+  ASSERT_EQ(BitWidth(1), 1);
+  ASSERT_EQ(BitWidth(255), 8);
+  ASSERT_EQ(BitWidth(256), 9);
+
+  for (std::uint32_t n_bits : {0u, 1u, 3u, 8u, 13u, 32u}) {
+    std::vector<std::uint32_t> values(101);
+    std::uint64_t mask = (static_cast<std::uint64_t>(1) << n_bits) - 1;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      values[i] = static_cast<std::uint32_t>((i * 2654435761ul) & mask);
+    }
+    std::vector<std::uint8_t> packed(BitPackedBytes(values.size(), n_bits));
+    BitPack(Span<std::uint32_t const>{values}, n_bits, packed.data());
+    std::vector<std::uint32_t> unpacked(values.size());
+    BitUnpack(packed.data(), n_bits, Span<std::uint32_t>{unpacked});
+    ASSERT_EQ(values, unpacked) << "n_bits: " << n_bits;
+  }
+}
+}  // namespace xgboost::common
@@ -3,6 +3,8 @@
  */
 #include <gtest/gtest.h>
 
+#include <algorithm>  // std::reverse
+
 #include "../../../src/common/column_matrix.h"
 #include "../helpers.h"
 
@@ -105,5 +107,106 @@ TEST(DenseColumnWithMissing, Test) {
     });
   }
 }
+
+TEST(ColumnMatrix, MixedColumns) {
+  // Large enough for each thread to have rows away from the block boundary.
+  std::size_t constexpr kRows = 8192, kCols = 8;
+  auto dmat = RandomDataGenerator(kRows, kCols, 0.4).Seed(3).GenerateDMatrix();
+  // Close to the density of features, some columns are sparse and others are dense.
+  double sparse_thresh = 0.6;
+  GHistIndexMatrix gmat{dmat.get(), 256, sparse_thresh, false, AllThreadsForTest()};
+
+  auto check = [&](ColumnMatrix const& column_matrix) {
+    ASSERT_TRUE(column_matrix.AnyMissing());
+    for (bst_feature_t fidx = 0; fidx < kCols; ++fidx) {
+      DispatchBinType(column_matrix.GetTypeSize(), [&](auto dtype) {
+        using T = decltype(dtype);
+        if (column_matrix.GetColumnType(fidx) == kDenseColumn) {
+          auto col = column_matrix.DenseColumn<T, true>(fidx);
+          for (std::size_t i = 0; i < kRows; ++i) {
+            ASSERT_EQ(col[i], gmat.GetGindex(i, fidx));
+          }
+        } else {
+          auto col = column_matrix.SparseColumn<T>(fidx, 0);
+          std::size_t k = 0;
+          for (std::size_t i = 0; i < kRows; ++i) {
+            auto bin_idx = gmat.GetGindex(i, fidx);
+            if (bin_idx != Column<T>::kMissingId) {
+              ASSERT_EQ(col.GetRowIdx(k), i);
+              ASSERT_EQ(col.GetGlobalBinIdx(k), bin_idx);
+              ++k;
+            }
+          }
+          ASSERT_EQ(k, col.Size());
+        }
+      });
+    }
+  };
+
+  for (auto n_threads : {1, AllThreadsForTest()}) {
+    ColumnMatrix from_sparse;
+    for (auto const& page : dmat->GetBatches<SparsePage>()) {
+      from_sparse.InitFromSparse(page, gmat, sparse_thresh, n_threads);
+    }
+    check(from_sparse);
+
+    ColumnMatrix from_ghist{gmat, sparse_thresh};
+    from_ghist.InitFromGHist(n_threads, gmat);
+    check(from_ghist);
+  }
+  // Built on first access.
+  check(gmat.Transpose());
+}
+
+TEST(ColumnMatrix, UnsortedRows) {
+  std::size_t constexpr kRows = 1024, kCols = 8;
+  bst_bin_t constexpr kBins = 64;
+  auto dmat = RandomDataGenerator(kRows, kCols, 0.4).Seed(3).GenerateDMatrix();
+  double sparse_thresh = 0.6;
+  auto n_threads = AllThreadsForTest();
+  GHistIndexMatrix gmat{dmat.get(), kBins, sparse_thresh, false, n_threads};
+
+  // Same data with the entries of each row in reverse order, which is valid CSR input.
+  SparsePage unsorted;
+  for (auto const& page : dmat->GetBatches<SparsePage>()) {
+    unsorted.offset.HostVector() = page.offset.HostVector();
+    auto& h_data = unsorted.data.HostVector();
+    h_data = page.data.HostVector();
+    auto const& h_offset = unsorted.offset.HostVector();
+    for (std::size_t i = 0; i < kRows; ++i) {
+      std::reverse(h_data.begin() + h_offset[i], h_data.begin() + h_offset[i + 1]);
+    }
+  }
+  ASSERT_FALSE(unsorted.IsIndicesSorted(n_threads));
+  GHistIndexMatrix unsorted_gmat{unsorted, {}, gmat.cut, kBins, false, sparse_thresh, n_threads};
+
+  ColumnMatrix expected{gmat, sparse_thresh};
+  expected.InitFromGHist(n_threads, gmat);
+  ColumnMatrix from_ghist{unsorted_gmat, sparse_thresh};
+  from_ghist.InitFromGHist(n_threads, unsorted_gmat);
+
+  ASSERT_EQ(from_ghist.GetTypeSize(), expected.GetTypeSize());
+  for (bst_feature_t fidx = 0; fidx < kCols; ++fidx) {
+    ASSERT_EQ(from_ghist.GetColumnType(fidx), expected.GetColumnType(fidx));
+    DispatchBinType(expected.GetTypeSize(), [&](auto dtype) {
+      using T = decltype(dtype);
+      if (expected.GetColumnType(fidx) == kDenseColumn) {
+        auto col = from_ghist.DenseColumn<T, true>(fidx);
+        auto expected_col = expected.DenseColumn<T, true>(fidx);
+        for (std::size_t i = 0; i < kRows; ++i) {
+          ASSERT_EQ(col[i], expected_col[i]);
+        }
+      } else {
+        auto col = from_ghist.SparseColumn<T>(fidx, 0);
+        auto expected_col = expected.SparseColumn<T>(fidx, 0);
+        ASSERT_EQ(col.Size(), expected_col.Size());
+        for (std::size_t k = 0; k < col.Size(); ++k) {
+          ASSERT_EQ(col.GetRowIdx(k), expected_col.GetRowIdx(k));
+          ASSERT_EQ(col.GetGlobalBinIdx(k), expected_col.GetGlobalBinIdx(k));
+        }
+      }
+    });
+  }
+}
 }  // namespace common
 }  // namespace xgboost
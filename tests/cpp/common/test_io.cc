@@ -3,7 +3,9 @@
  */
 #include <gtest/gtest.h>
 
+#include <cstdint>  // for int32_t
 #include <fstream>
+#include <numeric>  // for iota
 
 #include "../../../src/common/io.h"
 #include "../helpers.h"
@@ -89,5 +91,35 @@ TEST(IO, LoadSequentialFile) {
 
   ASSERT_THROW(LoadSequentialFile("non-exist", true), dmlc::Error);
 }
+
+TEST(IO, MmapFile) {
+  if (!MmapFile::Supported()) {
+    GTEST_SKIP_("Memory mapped file is not supported on this platform.");
+  }
+  dmlc::TemporaryDirectory tempdir;
+  std::string path = tempdir.path + "/mmap";
+  std::vector<std::int32_t> data(8192);
+  std::iota(data.begin(), data.end(), 0);
+  {
+    std::unique_ptr<dmlc::Stream> fo{dmlc::Stream::Create(path.c_str(), "w")};
+    fo->Write(data.data(), data.size() * sizeof(std::int32_t));
+  }
+
+  MmapFile mmap{path};
+  ASSERT_EQ(mmap.Size(), data.size() * sizeof(std::int32_t));
+  // Read a range not aligned to the page size.
+  std::size_t offset = 13 * sizeof(std::int32_t), n = 4099;
+  mmap.WillNeed(offset, n * sizeof(std::int32_t));
+  auto fi = mmap.Stream(offset, n * sizeof(std::int32_t));
+  std::vector<std::int32_t> out(n);
+  ASSERT_EQ(fi.Read(out.data(), out.size() * sizeof(std::int32_t)), n * sizeof(std::int32_t));
+  for (std::size_t i = 0; i < n; ++i) {
+    ASSERT_EQ(out[i], i + 13);
+  }
+  // Released pages are loaded again on access.
+  mmap.DontNeed(offset, n * sizeof(std::int32_t));
+  ASSERT_EQ(reinterpret_cast<std::int32_t const *>(mmap.Data())[13], 13);
+  ASSERT_THROW({ MmapFile{tempdir.path + "/non-exist"}; }, dmlc::Error);
+}
 }  // namespace common
 }  // namespace xgboost
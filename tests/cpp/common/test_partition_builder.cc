@@ -1,4 +1,6 @@
 #include <gtest/gtest.h>
+#include <cstdint>
+#include <numeric>
 #include <vector>
 #include <string>
 #include <utility>
@@ -75,5 +77,50 @@ TEST(PartitionBuilder, BasicTest) {
   }
 }
 
+TEST(PartitionBuilder, Scatter) {
+  constexpr size_t kBlockSize = 16;
+  constexpr size_t kNodes = 3;
+  std::vector<size_t> tasks = {3, 1, 2};
+  size_t n_tasks = std::accumulate(tasks.cbegin(), tasks.cend(), static_cast<size_t>(0));
+
+  PartitionBuilder<kBlockSize> builder;
+  builder.Init(n_tasks, kNodes, [&](size_t i) { return tasks[i]; });
+
+  std::vector<std::vector<size_t>> rows(kNodes);
+  std::vector<std::vector<std::uint8_t>> decisions(kNodes);
+  for (size_t nid = 0; nid < kNodes; ++nid) {
+    rows[nid].resize(tasks[nid] * kBlockSize);
+    decisions[nid].resize(rows[nid].size());
+    std::iota(rows[nid].begin(), rows[nid].end(), 0);
+    // odd rows go left
+    for (size_t i = 0; i < rows[nid].size(); ++i) {
+      decisions[nid][i] = i % 2;
+    }
+    for (size_t j = 0; j < tasks[nid]; ++j) {
+      size_t begin = kBlockSize * j;
+      builder.SetNLeftElems(nid, begin, kBlockSize / 2);
+      builder.SetNRightElems(nid, begin, kBlockSize / 2);
+    }
+  }
+  builder.CalculateRowOffsets();
+
+  for (size_t nid = 0; nid < kNodes; ++nid) {
+    std::vector<size_t> out(rows[nid].size());
+    for (size_t j = 0; j < tasks[nid]; ++j) {
+      Range1d r{kBlockSize * j, kBlockSize * (j + 1)};
+      builder.ScatterToArray(
+          nid, r, rows[nid].data(),
+          Span<std::uint8_t const>{decisions[nid].data() + r.begin(), kBlockSize}, out.data());
+    }
+    size_t n_left = builder.GetNLeftElems(nid);
+    ASSERT_EQ(n_left, rows[nid].size() / 2);
+    // The partition is stable.
+    for (size_t i = 0; i < n_left; ++i) {
+      ASSERT_EQ(out[i], i * 2 + 1);
+      ASSERT_EQ(out[n_left + i], i * 2);
+    }
+  }
+}
+
 }  // namespace common
 }  // namespace xgboost
@@ -0,0 +1,50 @@
+/**
+ * Copyright 2023 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+
+#include <chrono>   // for microseconds
+#include <cstddef>  // for size_t
+#include <cstdint>  // for int32_t
+#include <future>   // for future
+#include <thread>   // for sleep_for
+#include <tuple>    // for ignore
+#include <vector>   // for vector
+
+#include "../../../src/common/threadpool.h"
+
+namespace xgboost::common {
+TEST(ThreadPool, Basic) {
+  std::int32_t constexpr kThreads = 3;
+  ThreadPool pool{kThreads};
+  ASSERT_EQ(pool.Size(), kThreads);
+
+  std::size_t constexpr kTasks = 64;
+  std::vector<std::future<std::size_t>> results;
+  for (std::size_t i = 0; i < kTasks; ++i) {
+    results.emplace_back(pool.Submit([i] {
+      std::this_thread::sleep_for(std::chrono::microseconds{10});
+      return i * 2;
+    }));
+  }
+  for (std::size_t i = 0; i < kTasks; ++i) {
+    ASSERT_EQ(results[i].get(), i * 2);
+  }
+
+  // Exceptions are propagated through the future.
+  auto fut = pool.Submit([]() -> std::int32_t { LOG(FATAL) << "Test error."; return 0; });
+  ASSERT_THROW(fut.get(), dmlc::Error);
+
+  // Tasks submitted before destruction are finished.
+  std::vector<std::int32_t> done(kTasks, 0);
+  {
+    ThreadPool local{kThreads};
+    for (std::size_t i = 0; i < kTasks; ++i) {
+      std::ignore = local.Submit([&done, i] { done[i] = 1; });
+    }
+  }
+  for (auto v : done) {
+    ASSERT_EQ(v, 1);
+  }
+}
+}  // namespace xgboost::common
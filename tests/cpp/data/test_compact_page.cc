@@ -0,0 +1,70 @@
+/**
+ * Copyright 2023 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+
+#include <cstddef>  // for size_t
+#include <cstdint>  // for uint32_t
+
+#include "../../../src/data/compact_page.h"
+#include "../helpers.h"  // for RandomDataGenerator
+#include "xgboost/data.h"
+
+namespace xgboost::data {
+namespace {
+void CheckEqual(SparsePage const& l, SparsePage const& r) {
+  ASSERT_EQ(l.base_rowid, r.base_rowid);
+  ASSERT_EQ(l.offset.ConstHostVector(), r.offset.ConstHostVector());
+  auto const& h_l = l.data.ConstHostVector();
+  auto const& h_r = r.data.ConstHostVector();
+  ASSERT_EQ(h_l.size(), h_r.size());
+  for (std::size_t i = 0; i < h_l.size(); ++i) {
+    ASSERT_EQ(h_l[i].index, h_r[i].index);
+    ASSERT_EQ(h_l[i].fvalue, h_r[i].fvalue);
+  }
+}
+}  // namespace
+
+TEST(CompactPage, RoundTrip) {
+  std::size_t n_samples{128};
+  auto n_threads = AllThreadsForTest();
+  for (bst_feature_t n_features : {16u, 300u, 70000u}) {
+    SparsePage page;
+    page.SetBaseRowId(3);
+    auto& h_offset = page.offset.HostVector();
+    auto& h_data = page.data.HostVector();
+    for (std::size_t i = 0; i < n_samples; ++i) {
+      for (bst_feature_t j = i % 7; j < n_features; j += 7 + i % 13) {
+        h_data.emplace_back(j, static_cast<float>(i) - static_cast<float>(j) / 2.0f);
+      }
+      h_offset.push_back(h_data.size());
+    }
+
+    CompactPage compact{page, n_features, n_threads};
+    ASSERT_EQ(compact.Size(), n_samples);
+    ASSERT_FALSE(compact.IsBinary());
+    ASSERT_EQ(compact.IndexBytes(), n_features <= 256 ? 1 : (n_features <= 65536 ? 2 : 4));
+    ASSERT_LT(compact.MemCostBytes(), page.MemCostBytes());
+
+    SparsePage out;
+    compact.Decode(n_threads, &out);
+    CheckEqual(page, out);
+
+    // Binary data doesn't store values.
+    for (auto& e : h_data) {
+      e.fvalue = 1.0f;
+    }
+    CompactPage binary{page, n_features, n_threads};
+    ASSERT_TRUE(binary.IsBinary());
+    ASSERT_LE(binary.MemCostBytes() * 2, page.MemCostBytes());
+    binary.Decode(n_threads, &out);
+    CheckEqual(page, out);
+  }
+
+  // Feature index out of range.
+  SparsePage page;
+  page.data.HostVector().emplace_back(8, 1.0f);
+  page.offset.HostVector().push_back(1);
+  ASSERT_THROW((CompactPage{page, 8, n_threads}), dmlc::Error);
+}
+}  // namespace xgboost::data
@@ -133,6 +133,37 @@ TEST(GradientIndex, PushBatch) {
   test(0.9f);
 }
 
+TEST(GradientIndex, Finalize) {
+  // Enough entries for the bins to be compressed in multiple blocks.
+  size_t constexpr kRows = 16411, kCols = 64;
+  float st = 0.5;
+  auto m = RandomDataGenerator{kRows, kCols, 0.0}.GenerateDMatrix();
+  for (bst_bin_t max_bins : {16, 300}) {
+    auto cuts = common::SketchOnDMatrix(m.get(), max_bins, AllThreadsForTest(), false, {});
+    GHistIndexMatrix gmat{MetaInfo{}, common::HistogramCuts{cuts}, max_bins};
+    // Push with the sparse layout as the number of rows is unknown.
+    gmat.SetDense(false);
+    for (auto const &page : m->GetBatches<SparsePage>()) {
+      SparsePageAdapterBatch batch{page.GetView()};
+      gmat.row_ptr.resize(page.Size() + 1);
+      gmat.PushAdapterBatch(m->Ctx(), 0, 0, batch, std::numeric_limits<float>::quiet_NaN(), {}, st,
+                            std::numeric_limits<std::size_t>::max());
+    }
+    ASSERT_EQ(gmat.index.GetBinTypeSize(), common::kUint32BinsTypeSize);
+    gmat.Finalize(m->Ctx(), st);
+    ASSERT_TRUE(gmat.IsDense());
+
+    for (auto const &page : m->GetBatches<SparsePage>()) {
+      GHistIndexMatrix expected{page, {}, cuts, max_bins, true, st, AllThreadsForTest()};
+      ASSERT_EQ(gmat.index.GetBinTypeSize(), expected.index.GetBinTypeSize());
+      ASSERT_EQ(gmat.index.Size(), expected.index.Size());
+      for (size_t i = 0; i < expected.index.Size(); ++i) {
+        ASSERT_EQ(gmat.index[i], expected.index[i]);
+      }
+    }
+  }
+}
+
 #if defined(XGBOOST_USE_CUDA)
 
 namespace {
@@ -4,26 +4,30 @@
 #include <gtest/gtest.h>
 
 #include "../../../src/common/column_matrix.h"
+#include "../../../src/common/io.h"  // for LoadSequentialFile
 #include "../../../src/data/gradient_index.h"
 #include "../../../src/data/sparse_page_source.h"
 #include "../helpers.h"
 
 namespace xgboost {
 namespace data {
-TEST(GHistIndexPageRawFormat, IO) {
+namespace {
+void TestGHistIndexPageFormat(std::string name, float sparsity) {
   std::unique_ptr<SparsePageFormat<GHistIndexMatrix>> format{
-      CreatePageFormat<GHistIndexMatrix>("raw")};
-  auto m = RandomDataGenerator{100, 14, 0.5}.GenerateDMatrix();
+      CreatePageFormat<GHistIndexMatrix>(name)};
+  auto m = RandomDataGenerator{100, 14, sparsity}.GenerateDMatrix();
   dmlc::TemporaryDirectory tmpdir;
   std::string path = tmpdir.path + "/ghistindex.page";
   auto batch = BatchParam{256, 0.5};
+  std::size_t n_bytes{0};
 
   {
     std::unique_ptr<dmlc::Stream> fo{dmlc::Stream::Create(path.c_str(), "w")};
     for (auto const &index : m->GetBatches<GHistIndexMatrix>(batch)) {
-      format->Write(index, fo.get());
+      n_bytes += format->Write(index, fo.get());
     }
   }
+  ASSERT_EQ(n_bytes, common::LoadSequentialFile(path).size());
 
   GHistIndexMatrix page;
   std::unique_ptr<dmlc::SeekStream> fi{dmlc::SeekStream::CreateForRead(path.c_str())};
@@ -40,8 +44,65 @@ TEST(GHistIndexPageRawFormat, IO) {
     ASSERT_TRUE(std::equal(loaded.index.Offset(), loaded.index.Offset() + loaded.index.OffsetSize(),
                            page.index.Offset()));
 
+    ASSERT_EQ(loaded.row_ptr, page.row_ptr);
+    ASSERT_EQ(loaded.hit_count, page.hit_count);
+    ASSERT_EQ(loaded.index.GetBinTypeSize(), page.index.GetBinTypeSize());
+
     ASSERT_EQ(loaded.Transpose().GetTypeSize(), loaded.Transpose().GetTypeSize());
   }
 }
+}  // namespace
+
+TEST(GHistIndexPageRawFormat, IO) { TestGHistIndexPageFormat("raw", 0.5); }
+
+TEST(GHistIndexPageRawFormat, Mapped) {
+  if (!common::MmapFile::Supported()) {
+    GTEST_SKIP() << "Memory mapping is not supported.";
+  }
+  std::unique_ptr<SparsePageFormat<GHistIndexMatrix>> format{
+      CreatePageFormat<GHistIndexMatrix>("raw")};
+  auto m = RandomDataGenerator{100, 14, 0.0}.GenerateDMatrix();
+  dmlc::TemporaryDirectory tmpdir;
+  std::string path = tmpdir.path + "/ghistindex.page";
+  auto batch = BatchParam{256, 0.5};
+  auto const &expected = *m->GetBatches<GHistIndexMatrix>(batch).begin();
+
+  // The second page starts at an offset that isn't aligned.
+  std::size_t n_bytes{0};
+  {
+    std::unique_ptr<dmlc::Stream> fo{dmlc::Stream::Create(path.c_str(), "w")};
+    n_bytes = format->Write(expected, fo.get());
+    fo->Write(std::uint8_t{0});
+    format->Write(expected, fo.get());
+  }
+  auto mmap = std::make_shared<common::MmapFile>(path);
+  for (std::size_t offset : {std::size_t{0}, n_bytes + 1}) {
+    GHistIndexMatrix page;
+    ASSERT_TRUE(format->ReadMapped(&page, mmap, offset, n_bytes));
+    auto const &index = page.index;
+    ASSERT_EQ(index.IsView(), offset == 0);
+    if (index.IsView()) {
+      ASSERT_GE(index.begin(), reinterpret_cast<std::uint8_t const *>(mmap->Data()));
+      ASSERT_LE(index.end(),
+                reinterpret_cast<std::uint8_t const *>(mmap->Data()) + mmap->Size());
+    }
+    ASSERT_EQ(page.row_ptr, expected.row_ptr);
+    ASSERT_EQ(index.GetBinTypeSize(), expected.index.GetBinTypeSize());
+    ASSERT_TRUE(
+        std::equal(expected.index.begin(), expected.index.end(), index.begin(), index.end()));
+    for (std::size_t i = 0; i < expected.index.Size(); ++i) {
+      ASSERT_EQ(index[i], expected.index[i]);
+    }
+    // The bins are copied before modification.
+    page.index.data<std::uint8_t>()[0] += 1;
+    ASSERT_FALSE(page.index.IsView());
+    ASSERT_EQ(page.index.Size(), expected.index.Size());
+  }
+}
+
+TEST(GHistIndexPageCompressedFormat, IO) {
+  TestGHistIndexPageFormat("compressed", 0.5);
+  TestGHistIndexPageFormat("compressed", 0.0);
+}
 } // namespace data
 } // namespace xgboost
@@ -4,11 +4,19 @@
 #include "test_iterative_dmatrix.h"
 
 #include <gtest/gtest.h>
+
+#include <cmath>    // for isnan
+#include <cstdint>  // for uint8_t, int64_t
 #include <limits>
 #include <memory>
+#include <string>   // for string
+#include <vector>   // for vector
 
+#include "../../../src/common/column_matrix.h"
 #include "../../../src/data/gradient_index.h"
 #include "../../../src/data/iterative_dmatrix.h"
+#include "../../../src/tree/param.h"  // for TrainParam
+#include "../filesystem.h"            // for TemporaryDirectory
 #include "../helpers.h"
 #include "xgboost/data.h"  // DMatrix
 
@@ -37,5 +45,233 @@ TEST(IterativeDMatrix, IsDense) {
   test(0.1);
   test(1.0);
 }
+
+TEST(IterativeDMatrix, SaveLoad) {
+  dmlc::TemporaryDirectory tmpdir;
+  auto path = tmpdir.path + "/quantile.buffer";
+  auto n_bins = 16;
+  for (float sparsity : {0.0f, 0.4f}) {
+    NumpyArrayIterForTest iter(sparsity);
+    IterativeDMatrix m(&iter, iter.Proxy(), nullptr, Reset, Next,
+                       std::numeric_limits<float>::quiet_NaN(), 0, n_bins);
+    m.SaveToLocalFile(path);
+
+    std::unique_ptr<DMatrix> loaded{DMatrix::Load(path)};
+    ASSERT_TRUE(dynamic_cast<IterativeDMatrix*>(loaded.get()));
+    ASSERT_EQ(loaded->Info().num_row_, m.Info().num_row_);
+    ASSERT_EQ(loaded->Info().num_col_, m.Info().num_col_);
+    ASSERT_EQ(loaded->Info().num_nonzero_, m.Info().num_nonzero_);
+    ASSERT_EQ(loaded->IsDense(), m.IsDense());
+
+    BatchParam param{n_bins, tree::TrainParam::DftSparseThreshold()};
+    for (auto const& expected : m.GetBatches<GHistIndexMatrix>(param)) {
+      for (auto const& page : loaded->GetBatches<GHistIndexMatrix>(param)) {
+        ASSERT_EQ(page.cut.Values(), expected.cut.Values());
+        ASSERT_EQ(page.cut.Ptrs(), expected.cut.Ptrs());
+        ASSERT_EQ(page.cut.MinValues(), expected.cut.MinValues());
+        ASSERT_EQ(page.row_ptr, expected.row_ptr);
+        ASSERT_EQ(page.hit_count, expected.hit_count);
+        ASSERT_EQ(page.IsDense(), expected.IsDense());
+        ASSERT_TRUE(std::equal(page.index.begin(), page.index.end(), expected.index.begin()));
+        for (std::size_t i = 0; i < page.Size(); ++i) {
+          for (bst_feature_t j = 0; j < page.Features(); ++j) {
+            ASSERT_EQ(page.GetGindex(i, j), expected.GetGindex(i, j));
+          }
+        }
+        auto const& columns = page.Transpose();
+        auto const& expected_columns = expected.Transpose();
+        ASSERT_EQ(columns.GetTypeSize(), expected_columns.GetTypeSize());
+        ASSERT_EQ(columns.AnyMissing(), expected_columns.AnyMissing());
+      }
+    }
+  }
+}
+namespace {
+/**
+ * \brief Same data as the numpy iterator, but each batch is passed as a list of columns
+ *        with validity masks, which is the layout of Arrow record batches.  With more
+ *        than 1 chunk, the rows of each batch are split like the chunks of an Arrow table.
+ */
+class ColumnarIterForTest : public NumpyArrayIterForTest {
+  std::vector<std::vector<float>> values_;
+  std::vector<std::vector<std::uint8_t>> masks_;
+  std::vector<std::string> columnar_;
+
+  Json MakeColumns(std::size_t batch, std::size_t begin, std::size_t end) {
+    auto const& h_data = data_.ConstHostVector();
+    auto n = end - begin;
+    Json jcolumns{Array{}};
+    for (std::size_t j = 0; j < cols_; ++j) {
+      auto& values = values_.emplace_back(n);
+      auto& mask = masks_.emplace_back((n + 7) / 8, 0);
+      for (std::size_t i = 0; i < n; ++i) {
+        auto v = h_data[batch * rows_ * cols_ + (begin + i) * cols_ + j];
+        if (std::isnan(v)) {
+          // Masked value should be ignored.
+          values[i] = 1024.0f;
+        } else {
+          values[i] = v;
+          mask[i / 8] |= static_cast<std::uint8_t>(1 << (i % 8));
+        }
+      }
+      auto jcol = linalg::ArrayInterface(linalg::MakeVec(values.data(), values.size()));
+      Json jmask{Object{}};
+      auto ptr = reinterpret_cast<std::int64_t>(mask.data());
+      jmask["data"] = std::vector<Json>{Json{Integer{ptr}}, Json{Boolean{true}}};
+      jmask["shape"] = std::vector<Json>{Json{Integer{static_cast<std::int64_t>(n)}}};
+      jmask["typestr"] = String{"|t1"};
+      jmask["version"] = Integer{3};
+      jcol["mask"] = jmask;
+      get<Array>(jcolumns).emplace_back(jcol);
+    }
+    return jcolumns;
+  }
+
+ public:
+  explicit ColumnarIterForTest(float sparsity, std::size_t rows, std::size_t batches,
+                               std::size_t n_chunks = 1)
+      : NumpyArrayIterForTest{sparsity, rows, Cols(), batches} {
+    values_.reserve(cols_ * n_batches_ * n_chunks);
+    masks_.reserve(cols_ * n_batches_ * n_chunks);
+    for (std::size_t b = 0; b < n_batches_; ++b) {
+      Json jbatch;
+      if (n_chunks == 1) {
+        jbatch = MakeColumns(b, 0, rows_);
+      } else {
+        // Chunks of uneven sizes, the last one takes the remaining rows.
+        jbatch = Json{Array{}};
+        std::size_t begin = 0;
+        for (std::size_t c = 0; c < n_chunks; ++c) {
+          auto end =
+              c + 1 == n_chunks ? rows_ : std::min(rows_, begin + rows_ / (2 * n_chunks) + c);
+          get<Array>(jbatch).emplace_back(MakeColumns(b, begin, end));
+          begin = end;
+        }
+      }
+      std::string str;
+      Json::Dump(jbatch, &str);
+      columnar_.emplace_back(std::move(str));
+    }
+  }
+
+  int Next() override {
+    if (iter_ == n_batches_) {
+      return 0;
+    }
+    XGProxyDMatrixSetDataColumnar(proxy_, columnar_[iter_].c_str());
+    iter_++;
+    return 1;
+  }
+};
+}  // anonymous namespace
+
+TEST(IterativeDMatrix, Columnar) {
+  auto n_bins = 16;
+  for (float sparsity : {0.0f, 0.4f}) {
+    NumpyArrayIterForTest iter{sparsity, 256, NumpyArrayIterForTest::Cols(), 4};
+    IterativeDMatrix expected(&iter, iter.Proxy(), nullptr, Reset, Next,
+                              std::numeric_limits<float>::quiet_NaN(), 0, n_bins);
+    // A single contiguous chunk and chunked columns.
+    for (std::size_t n_chunks : {1, 3}) {
+      ColumnarIterForTest columnar_iter{sparsity, 256, 4, n_chunks};
+      IterativeDMatrix m(&columnar_iter, columnar_iter.Proxy(), nullptr, Reset, Next,
+                         std::numeric_limits<float>::quiet_NaN(), 0, n_bins);
+      ASSERT_EQ(m.Info().num_row_, expected.Info().num_row_);
+      ASSERT_EQ(m.Info().num_col_, expected.Info().num_col_);
+      ASSERT_EQ(m.Info().num_nonzero_, expected.Info().num_nonzero_);
+
+      BatchParam param{n_bins, tree::TrainParam::DftSparseThreshold()};
+      for (auto const& expected_page : expected.GetBatches<GHistIndexMatrix>(param)) {
+        for (auto const& page : m.GetBatches<GHistIndexMatrix>(param)) {
+          ASSERT_EQ(page.cut.Values(), expected_page.cut.Values());
+          ASSERT_EQ(page.cut.Ptrs(), expected_page.cut.Ptrs());
+          ASSERT_EQ(page.row_ptr, expected_page.row_ptr);
+          ASSERT_EQ(page.hit_count, expected_page.hit_count);
+          for (std::size_t i = 0; i < page.Size(); ++i) {
+            for (bst_feature_t j = 0; j < page.Features(); ++j) {
+              ASSERT_EQ(page.GetGindex(i, j), expected_page.GetGindex(i, j));
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+namespace {
+class CountingIterForTest : public NumpyArrayIterForTest {
+ public:
+  std::size_t n_calls{0};
+
+  using NumpyArrayIterForTest::NumpyArrayIterForTest;
+  int Next() override {
+    ++n_calls;
+    return NumpyArrayIterForTest::Next();
+  }
+};
+
+void CheckSameIndex(GHistIndexMatrix const& page, GHistIndexMatrix const& expected) {
+  ASSERT_EQ(page.cut.Values(), expected.cut.Values());
+  ASSERT_EQ(page.cut.Ptrs(), expected.cut.Ptrs());
+  ASSERT_EQ(page.IsDense(), expected.IsDense());
+  ASSERT_EQ(page.row_ptr, expected.row_ptr);
+  ASSERT_EQ(page.hit_count, expected.hit_count);
+  ASSERT_EQ(page.index.GetBinTypeSize(), expected.index.GetBinTypeSize());
+  for (std::size_t i = 0; i < page.Size(); ++i) {
+    for (bst_feature_t j = 0; j < page.Features(); ++j) {
+      ASSERT_EQ(page.GetGindex(i, j), expected.GetGindex(i, j));
+    }
+  }
+  auto const& columns = page.Transpose();
+  auto const& expected_columns = expected.Transpose();
+  ASSERT_EQ(columns.GetTypeSize(), expected_columns.GetTypeSize());
+  ASSERT_EQ(columns.AnyMissing(), expected_columns.AnyMissing());
+}
+}  // anonymous namespace
+
+TEST(IterativeDMatrix, SinglePass) {
+  auto n_bins = 16;
+  std::size_t constexpr kRows = 256, kBatches = 4;
+  auto constexpr kCols = NumpyArrayIterForTest::Cols();
+  auto missing = std::numeric_limits<float>::quiet_NaN();
+  BatchParam param{n_bins, tree::TrainParam::DftSparseThreshold()};
+
+  for (float sparsity : {0.0f, 0.4f}) {
+    NumpyArrayIterForTest iter{sparsity, kRows, kCols, kBatches};
+    IterativeDMatrix expected(&iter, iter.Proxy(), nullptr, Reset, Next, missing, 0, n_bins);
+
+    // The whole dataset fits in the buffer, same result as iterating multiple times.
+    CountingIterForTest full_iter{sparsity, kRows, kCols, kBatches};
+    IterativeDMatrix m(&full_iter, full_iter.Proxy(), nullptr, Reset, Next, missing, 0, n_bins,
+                       std::numeric_limits<std::size_t>::max());
+    ASSERT_EQ(full_iter.n_calls, kBatches + 1);
+    ASSERT_EQ(m.Info().num_row_, expected.Info().num_row_);
+    ASSERT_EQ(m.Info().num_col_, expected.Info().num_col_);
+    ASSERT_EQ(m.Info().num_nonzero_, expected.Info().num_nonzero_);
+    ASSERT_EQ(m.IsDense(), expected.IsDense());
+    for (auto const& expected_page : expected.GetBatches<GHistIndexMatrix>(param)) {
+      for (auto const& page : m.GetBatches<GHistIndexMatrix>(param)) {
+        CheckSameIndex(page, expected_page);
+      }
+    }
+
+    // Only the first batch is buffered, the cuts are sketched from it.
+    CountingIterForTest partial_iter{sparsity, kRows, kCols, kBatches};
+    auto p_partial = std::make_shared<IterativeDMatrix>(
+        &partial_iter, partial_iter.Proxy(), nullptr, Reset, Next, missing, 0, n_bins, 1);
+    ASSERT_EQ(partial_iter.n_calls, kBatches + 1);
+    ASSERT_EQ(p_partial->Info().num_row_, expected.Info().num_row_);
+    ASSERT_EQ(p_partial->Info().num_nonzero_, expected.Info().num_nonzero_);
+    // Same as quantizing all the data with the cuts.
+    NumpyArrayIterForTest ref_iter{sparsity, kRows, kCols, kBatches};
+    IterativeDMatrix with_ref(&ref_iter, ref_iter.Proxy(), p_partial, Reset, Next, missing, 0,
+                              n_bins);
+    for (auto const& expected_page : with_ref.GetBatches<GHistIndexMatrix>(param)) {
+      for (auto const& page : p_partial->GetBatches<GHistIndexMatrix>(param)) {
+        CheckSameIndex(page, expected_page);
+      }
+    }
+  }
+}
 }  // namespace data
 }  // namespace xgboost
@@ -0,0 +1,104 @@
+/**
+ * Copyright 2023 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+
+#include <cmath>    // for isnan
+#include <cstddef>  // for size_t
+#include <cstdint>  // for int32_t
+#include <memory>   // for shared_ptr
+#include <vector>   // for vector
+
+#include "../../../src/data/gradient_index.h"      // for GHistIndexMatrix
+#include "../../../src/data/row_subset_dmatrix.h"  // for RowSubsetDMatrix
+#include "../helpers.h"                            // for RandomDataGenerator
+
+namespace xgboost::data {
+namespace {
+void CheckRowSubset(float sparsity) {
+  std::size_t constexpr kRows{128}, kCols{10};
+  bst_bin_t constexpr kBins{16};
+  auto p_fmat = RandomDataGenerator{kRows, kCols, sparsity}.GenerateDMatrix(true);
+  std::vector<std::int32_t> ridx;
+  for (std::size_t i = 0; i < kRows; i += 3) {
+    ridx.push_back(static_cast<std::int32_t>(kRows - i - 1));
+  }
+  auto p_view = std::make_shared<RowSubsetDMatrix>(p_fmat, ridx);
+  std::shared_ptr<DMatrix> p_sliced{p_fmat->Slice(ridx)};
+
+  auto const& info = p_view->Info();
+  ASSERT_EQ(info.num_row_, ridx.size());
+  ASSERT_EQ(info.num_col_, kCols);
+  ASSERT_EQ(info.num_nonzero_, p_sliced->Info().num_nonzero_);
+  ASSERT_EQ(info.labels.Data()->HostVector(), p_sliced->Info().labels.Data()->HostVector());
+
+  for (auto const& expected : p_sliced->GetBatches<SparsePage>()) {
+    for (auto const& page : p_view->GetBatches<SparsePage>()) {
+      ASSERT_EQ(page.offset.HostVector(), expected.offset.HostVector());
+      auto const& h_data = page.data.HostVector();
+      auto const& h_expected = expected.data.HostVector();
+      ASSERT_EQ(h_data.size(), h_expected.size());
+      for (std::size_t i = 0; i < h_data.size(); ++i) {
+        ASSERT_EQ(h_data[i].index, h_expected[i].index);
+        ASSERT_EQ(h_data[i].fvalue, h_expected[i].fvalue);
+      }
+    }
+  }
+
+  // The gradient index is the same as quantizing the sliced data with the parent's cuts.
+  BatchParam param{kBins, 0.2};
+  Context ctx;
+  for (auto const& parent : p_fmat->GetBatches<GHistIndexMatrix>(param)) {
+    for (auto const& page : p_sliced->GetBatches<SparsePage>()) {
+      GHistIndexMatrix expected{page,
+                                p_sliced->Info().feature_types.ConstHostSpan(),
+                                parent.cut,
+                                kBins,
+                                parent.IsDense(),
+                                param.sparse_thresh,
+                                ctx.Threads()};
+      for (auto const& gidx : p_view->GetBatches<GHistIndexMatrix>(param)) {
+        ASSERT_EQ(gidx.cut.Values(), parent.cut.Values());
+        ASSERT_EQ(gidx.IsDense(), parent.IsDense());
+        ASSERT_EQ(gidx.row_ptr, expected.row_ptr);
+        ASSERT_EQ(gidx.hit_count, expected.hit_count);
+        ASSERT_EQ(gidx.index.Size(), expected.index.Size());
+        for (std::size_t i = 0; i < expected.index.Size(); ++i) {
+          ASSERT_EQ(gidx.index[i], expected.index[i]);
+        }
+        for (std::size_t i = 0; i < ridx.size(); ++i) {
+          for (bst_feature_t f = 0; f < kCols; ++f) {
+            ASSERT_EQ(gidx.GetGindex(i, f), parent.GetGindex(ridx[i], f));
+            auto v = gidx.GetFvalue(i, f, false);
+            auto expected_v = expected.GetFvalue(i, f, false);
+            if (std::isnan(expected_v)) {
+              ASSERT_TRUE(std::isnan(v));
+            } else {
+              ASSERT_EQ(v, expected_v);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // Slicing a view refers to the same parent.
+  std::vector<std::int32_t> sub{0, 2, 4};
+  std::unique_ptr<DMatrix> p_sub{p_view->Slice(sub)};
+  auto* sub_view = dynamic_cast<RowSubsetDMatrix*>(p_sub.get());
+  ASSERT_TRUE(sub_view);
+  ASSERT_EQ(sub_view->Parent(), p_fmat);
+  for (std::size_t i = 0; i < sub.size(); ++i) {
+    ASSERT_EQ(sub_view->RowIndex()[i], ridx[sub[i]]);
+  }
+  ASSERT_EQ(sub_view->Info().num_row_, sub.size());
+
+  std::vector<std::int32_t> invalid{static_cast<std::int32_t>(kRows)};
+  ASSERT_THROW({ RowSubsetDMatrix(p_fmat, invalid); }, dmlc::Error);
+}
+}  // namespace
+
+TEST(RowSubsetDMatrix, Dense) { CheckRowSubset(0.0); }
+
+TEST(RowSubsetDMatrix, Sparse) { CheckRowSubset(0.4); }
+}  // namespace xgboost::data
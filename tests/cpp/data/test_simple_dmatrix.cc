@@ -4,10 +4,13 @@
 #include <xgboost/data.h>
 
 #include <array>   // std::array
+#include <cmath>   // std::isnan
 #include <limits>  // std::numeric_limits
 #include <memory>  // std::unique_ptr
+#include <vector>  // std::vector
 
 #include "../../../src/data/adapter.h"         // ArrayAdapter
+#include "../../../src/data/gradient_index.h"  // GHistIndexMatrix
 #include "../../../src/data/simple_dmatrix.h"  // SimpleDMatrix
 #include "../filesystem.h"                     // dmlc::TemporaryDirectory
 #include "../helpers.h"                        // RandomDataGenerator,CreateSimpleTestData
@@ -423,3 +426,137 @@ TEST(SimpleDMatrix, Threads) {
       DMatrix::Create(&adapter, std::numeric_limits<float>::quiet_NaN(), 0, "")};
   ASSERT_EQ(p_fmat->Ctx()->Threads(), AllThreadsForTest());
 }
+
+TEST(SimpleDMatrix, AppendDropPrefix) {
+  size_t constexpr kRows{64};
+  size_t constexpr kCols{8};
+  size_t constexpr kDropped{kRows / 4};
+  bst_bin_t constexpr kBins{16};
+  double constexpr kSparseThresh{0.2};
+  // density of the existing rows and the appended rows, the last one changes the layout of
+  // gradient index.
+  std::array<std::array<float, 2>, 3> sparsity{{{0.0f, 0.0f}, {0.3f, 0.3f}, {0.0f, 0.3f}}};
+  for (auto [s_old, s_new] : sparsity) {
+    auto p_fmat = RandomDataGenerator{kRows, kCols, s_old}.Seed(0).GenerateDMatrix(true);
+    auto p_new = RandomDataGenerator{kRows / 2, kCols, s_new}.Seed(1).GenerateDMatrix(true);
+    BatchParam param{kBins, kSparseThresh};
+    common::HistogramCuts cuts;
+    for (auto const& page : p_fmat->GetBatches<GHistIndexMatrix>(param)) {
+      cuts = page.cut;
+    }
+    std::vector<Entry> first_kept;
+    for (auto const& page : p_fmat->GetBatches<SparsePage>()) {
+      auto inst = page.GetView()[kDropped];
+      first_kept.assign(inst.cbegin(), inst.cend());
+    }
+
+    p_fmat->Append(p_new.get());
+    p_fmat->DropPrefix(kDropped);
+    auto n_rows = kRows + kRows / 2 - kDropped;
+    ASSERT_EQ(p_fmat->Info().num_row_, n_rows);
+    ASSERT_EQ(p_fmat->Info().num_col_, kCols);
+    ASSERT_EQ(p_fmat->Info().labels.Size(), n_rows);
+    ASSERT_EQ(p_fmat->NumDroppedRows(), kDropped);
+
+    for (auto const& page : p_fmat->GetBatches<SparsePage>()) {
+      ASSERT_EQ(page.Size(), n_rows);
+      ASSERT_EQ(p_fmat->Info().num_nonzero_, page.data.Size());
+      auto inst = page.GetView()[0];
+      ASSERT_EQ(inst.size(), first_kept.size());
+      for (size_t i = 0; i < inst.size(); ++i) {
+        ASSERT_EQ(inst[i].index, first_kept[i].index);
+        ASSERT_EQ(inst[i].fvalue, first_kept[i].fvalue);
+      }
+
+      // Same as quantizing the remaining rows with the original cuts.
+      GHistIndexMatrix expected{page, {}, cuts, kBins, p_fmat->IsDense(), kSparseThresh,
+                                AllThreadsForTest()};
+      for (auto const& gidx : p_fmat->GetBatches<GHistIndexMatrix>(param)) {
+        ASSERT_EQ(gidx.IsDense(), p_fmat->IsDense());
+        ASSERT_EQ(gidx.row_ptr, expected.row_ptr);
+        ASSERT_EQ(gidx.hit_count, expected.hit_count);
+        ASSERT_EQ(gidx.cut.Values(), cuts.Values());
+        for (size_t i = 0; i < n_rows; ++i) {
+          for (bst_feature_t j = 0; j < kCols; ++j) {
+            ASSERT_EQ(gidx.GetGindex(i, j), expected.GetGindex(i, j));
+            auto fvalue = gidx.GetFvalue(i, j, false);
+            auto expected_fvalue = expected.GetFvalue(i, j, false);
+            if (std::isnan(expected_fvalue)) {
+              ASSERT_TRUE(std::isnan(fvalue));
+            } else {
+              ASSERT_EQ(fvalue, expected_fvalue);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // Groups are dropped as a whole.
+  auto p_fmat = RandomDataGenerator{kRows, kCols, 0.0}.GenerateDMatrix(true);
+  p_fmat->Info().group_ptr_ = {0, 10, 40, kRows};
+  ASSERT_THROW(p_fmat->DropPrefix(kDropped), dmlc::Error);
+  p_fmat->DropPrefix(10);
+  ASSERT_EQ(p_fmat->Info().group_ptr_, (std::vector<bst_group_t>{0, 30, kRows - 10}));
+}
+
+TEST(SimpleDMatrix, Compact) {
+  size_t constexpr kRows{64};
+  size_t constexpr kCols{8};
+  auto p_fmat = RandomDataGenerator{kRows, kCols, 0.3}.GenerateDMatrix(true);
+  auto p_compact = RandomDataGenerator{kRows, kCols, 0.3}.GenerateDMatrix(true);
+  auto* simple = dynamic_cast<data::SimpleDMatrix*>(p_compact.get());
+  ASSERT_TRUE(simple);
+  simple->Compact();
+  ASSERT_TRUE(simple->IsCompact());
+
+  auto check = [&] {
+    for (auto const& expected : p_fmat->GetBatches<SparsePage>()) {
+      for (auto const& page : p_compact->GetBatches<SparsePage>()) {
+        ASSERT_EQ(page.offset.HostVector(), expected.offset.HostVector());
+        auto const& h_data = page.data.HostVector();
+        auto const& h_expected = expected.data.HostVector();
+        ASSERT_EQ(h_data.size(), h_expected.size());
+        for (size_t i = 0; i < h_data.size(); ++i) {
+          ASSERT_EQ(h_data[i].index, h_expected[i].index);
+          ASSERT_EQ(h_data[i].fvalue, h_expected[i].fvalue);
+        }
+      }
+    }
+  };
+  check();
+
+  // Derived pages are the same.
+  BatchParam param{16, 0.2};
+  for (auto const& expected : p_fmat->GetBatches<GHistIndexMatrix>(param)) {
+    for (auto const& gidx : p_compact->GetBatches<GHistIndexMatrix>(param)) {
+      ASSERT_EQ(gidx.cut.Values(), expected.cut.Values());
+      ASSERT_EQ(gidx.row_ptr, expected.row_ptr);
+      ASSERT_EQ(gidx.hit_count, expected.hit_count);
+    }
+  }
+  for (auto const& expected : p_fmat->GetBatches<CSCPage>()) {
+    for (auto const& page : p_compact->GetBatches<CSCPage>()) {
+      ASSERT_EQ(page.offset.HostVector(), expected.offset.HostVector());
+    }
+  }
+
+  // Stays compact after modification.
+  auto p_new = RandomDataGenerator{kRows / 2, kCols, 0.3}.Seed(1).GenerateDMatrix(true);
+  {
+    // A decoded page held by the caller is not modified.
+    auto batches = p_compact->GetBatches<SparsePage>();
+    auto const& held = *batches.begin();
+    auto offset = held.offset.HostVector();
+    p_fmat->Append(p_new.get());
+    p_compact->Append(p_new.get());
+    p_fmat->DropPrefix(kRows / 4);
+    p_compact->DropPrefix(kRows / 4);
+    ASSERT_EQ(held.offset.HostVector(), offset);
+    ASSERT_EQ(held.Size(), kRows);
+    // The stale page is not returned to new consumers.
+    check();
+  }
+  ASSERT_TRUE(simple->IsCompact());
+  check();
+}
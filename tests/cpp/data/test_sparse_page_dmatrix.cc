@@ -61,6 +61,18 @@ void TestSparseDMatrixLoadFile() {
   }
 }
 
+TEST(SparsePageDMatrix, PrefetchDepth) {
+  // Pages of 1, 4, 2, 8 bytes.
+  std::vector<std::size_t> page_bytes{1, 4, 2, 8};
+  ASSERT_EQ(data::PrefetchDepth(page_bytes, 0, 7, 16), 3);
+  ASSERT_EQ(data::PrefetchDepth(page_bytes, 0, 1024, 16), 4);
+  ASSERT_EQ(data::PrefetchDepth(page_bytes, 0, 1024, 2), 2);
+  // The first page is always fetched.
+  ASSERT_EQ(data::PrefetchDepth(page_bytes, 3, 4, 16), 1);
+  // Wrap around to the beginning for the next iteration.
+  ASSERT_EQ(data::PrefetchDepth(page_bytes, 3, 9, 16), 2);
+}
+
 TEST(SparsePageDMatrix, LoadFile) {
   TestSparseDMatrixLoadFile<SparsePage>();
   TestSparseDMatrixLoadFile<CSCPage>();
@@ -258,3 +270,86 @@ TEST(SparsePageDMatrix, Determinism) {
     ASSERT_EQ(caches[i], caches.front());
   }
 }
+
+TEST(SparsePageDMatrix, PersistentCache) {
+  dmlc::TemporaryDirectory tmpdir;
+  auto prefix = tmpdir.path + "/cache";
+  auto n_threads = AllThreadsForTest();
+  auto constexpr kRows = 64, kCols = 8, kBatches = 4;
+  BatchParam param{16, 0.8};
+
+  auto make = [&](ArrayIterForTest* iter) {
+    return std::make_unique<data::SparsePageDMatrix>(
+        iter, iter->Proxy(), Reset, Next, std::numeric_limits<float>::quiet_NaN(), n_threads,
+        prefix, true);
+  };
+  auto collect = [&](DMatrix* p_fmat) {
+    SparsePage page;
+    for (auto const& batch : p_fmat->GetBatches<SparsePage>()) {
+      page.Push(batch);
+    }
+    std::vector<std::uint8_t> index;
+    for (auto const& gidx : p_fmat->GetBatches<GHistIndexMatrix>(param)) {
+      index.insert(index.end(), gidx.index.begin(), gidx.index.end());
+    }
+    return std::make_pair(page.data.HostVector(), index);
+  };
+
+  NumpyArrayIterForTest iter{0.2, kRows, kCols, kBatches};
+  decltype(collect(nullptr)) expected;
+  std::string name;
+  {
+    auto p_fmat = make(&iter);
+    name = data::MakeId(prefix, p_fmat.get());
+    // The metadata is saved once the row page is built.
+    ASSERT_TRUE(FileExists(prefix + ".meta"));
+    expected = collect(p_fmat.get());
+  }
+  ASSERT_TRUE(FileExists(prefix + ".meta"));
+  ASSERT_TRUE(FileExists(name + ".row.page"));
+  ASSERT_TRUE(FileExists(name + ".gradient_index.page"));
+
+  auto check = [&](decltype(expected) const& reused) {
+    ASSERT_EQ(reused.first.size(), expected.first.size());
+    for (std::size_t i = 0; i < reused.first.size(); ++i) {
+      ASSERT_EQ(reused.first[i].index, expected.first[i].index);
+      ASSERT_EQ(reused.first[i].fvalue, expected.first[i].fvalue);
+    }
+    ASSERT_EQ(reused.second, expected.second);
+  };
+  {
+    // Reuse the cache.
+    NumpyArrayIterForTest same{0.2, kRows, kCols, kBatches};
+    auto p_fmat = make(&same);
+    ASSERT_EQ(p_fmat->Info().num_row_, kRows * kBatches);
+    ASSERT_EQ(p_fmat->Info().num_col_, kCols);
+    // The data is only iterated for validating the cache.
+    ASSERT_EQ(same.Iter(), 0);
+    auto reused = collect(p_fmat.get());
+    ASSERT_EQ(same.Iter(), 0);
+    check(reused);
+  }
+  {
+    // Live DMatrix objects sharing the prefix don't overwrite each other's pages.
+    NumpyArrayIterForTest first{0.2, kRows, kCols, kBatches};
+    NumpyArrayIterForTest second{0.2, kRows, kCols, kBatches};
+    auto p_first = make(&first);
+    auto p_second = make(&second);
+    auto other = BatchParam{8, 0.8};
+    for (auto const& gidx : p_second->GetBatches<GHistIndexMatrix>(other)) {
+      ASSERT_LE(gidx.cut.Ptrs().back(), kCols * other.max_bin);
+    }
+    // The replaced gradient index is removed, the other DMatrix regenerates it.
+    ASSERT_FALSE(FileExists(name + ".gradient_index.page"));
+    check(collect(p_first.get()));
+  }
+
+  {
+    // The data is changed, the cache is rebuilt.
+    NumpyArrayIterForTest changed{0.6, kRows, kCols, kBatches};
+    auto p_fmat = make(&changed);
+    auto rebuilt = collect(p_fmat.get());
+    ASSERT_NE(rebuilt.first.size(), expected.first.size());
+    ASSERT_EQ(rebuilt.first.size(), p_fmat->Info().num_nonzero_);
+  }
+}
@@ -4,28 +4,32 @@
 #include <gtest/gtest.h>
 #include <xgboost/data.h>
 
+#include "../../../src/common/io.h"  // for LoadSequentialFile
 #include "../../../src/data/sparse_page_source.h"
 #include "../filesystem.h"  // dmlc::TemporaryDirectory
 #include "../helpers.h"
 
 namespace xgboost {
 namespace data {
-template <typename S> void TestSparsePageRawFormat() {
-  std::unique_ptr<SparsePageFormat<S>> format{CreatePageFormat<S>("raw")};
+template <typename S> void TestSparsePageRawFormat(std::string name = "raw") {
+  std::unique_ptr<SparsePageFormat<S>> format{CreatePageFormat<S>(name)};
 
   auto m = RandomDataGenerator{100, 14, 0.5}.GenerateDMatrix();
   ASSERT_TRUE(m->SingleColBlock());
   dmlc::TemporaryDirectory tmpdir;
   std::string path = tmpdir.path + "/sparse.page";
   S orig;
+  std::size_t n_bytes{0};
   {
     // block code to flush the stream
     std::unique_ptr<dmlc::Stream> fo{dmlc::Stream::Create(path.c_str(), "w")};
     for (auto const &page : m->GetBatches<S>()) {
       orig.Push(page);
-      format->Write(page, fo.get());
+      n_bytes += format->Write(page, fo.get());
     }
   }
+  // The returned size is used as offset into the cache file.
+  ASSERT_EQ(n_bytes, common::LoadSequentialFile(path).size());
 
   S page;
   std::unique_ptr<dmlc::SeekStream> fi{dmlc::SeekStream::CreateForRead(path.c_str())};
@@ -39,6 +43,11 @@ template <typename S> void TestSparsePageRawFormat() {
     ASSERT_EQ(page.offset.HostVector()[i], orig.offset.HostVector()[i]);
   }
   ASSERT_EQ(page.base_rowid, orig.base_rowid);
+  // The prefetch budget uses the size of decoded pages, which are larger than compressed
+  // pages in the cache file.
+  if (name == "compressed") {
+    ASSERT_GT(DecodedPageBytes(page, n_bytes), n_bytes);
+  }
 }
 
 TEST(SparsePageRawFormat, SparsePage) {
@@ -52,5 +61,17 @@ TEST(SparsePageRawFormat, CSCPage) {
 TEST(SparsePageRawFormat, SortedCSCPage) {
   TestSparsePageRawFormat<SortedCSCPage>();
 }
+
+TEST(SparsePageCompressedFormat, SparsePage) {
+  TestSparsePageRawFormat<SparsePage>("compressed");
+}
+
+TEST(SparsePageCompressedFormat, CSCPage) {
+  TestSparsePageRawFormat<CSCPage>("compressed");
+}
+
+TEST(SparsePageCompressedFormat, SortedCSCPage) {
+  TestSparsePageRawFormat<SortedCSCPage>("compressed");
+}
 }  // namespace data
 }  // namespace xgboost
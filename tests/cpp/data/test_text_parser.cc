@@ -0,0 +1,143 @@
+/**
+ * Copyright 2023 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>  // for max
+#include <cmath>      // for isnan
+#include <cstddef>    // for size_t
+#include <cstdint>    // for uint32_t, uint64_t
+#include <fstream>    // for ofstream
+#include <limits>     // for numeric_limits
+#include <string>     // for string
+#include <vector>     // for vector
+
+#include "../../../src/data/text_parser.h"
+#include "../filesystem.h"  // dmlc::TemporaryDirectory
+
+namespace xgboost::data {
+namespace {
+TextBlock ParseAll(std::string const& uri, std::size_t block_bytes) {
+  std::string path;
+  TextParserParam param;
+  EXPECT_TRUE(TextParser::ParseUri(uri, "auto", 1, &path, &param));
+  TextParser parser{path, param, 4, block_bytes};
+  TextBlock out;
+  while (parser.Next()) {
+    auto const& block = parser.Value();
+    auto nnz = out.index.size();
+    for (std::size_t i = 1; i < block.offset.size(); ++i) {
+      out.offset.push_back(block.offset[i] + nnz);
+    }
+    out.index.insert(out.index.end(), block.index.cbegin(), block.index.cend());
+    out.value.insert(out.value.end(), block.value.cbegin(), block.value.cend());
+    out.label.insert(out.label.end(), block.label.cbegin(), block.label.cend());
+    out.weight.insert(out.weight.end(), block.weight.cbegin(), block.weight.cend());
+    out.qid.insert(out.qid.end(), block.qid.cbegin(), block.qid.cend());
+    out.n_features = std::max(out.n_features, block.n_features);
+  }
+  return out;
+}
+}  // namespace
+
+TEST(TextParser, ParseUri) {
+  dmlc::TemporaryDirectory tmpdir;
+  auto path = tmpdir.path + "/data.txt";
+  std::ofstream{path} << "1 0:1\n";
+
+  std::string out_path;
+  TextParserParam param;
+  ASSERT_TRUE(TextParser::ParseUri(path + "?format=csv&label_column=0&delimiter=;", "auto", 1,
+                                   &out_path, &param));
+  ASSERT_EQ(out_path, path);
+  ASSERT_EQ(param.format, "csv");
+  ASSERT_EQ(param.label_column, 0);
+  ASSERT_EQ(param.delimiter, ';');
+
+  ASSERT_TRUE(TextParser::ParseUri(path, "auto", 1, &out_path, &param));
+  ASSERT_EQ(param.format, "libsvm");
+  ASSERT_TRUE(TextParser::ParseUri(path + "?indexing_mode=-1", "libsvm", 1, &out_path, &param));
+  ASSERT_EQ(param.indexing_mode, -1);
+
+  // Left to the dmlc parser.
+  ASSERT_FALSE(TextParser::ParseUri(path, "auto", 2, &out_path, &param));
+  ASSERT_FALSE(TextParser::ParseUri("s3://bucket/data.txt", "auto", 1, &out_path, &param));
+  ASSERT_FALSE(TextParser::ParseUri(tmpdir.path + "/missing.txt", "auto", 1, &out_path, &param));
+  ASSERT_FALSE(TextParser::ParseUri(path + "?format=parquet", "auto", 1, &out_path, &param));
+  ASSERT_FALSE(TextParser::ParseUri(path + "?label_column=0", "libsvm", 1, &out_path, &param));
+  ASSERT_FALSE(TextParser::ParseUri(path + "?format=csv&foo=1", "auto", 1, &out_path, &param));
+}
+
+TEST(TextParser, LibSVM) {
+  dmlc::TemporaryDirectory tmpdir;
+  auto path = tmpdir.path + "/data.libsvm";
+  {
+    std::ofstream fout{path};
+    fout << "1:0.5 qid:3 1:1.5 3:-2e-1\n"
+         << "\n"
+         << "0:2 qid:3 2 4:1234567890.5  # comment\r\n"
+         << "1:1 qid:4\n";
+  }
+  for (std::size_t block_bytes : {std::size_t{1}, std::size_t{1024}}) {
+    auto block = ParseAll(path + "?indexing_mode=1", block_bytes);
+    ASSERT_EQ(block.offset, (std::vector<std::size_t>{0, 2, 4, 4}));
+    ASSERT_EQ(block.index, (std::vector<std::uint32_t>{0, 2, 1, 3}));
+    ASSERT_EQ(block.value, (std::vector<float>{1.5f, -0.2f, 1.0f, 1234567890.5f}));
+    ASSERT_EQ(block.label, (std::vector<float>{1.0f, 0.0f, 1.0f}));
+    ASSERT_EQ(block.weight, (std::vector<float>{0.5f, 2.0f, 1.0f}));
+    ASSERT_EQ(block.qid, (std::vector<std::uint64_t>{3, 3, 4}));
+    ASSERT_EQ(block.n_features, 4);
+  }
+
+  // 0-based and detected indexing.
+  auto block = ParseAll(path, 1024);
+  ASSERT_EQ(block.index, (std::vector<std::uint32_t>{1, 3, 2, 4}));
+  ASSERT_EQ(block.n_features, 5);
+  block = ParseAll(path + "?indexing_mode=-1", 1024);
+  ASSERT_EQ(block.index, (std::vector<std::uint32_t>{0, 2, 1, 3}));
+
+  // Weight must be specified for all rows.
+  std::ofstream{path} << "1:0.5 1:1\n0 2:1\n";
+  ASSERT_THROW(ParseAll(path, 1024), dmlc::Error);
+}
+
+TEST(TextParser, CSV) {
+  dmlc::TemporaryDirectory tmpdir;
+  auto path = tmpdir.path + "/data.csv";
+  {
+    std::ofstream fout{path};
+    fout << "1, 2.5,0.5,3\n"
+         << "0,,2,nan\n";
+  }
+  auto block = ParseAll(path + "?format=csv&label_column=0&weight_column=2", 1024);
+  ASSERT_EQ(block.offset, (std::vector<std::size_t>{0, 2, 4}));
+  ASSERT_EQ(block.index, (std::vector<std::uint32_t>{0, 1, 0, 1}));
+  ASSERT_EQ(block.value[0], 2.5f);
+  ASSERT_EQ(block.value[1], 3.0f);
+  ASSERT_EQ(block.value[2], 0.0f);
+  ASSERT_TRUE(std::isnan(block.value[3]));
+  ASSERT_EQ(block.label, (std::vector<float>{1.0f, 0.0f}));
+  ASSERT_EQ(block.weight, (std::vector<float>{0.5f, 2.0f}));
+  ASSERT_TRUE(block.qid.empty());
+  ASSERT_EQ(block.n_features, 2);
+
+  // Large input split into many chunks.
+  std::size_t n_rows = 1 << 14;
+  {
+    std::ofstream fout{path};
+    for (std::size_t i = 0; i < n_rows; ++i) {
+      fout << i << "," << i * 2 << "," << static_cast<float>(i) / 2.0f << "\n";
+    }
+  }
+  for (std::size_t block_bytes : {std::size_t{1} << 16, std::numeric_limits<std::size_t>::max()}) {
+    block = ParseAll(path + "?format=csv&label_column=0", block_bytes);
+    ASSERT_EQ(block.offset.size(), n_rows + 1);
+    ASSERT_EQ(block.n_features, 2);
+    for (std::size_t i = 0; i < n_rows; ++i) {
+      ASSERT_EQ(block.label[i], static_cast<float>(i));
+      ASSERT_EQ(block.value[i * 2], static_cast<float>(i * 2));
+      ASSERT_EQ(block.value[i * 2 + 1], static_cast<float>(i) / 2.0f);
+    }
+  }
+}
+}  // namespace xgboost::data
@@ -266,6 +266,43 @@ TEST(Learner, BinaryModelIO) {
   ASSERT_EQ(config_str.find("WARNING"), std::string::npos);
 }
 
+TEST(Learner, AppendDropPrefix) {
+  size_t constexpr kRows = 64, kCols = 8;
+  int32_t constexpr kIters = 4;
+  auto p_dmat = RandomDataGenerator{kRows, kCols, 0.2}.GenerateDMatrix(true);
+  std::unique_ptr<Learner> learner{Learner::Create({p_dmat})};
+  learner->SetParams(Args{{"tree_method", "hist"}});
+  for (int32_t iter = 0; iter < kIters; ++iter) {
+    learner->UpdateOneIter(iter, p_dmat);
+  }
+
+  // Slide the window, the prediction cache is aligned with the remaining rows.
+  auto p_new = RandomDataGenerator{kRows / 2, kCols, 0.2}.Seed(1).GenerateDMatrix(true);
+  p_dmat->Append(p_new.get());
+  p_dmat->DropPrefix(kRows / 4);
+  for (int32_t iter = kIters; iter < kIters * 2; ++iter) {
+    learner->UpdateOneIter(iter, p_dmat);
+  }
+  HostDeviceVector<float> cached;
+  learner->Predict(p_dmat, true, &cached, 0, 0);
+
+  // Predict with a model that has no cache.
+  Json model{Object{}};
+  learner->SaveModel(&model);
+  std::unique_ptr<Learner> fresh{Learner::Create({})};
+  fresh->LoadModel(model);
+  HostDeviceVector<float> expected;
+  fresh->Predict(p_dmat, true, &expected, 0, 0);
+
+  auto const& h_cached = cached.ConstHostVector();
+  auto const& h_expected = expected.ConstHostVector();
+  ASSERT_EQ(h_cached.size(), kRows + kRows / 2 - kRows / 4);
+  ASSERT_EQ(h_cached.size(), h_expected.size());
+  for (size_t i = 0; i < h_cached.size(); ++i) {
+    ASSERT_NEAR(h_cached[i], h_expected[i], kRtEps);
+  }
+}
+
 #if defined(XGBOOST_USE_CUDA)
 // Tests for automatic GPU configuration.
 TEST(Learner, GPUConfiguration) {
@@ -10,6 +10,9 @@
 #include <xgboost/logging.h>                            // for CHECK_EQ
 #include <xgboost/tree_model.h>                         // for RegTree, RTreeNodeStat
 
+#include <algorithm>                                    // for count, fill, stable_partition
+#include <cstdint>                                      // for uint8_t
+#include <iterator>                                     // for distance
 #include <memory>                                       // for make_shared, shared_ptr, addressof
 
 #include "../../../../src/common/hist_util.h"           // for HistCollection, HistogramCuts
@@ -96,6 +99,99 @@ TEST(HistEvaluator, Evaluate) {
   TestEvaluateSplits(true);
 }
 
+TEST(HistEvaluator, BlockedEnumeration) {
+  // The blocked enumeration must pick exactly the same split as a bin-by-bin scan.
+  Context ctx;
+  ctx.nthread = 1;
+  TrainParam param;
+  param.UpdateAllowUnknown(
+      Args{{"min_child_weight", "0.5"}, {"reg_lambda", "1"}, {"reg_alpha", "0.1"}});
+  auto sampler = std::make_shared<common::ColumnSampler>();
+
+  bst_feature_t n_features = 3;
+  // Number of bins for each feature, not multiples of the block size.
+  std::vector<bst_bin_t> n_bins{37, 5, 16};
+  common::HistogramCuts cuts;
+  cuts.cut_ptrs_.HostVector() = {0};
+  for (auto n : n_bins) {
+    for (bst_bin_t i = 0; i < n; ++i) {
+      cuts.cut_values_.HostVector().push_back(static_cast<float>(i));
+    }
+    cuts.cut_ptrs_.HostVector().push_back(cuts.cut_values_.Size());
+    cuts.min_vals_.HostVector().push_back(-1.0f);
+  }
+  auto total_bins = cuts.TotalBins();
+
+  common::HistCollection hist;
+  hist.Init(total_bins);
+  hist.AddHistRow(0);
+  hist.AllocateAllData();
+  auto node_hist = hist[0];
+  std::vector<float> values(total_bins * 2);
+  SimpleLCG lcg;
+  SimpleRealUniformDistribution<float> dist(-1.0f, 1.0f);
+  GradStats non_missing;
+  for (std::size_t i = 0; i < total_bins; ++i) {
+    node_hist[i] = {dist(&lcg), std::abs(dist(&lcg))};
+  }
+  for (std::size_t i = 0; i < cuts.Ptrs()[1]; ++i) {
+    non_missing.Add(node_hist[i].GetGrad(), node_hist[i].GetHess());
+  }
+  // Missing values for the first feature.
+  GradStats root{non_missing.GetGrad() + 0.3, non_missing.GetHess() + 0.7};
+
+  auto dmat = RandomDataGenerator(2, n_features, 0).GenerateDMatrix();
+  HistEvaluator<CPUExpandEntry> evaluator{&ctx, &param, dmat->Info(), sampler};
+  evaluator.InitRoot(root);
+  RegTree tree;
+  std::vector<CPUExpandEntry> entries(1);
+  entries.front().nid = 0;
+  evaluator.EvaluateSplits(hist, cuts, {}, tree, &entries);
+
+  // Reference scan.
+  auto split_evaluator = evaluator.Evaluator();
+  auto root_gain = evaluator.Stats().front().root_gain;
+  SplitEntry best;
+  auto valid = [&](GradStats const &l, GradStats const &r) {
+    return l.GetHess() >= param.min_child_weight && r.GetHess() >= param.min_child_weight;
+  };
+  auto const &ptrs = cuts.Ptrs();
+  auto const &vals = cuts.Values();
+  for (bst_feature_t f = 0; f < n_features; ++f) {
+    GradStats left, right;
+    for (auto i = ptrs[f]; i < ptrs[f + 1]; ++i) {
+      left.Add(node_hist[i].GetGrad(), node_hist[i].GetHess());
+      right.SetSubstract(root, left);
+      if (valid(left, right)) {
+        float loss_chg = split_evaluator.CalcSplitGain(param, 0, f, left, right) - root_gain;
+        best.Update(loss_chg, f, vals[i], false, false, left, right);
+      }
+    }
+    if (left.GetHess() == root.GetHess() && left.GetGrad() == root.GetGrad()) {
+      continue;
+    }
+    left = right = GradStats{};
+    for (auto i = static_cast<bst_bin_t>(ptrs[f + 1]) - 1; i >= static_cast<bst_bin_t>(ptrs[f]);
+         --i) {
+      left.Add(node_hist[i].GetGrad(), node_hist[i].GetHess());
+      right.SetSubstract(root, left);
+      if (valid(left, right)) {
+        float loss_chg = split_evaluator.CalcSplitGain(param, 0, f, right, left) - root_gain;
+        auto split_pt = i == static_cast<bst_bin_t>(ptrs[f]) ? cuts.MinValues()[f] : vals[i - 1];
+        best.Update(loss_chg, f, split_pt, true, false, right, left);
+      }
+    }
+  }
+
+  auto const &split = entries.front().split;
+  ASSERT_EQ(split.loss_chg, best.loss_chg);
+  ASSERT_EQ(split.SplitIndex(), best.SplitIndex());
+  ASSERT_EQ(split.DefaultLeft(), best.DefaultLeft());
+  ASSERT_EQ(split.split_value, best.split_value);
+  ASSERT_EQ(split.left_sum.GetGrad(), best.left_sum.GetGrad());
+  ASSERT_EQ(split.right_sum.GetHess(), best.right_sum.GetHess());
+}
+
 TEST(HistMultiEvaluator, Evaluate) {
   Context ctx;
   ctx.nthread = 1;
@@ -190,6 +286,93 @@ TEST(HistEvaluator, Apply) {
   }
 }
 
+TEST(HistEvaluator, FeaturePruning) {
+  Context ctx;
+  ctx.nthread = 4;
+  std::size_t constexpr kRows = 64, kCols = 16;
+  bst_bin_t constexpr kMaxBins = 16;
+  auto dmat = RandomDataGenerator(kRows, kCols, 0).Seed(3).GenerateDMatrix();
+  auto gpair = GenerateRandomGradients(kRows);
+  auto const &h_gpair = gpair.ConstHostVector();
+  GHistIndexMatrix gmat(dmat.get(), kMaxBins, 0.5, false, AllThreadsForTest());
+  auto n_bins = gmat.cut.Ptrs().back();
+
+  TrainParam param;
+  // Only features as good as the chosen split are kept.
+  param.UpdateAllowUnknown(Args{{"min_child_weight", "0"}, {"feature_gain_tolerance", "1"}});
+  auto sampler = std::make_shared<common::ColumnSampler>();
+  auto evaluator = HistEvaluator<CPUExpandEntry>{&ctx, &param, dmat->Info(), sampler};
+  auto pruner = evaluator.Pruner();
+  ASSERT_TRUE(pruner);
+
+  common::RowSetCollection row_set_collection;
+  auto &row_indices = *row_set_collection.Data();
+  row_indices.resize(kRows);
+  std::iota(row_indices.begin(), row_indices.end(), 0);
+  row_set_collection.Init();
+
+  common::HistCollection hist;
+  hist.Init(n_bins);
+  for (bst_node_t nidx = 0; nidx < 3; ++nidx) {
+    hist.AddHistRow(nidx);
+  }
+  hist.AllocateAllData();
+  auto hist_builder = common::GHistBuilder(n_bins);
+  hist_builder.BuildHist<false>(h_gpair, row_set_collection[0], gmat, hist[0]);
+  GradientPairPrecise total_gpair;
+  for (auto const &g : h_gpair) {
+    total_gpair += GradientPairPrecise(g);
+  }
+
+  RegTree tree;
+  std::vector<CPUExpandEntry> entries{{RegTree::kRoot, 0}};
+  evaluator.InitRoot(GradStats{total_gpair});
+  evaluator.EvaluateSplits(hist, gmat.cut, {}, tree, &entries);
+  ASSERT_TRUE(pruner->FeatureMask(RegTree::kRoot).empty());
+  auto const split = entries.front().split;
+  ASSERT_GT(split.loss_chg, 0.0f);
+  evaluator.ApplyTreeSplit(entries.front(), &tree);
+
+  auto left = tree[RegTree::kRoot].LeftChild();
+  auto right = tree[RegTree::kRoot].RightChild();
+  auto mask = pruner->FeatureMask(left);
+  ASSERT_EQ(mask.size(), kCols);
+  ASSERT_EQ(mask.data(), pruner->FeatureMask(right).data());
+  ASSERT_TRUE(mask[split.SplitIndex()]);
+  ASSERT_LT(static_cast<std::size_t>(std::count(mask.cbegin(), mask.cend(), 1)), kCols);
+
+  // Partition the rows according to the split.
+  auto const &cut_values = gmat.cut.Values();
+  auto mid = std::stable_partition(row_indices.begin(), row_indices.end(), [&](std::size_t ridx) {
+    return cut_values[gmat.GetGindex(ridx, split.SplitIndex())] <= split.split_value;
+  });
+  auto n_left = static_cast<std::size_t>(std::distance(row_indices.begin(), mid));
+  row_set_collection.AddSplit(RegTree::kRoot, left, right, n_left, kRows - n_left);
+
+  auto evaluate_children = [&](common::Span<std::uint8_t const> feature_mask) {
+    auto left_hist = hist[left];
+    std::fill(left_hist.begin(), left_hist.end(), GradientPairPrecise{});
+    hist_builder.BuildHist<false>(h_gpair, row_set_collection[left], gmat, left_hist, false,
+                                  feature_mask);
+    common::SubtractionHist(hist[right], hist[RegTree::kRoot], hist[left], 0, n_bins);
+    std::vector<CPUExpandEntry> children{{left, 1}, {right, 1}};
+    evaluator.EvaluateSplits(hist, gmat.cut, {}, tree, &children);
+    return children;
+  };
+  // Bins of the skipped features are not built, nor used for evaluation.
+  auto pruned = evaluate_children(mask);
+  auto full = evaluate_children({});
+  for (std::size_t i = 0; i < pruned.size(); ++i) {
+    auto const &child_split = pruned[i].split;
+    if (child_split.loss_chg > 0.0f) {
+      ASSERT_TRUE(mask[child_split.SplitIndex()]);
+    }
+    ASSERT_EQ(child_split.SplitIndex(), full[i].split.SplitIndex());
+    ASSERT_EQ(child_split.split_value, full[i].split.split_value);
+    ASSERT_EQ(child_split.loss_chg, full[i].split.loss_chg);
+  }
+}
+
 TEST_F(TestPartitionBasedSplit, CPUHist) {
   Context ctx;
   // check the evaluator is returning the optimal split
@@ -262,6 +445,79 @@ TEST(HistEvaluator, Categorical) {
   ASSERT_EQ(with_onehot.split.loss_chg, with_part.split.loss_chg);
 }
 
+namespace {
+CPUExpandEntry EvaluateRootSplit(std::vector<FeatureType> ft) {
+  Context ctx;
+  ctx.nthread = 4;
+  int static constexpr kRows = 256;
+  bst_bin_t constexpr kMaxBins = 16;
+  TrainParam param;
+  param.UpdateAllowUnknown(Args{{"min_child_weight", "0"},
+                                {"max_cat_to_onehot", "1"},
+                                {"shard_split_evaluation", "true"}});
+
+  auto dmat =
+      RandomDataGenerator(kRows, ft.size(), 0).Seed(3).Type(ft).MaxCategory(8).GenerateDMatrix();
+  auto gpair = GenerateRandomGradients(kRows);
+  auto const &h_gpair = gpair.ConstHostVector();
+
+  auto sampler = std::make_shared<common::ColumnSampler>();
+  auto evaluator = HistEvaluator<CPUExpandEntry>{&ctx, &param, dmat->Info(), sampler};
+  std::vector<CPUExpandEntry> entries(1);
+  for (auto const &gmat : dmat->GetBatches<GHistIndexMatrix>({kMaxBins, 0.5})) {
+    common::RowSetCollection row_set_collection;
+    std::vector<size_t> &row_indices = *row_set_collection.Data();
+    row_indices.resize(kRows);
+    std::iota(row_indices.begin(), row_indices.end(), 0);
+    row_set_collection.Init();
+
+    common::HistCollection hist;
+    hist.Init(gmat.cut.TotalBins());
+    hist.AddHistRow(0);
+    hist.AllocateAllData();
+    auto hist_builder = common::GHistBuilder(gmat.cut.TotalBins());
+    hist_builder.BuildHist<false>(h_gpair, row_set_collection[0], gmat, hist[0], false);
+    GradientPairPrecise total_gpair;
+    for (auto const &g : h_gpair) {
+      total_gpair += GradientPairPrecise{g};
+    }
+    RegTree tree;
+    evaluator.InitRoot(GradStats{total_gpair});
+    evaluator.EvaluateSplits(hist, gmat.cut, dmat->Info().feature_types.ConstHostSpan(), tree,
+                             &entries);
+  }
+  return entries.front();
+}
+
+void TestEvaluateSplitsFeatureShard(std::vector<FeatureType> const &ft,
+                                    CPUExpandEntry const &expected) {
+  // Each worker evaluates a shard of features, the gathered best split must be the same
+  // as evaluating all features.
+  auto result = EvaluateRootSplit(ft);
+  ASSERT_EQ(result.split.loss_chg, expected.split.loss_chg);
+  ASSERT_EQ(result.split.sindex, expected.split.sindex);
+  ASSERT_EQ(result.split.is_cat, expected.split.is_cat);
+  if (!expected.split.is_cat) {
+    ASSERT_EQ(result.split.split_value, expected.split.split_value);
+  }
+  ASSERT_EQ(result.split.cat_bits, expected.split.cat_bits);
+  ASSERT_EQ(result.split.left_sum.GetHess(), expected.split.left_sum.GetHess());
+  ASSERT_EQ(result.split.right_sum.GetGrad(), expected.split.right_sum.GetGrad());
+}
+}  // anonymous namespace
+
+TEST(HistEvaluator, FeatureShard) {
+  auto constexpr kWorkers = 3;
+  bst_feature_t constexpr kCols = 16;
+  for (auto type : {FeatureType::kNumerical, FeatureType::kCategorical}) {
+    std::vector<FeatureType> ft(kCols, type);
+    auto expected = EvaluateRootSplit(ft);
+    ASSERT_GT(expected.split.loss_chg, 0.0f);
+    ASSERT_EQ(expected.split.is_cat, type == FeatureType::kCategorical);
+    RunWithInMemoryCommunicator(kWorkers, TestEvaluateSplitsFeatureShard, ft, expected);
+  }
+}
+
 TEST_F(TestCategoricalSplitWithMissing, HistEvaluator) {
   common::HistCollection hist;
   hist.Init(cuts_.TotalBins());
@@ -4,7 +4,10 @@
 #include <gtest/gtest.h>
 #include <xgboost/context.h>  // Context
 
+#include <array>   // for array
+#include <cmath>   // for ldexp
 #include <limits>
+#include <memory>  // for unique_ptr, make_unique
 
 #include "../../../../src/common/categorical.h"
 #include "../../../../src/common/row_set.h"
@@ -292,6 +295,252 @@ TEST(CPUHistogram, BuildHist) {
   TestBuildHistogram(false, true, false);
 }
 
+TEST(CPUHistogram, BuildHistFeatureParallel) {
+  // Wide and short data, the histogram is built by partitioning features among threads.
+  std::int32_t constexpr kThreads = 4;
+  size_t constexpr kNRows = 64, kNCols = 512;
+  int32_t constexpr kMaxBins = 16;
+  auto p_fmat = RandomDataGenerator(kNRows, kNCols, 0.0).Seed(3).GenerateDMatrix();
+  auto const &gmat = *(p_fmat->GetBatches<GHistIndexMatrix>(BatchParam{kMaxBins, 0.5}).begin());
+  ASSERT_TRUE(gmat.IsDense());
+  uint32_t total_bins = gmat.cut.Ptrs().back();
+  auto gpair = GenerateRandomGradients(kNRows);
+  auto const &h_gpair = gpair.ConstHostVector();
+
+  RegTree tree;
+  tree.ExpandNode(0, 0, 0, false, 0, 0, 0, 0, 0, 0, 0);
+  HistogramBuilder<CPUExpandEntry> histogram;
+  histogram.Reset(total_bins, {kMaxBins, 0.5}, kThreads, 1, false, false);
+
+  // Split the rows between two children to exercise multiple nodes along with the
+  // subtraction trick.
+  common::RowSetCollection row_set_collection;
+  InitRowPartitionForTest(&row_set_collection, kNRows);
+  row_set_collection.AddSplit(0, 1, 2, kNRows / 4, kNRows - kNRows / 4);
+
+  std::vector<CPUExpandEntry> nodes_for_explicit_hist_build{{1, tree.GetDepth(1)}};
+  std::vector<CPUExpandEntry> nodes_for_subtraction_trick{{2, tree.GetDepth(2)}};
+  // Root first.
+  std::vector<CPUExpandEntry> root{{RegTree::kRoot, 0}};
+  common::RowSetCollection root_set;
+  InitRowPartitionForTest(&root_set, kNRows);
+  histogram.BuildHist(0, gmat, &tree, root_set, root, {}, h_gpair);
+  ASSERT_TRUE(histogram.IsFeatureParallel());
+  histogram.BuildHist(0, gmat, &tree, row_set_collection, nodes_for_explicit_hist_build,
+                      nodes_for_subtraction_trick, h_gpair);
+  ASSERT_TRUE(histogram.IsFeatureParallel());
+
+  auto check = [&](bst_node_t nidx, std::size_t rbegin, std::size_t rend) {
+    std::vector<GradientPairPrecise> expected(total_bins);
+    for (size_t rid = rbegin; rid < rend; ++rid) {
+      for (size_t i = gmat.row_ptr[rid]; i < gmat.row_ptr[rid + 1]; ++i) {
+        expected[gmat.index[i]] += GradientPairPrecise(h_gpair[rid]);
+      }
+    }
+    auto hist = histogram.Histogram()[nidx];
+    for (size_t i = 0; i < total_bins; ++i) {
+      ASSERT_NEAR(expected[i].GetGrad(), hist[i].GetGrad(), kRtEps);
+      ASSERT_NEAR(expected[i].GetHess(), hist[i].GetHess(), kRtEps);
+    }
+  };
+  check(RegTree::kRoot, 0, kNRows);
+  check(1, 0, kNRows / 4);
+  check(2, kNRows / 4, kNRows);
+}
+
+TEST(CPUHistogram, BuildHistFeatureParallelMixedPages) {
+  // External memory pages can differ in density, only the dense pages are built by
+  // partitioning features and the others fall back to the row-wise building.
+  std::int32_t constexpr kThreads = 4;
+  size_t constexpr kNRows = 64, kNCols = 512;
+  int32_t constexpr kMaxBins = 16;
+  auto p_fmat = RandomDataGenerator(kNRows, kNCols, 0.0).Seed(3).GenerateDMatrix();
+  auto cuts = (*p_fmat->GetBatches<GHistIndexMatrix>(BatchParam{kMaxBins, 0.5}).begin()).cut;
+  uint32_t total_bins = cuts.Ptrs().back();
+  auto gpair = GenerateRandomGradients(kNRows);
+  auto const &h_gpair = gpair.ConstHostVector();
+
+  // The first half of the rows is dense, the second half has missing values.
+  std::array<SparsePage, 2> pages;
+  auto full = (*p_fmat->GetBatches<SparsePage>().begin()).GetView();
+  for (size_t ridx = 0; ridx < kNRows; ++ridx) {
+    auto is_dense = ridx < kNRows / 2;
+    auto &page = pages[is_dense ? 0 : 1];
+    auto &data = page.data.HostVector();
+    auto row = full[ridx];
+    for (size_t j = 0; j < row.size(); ++j) {
+      if (is_dense || j % 3 != 0) {
+        data.push_back(row[j]);
+      }
+    }
+    page.offset.HostVector().push_back(data.size());
+  }
+  pages[1].base_rowid = kNRows / 2;
+  std::array<std::unique_ptr<GHistIndexMatrix>, 2> gmats;
+  for (size_t i = 0; i < pages.size(); ++i) {
+    gmats[i] = std::make_unique<GHistIndexMatrix>(pages[i], common::Span<FeatureType const>{},
+                                                  cuts, kMaxBins, i == 0, 0.5, kThreads);
+  }
+  ASSERT_TRUE(gmats[0]->IsDense());
+  ASSERT_FALSE(gmats[1]->IsDense());
+
+  std::vector<GradientPairPrecise> expected(total_bins);
+  for (auto const &gmat : gmats) {
+    for (size_t i = 0; i < gmat->Size(); ++i) {
+      for (size_t j = gmat->row_ptr[i]; j < gmat->row_ptr[i + 1]; ++j) {
+        expected[gmat->index[j]] += GradientPairPrecise(h_gpair[gmat->base_rowid + i]);
+      }
+    }
+  }
+
+  RegTree tree;
+  std::vector<CPUExpandEntry> nodes{{RegTree::kRoot, 0}};
+  common::BlockedSpace2d space{1, [&](size_t) { return kNRows / 2; }, 256};
+  // Both orders of pages, the dense one is built first or last.
+  for (auto order : {std::array<size_t, 2>{0, 1}, std::array<size_t, 2>{1, 0}}) {
+    HistogramBuilder<CPUExpandEntry> histogram;
+    histogram.Reset(total_bins, {kMaxBins, 0.5}, kThreads, pages.size(), false, false);
+    for (size_t page_idx = 0; page_idx < order.size(); ++page_idx) {
+      auto const &gmat = *gmats[order[page_idx]];
+      common::RowSetCollection row_set_collection;
+      InitRowPartitionForTest(&row_set_collection, gmat.Size(), gmat.base_rowid);
+      histogram.BuildHist(page_idx, space, gmat, &tree, row_set_collection, nodes, {}, h_gpair);
+      ASSERT_EQ(histogram.IsFeatureParallel(), gmat.IsDense());
+    }
+    auto hist = histogram.Histogram()[RegTree::kRoot];
+    for (size_t i = 0; i < total_bins; ++i) {
+      ASSERT_NEAR(expected[i].GetGrad(), hist[i].GetGrad(), kRtEps);
+      ASSERT_NEAR(expected[i].GetHess(), hist[i].GetHess(), kRtEps);
+    }
+  }
+}
+
+namespace {
+void TestBuildHistOverlapSync(float sparsity, Args const &sync_args) {
+  size_t constexpr kNRows = 256, kNCols = 8;
+  int32_t constexpr kMaxBins = 16;
+  auto p_fmat = RandomDataGenerator(kNRows, kNCols, sparsity).Seed(3).GenerateDMatrix();
+  auto const &gmat = *(p_fmat->GetBatches<GHistIndexMatrix>(BatchParam{kMaxBins, 0.5}).begin());
+  uint32_t total_bins = gmat.cut.Ptrs().back();
+  auto gpair = GenerateRandomGradients(kNRows);
+  auto const &h_gpair = gpair.ConstHostVector();
+
+  HistogramBuilder<CPUExpandEntry> histogram;
+  histogram.Reset(total_bins, {kMaxBins, 0.5}, 4, 1, true, false);
+  TrainParam param;
+  param.UpdateAllowUnknown(sync_args);
+  histogram.ConfigureSync(param);
+  // Relative error of the transmitted values.
+  double eps = 0.0;
+  if (param.hist_sync_precision == TrainParam::kFloatSync) {
+    eps = 1e-6;
+  } else if (param.hist_sync_precision == TrainParam::kBFloat16Sync) {
+    eps = std::ldexp(1.0, -8);
+  }
+
+  RegTree tree;
+  common::RowSetCollection row_set_collection;
+  InitRowPartitionForTest(&row_set_collection, kNRows);
+  // The error of each node is bounded by the error of the root, as it's divided between the
+  // children.
+  std::vector<GradientPairPrecise> root_scale(total_bins);
+  for (size_t rid = 0; rid < kNRows; ++rid) {
+    for (size_t i = gmat.row_ptr[rid]; i < gmat.row_ptr[rid + 1]; ++i) {
+      root_scale[gmat.index[i]] +=
+          GradientPairPrecise{std::abs(h_gpair[rid].GetGrad()), h_gpair[rid].GetHess()};
+    }
+  }
+  // Range of rows for each node.
+  std::vector<std::pair<std::size_t, std::size_t>> ranges{{0, kNRows}};
+  std::vector<CPUExpandEntry> nodes_for_explicit_hist_build{{RegTree::kRoot, 0}};
+  std::vector<CPUExpandEntry> nodes_for_subtraction_trick;
+  histogram.BuildHist(0, gmat, &tree, row_set_collection, nodes_for_explicit_hist_build,
+                      nodes_for_subtraction_trick, h_gpair);
+
+  auto check = [&](bst_node_t nidx) {
+    std::vector<GradientPairPrecise> expected(total_bins);
+    for (size_t rid = ranges[nidx].first; rid < ranges[nidx].second; ++rid) {
+      for (size_t i = gmat.row_ptr[rid]; i < gmat.row_ptr[rid + 1]; ++i) {
+        expected[gmat.index[i]] += GradientPairPrecise(h_gpair[rid]);
+      }
+    }
+    auto hist = histogram.Histogram()[nidx];
+    auto world = static_cast<double>(collective::GetWorldSize());
+    for (size_t i = 0; i < total_bins; ++i) {
+      ASSERT_NEAR(expected[i].GetGrad() * world, hist[i].GetGrad(),
+                  eps * root_scale[i].GetGrad() * world + kRtEps);
+      ASSERT_NEAR(expected[i].GetHess() * world, hist[i].GetHess(),
+                  eps * root_scale[i].GetHess() * world + kRtEps);
+    }
+  };
+  check(RegTree::kRoot);
+
+  // Grow 3 levels, the last one has 4 pairs of nodes to be built in groups.
+  std::vector<bst_node_t> leaves{RegTree::kRoot};
+  for (std::int32_t depth = 1; depth <= 3; ++depth) {
+    nodes_for_explicit_hist_build.clear();
+    nodes_for_subtraction_trick.clear();
+    std::vector<bst_node_t> new_leaves;
+    for (std::size_t i = 0; i < leaves.size(); ++i) {
+      auto nidx = leaves[i];
+      tree.ExpandNode(nidx, 0, 0, false, 0, 0, 0, 0, 0, 0, 0);
+      auto left = tree[nidx].LeftChild();
+      auto right = tree[nidx].RightChild();
+      auto [begin, end] = ranges[nidx];
+      auto n_left = (end - begin) / (i % 2 == 0 ? 4 : 2);
+      ranges.resize(right + 1);
+      ranges[left] = {begin, begin + n_left};
+      ranges[right] = {begin + n_left, end};
+      row_set_collection.AddSplit(nidx, left, right, n_left, end - begin - n_left);
+      // Mix the left and right children in the nodes to be built.
+      if (i % 2 == 0) {
+        nodes_for_explicit_hist_build.emplace_back(left, depth);
+        nodes_for_subtraction_trick.emplace_back(right, depth);
+      } else {
+        nodes_for_explicit_hist_build.emplace_back(right, depth);
+        nodes_for_subtraction_trick.emplace_back(left, depth);
+      }
+      new_leaves.push_back(left);
+      new_leaves.push_back(right);
+    }
+    histogram.BuildHist(0, gmat, &tree, row_set_collection, nodes_for_explicit_hist_build,
+                        nodes_for_subtraction_trick, h_gpair);
+    for (auto nidx : new_leaves) {
+      check(nidx);
+    }
+    leaves = std::move(new_leaves);
+  }
+}
+}  // anonymous namespace
+
+TEST(CPUHistogram, BuildHistOverlapSync) {
+  auto constexpr kWorkers = 2;
+  RunWithInMemoryCommunicator(kWorkers, TestBuildHistOverlapSync, 0.0, Args{});
+  RunWithInMemoryCommunicator(kWorkers, TestBuildHistOverlapSync, 0.4, Args{});
+}
+
+TEST(CPUHistogram, BuildHistSyncCompression) {
+  auto constexpr kWorkers = 3;
+  for (auto precision : {"double", "float", "bfloat16"}) {
+    for (auto sparse : {"false", "true"}) {
+      Args args{{"hist_sync_precision", precision}, {"hist_sync_sparse", sparse}};
+      RunWithInMemoryCommunicator(kWorkers, TestBuildHistOverlapSync, 0.0, args);
+      RunWithInMemoryCommunicator(kWorkers, TestBuildHistOverlapSync, 0.6, args);
+    }
+  }
+  // The bfloat16 histograms are summed as float by larger clusters, the error doesn't grow
+  // with the number of workers.
+  ASSERT_TRUE(detail::BFloat16Codec::UseGather(kWorkers));
+  for (auto n_workers : {4, 16}) {
+    ASSERT_FALSE(detail::BFloat16Codec::UseGather(n_workers));
+    for (auto sparse : {"false", "true"}) {
+      Args args{{"hist_sync_precision", "bfloat16"}, {"hist_sync_sparse", sparse}};
+      RunWithInMemoryCommunicator(n_workers, TestBuildHistOverlapSync, 0.0, args);
+      RunWithInMemoryCommunicator(n_workers, TestBuildHistOverlapSync, 0.6, args);
+    }
+  }
+}
+
 TEST(CPUHistogram, BuildHistColSplit) {
   auto constexpr kWorkers = 4;
   RunWithInMemoryCommunicator(kWorkers, TestBuildHistogram, true, true, true);
@@ -53,5 +53,40 @@ TEST(Sampler, Basic) {
   run(1);
   run(3);
 }
+
+TEST(Sampler, GradientBased) {
+  std::size_t constexpr kRows = 2048;
+  double constexpr kSubsample = .2;
+  TrainParam param;
+  param.UpdateAllowUnknown(
+      Args{{"subsample", std::to_string(kSubsample)}, {"sampling_method", "gradient_based"}});
+  Context ctx;
+
+  linalg::Matrix<GradientPair> gpair = linalg::Empty<GradientPair>(&ctx, kRows, 1);
+  auto h_gpair = gpair.HostView();
+  // A small number of rows with large gradient.
+  std::size_t constexpr kLarge = 64;
+  for (std::size_t i = 0; i < kRows; ++i) {
+    h_gpair(i, 0) = i < kLarge ? GradientPair{100.0f, 1.0f} : GradientPair{0.1f, 1.0f};
+  }
+  SampleGradient(&ctx, param, h_gpair);
+
+  std::size_t n_sampled{0};
+  for (std::size_t i = 0; i < kRows; ++i) {
+    if (i < kLarge) {
+      // Large gradients are always selected without being re-weighted.
+      ASSERT_EQ(h_gpair(i, 0).GetGrad(), 100.0f);
+      ASSERT_EQ(h_gpair(i, 0).GetHess(), 1.0f);
+    }
+    if (h_gpair(i, 0).GetHess() - .0f != .0f) {
+      n_sampled++;
+      // Selected rows are re-weighted by the inverse of the probability.
+      ASSERT_GE(h_gpair(i, 0).GetHess(), 1.0f);
+    }
+  }
+  auto ratio = static_cast<double>(n_sampled) / static_cast<double>(kRows);
+  ASSERT_LT(ratio, kSubsample * 1.5);
+  ASSERT_GT(ratio, kSubsample * 0.5);
+}
 }  // namespace tree
 }  // namespace xgboost
@@ -0,0 +1,69 @@
+/**
+ * Copyright 2023 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+#include <xgboost/tree_model.h>
+#include <xgboost/tree_updater.h>
+
+#include <memory>  // for unique_ptr
+#include <string>  // for string, to_string
+#include <vector>  // for vector
+
+#include "../../../src/tree/param.h"  // for TrainParam
+#include "../helpers.h"
+
+namespace xgboost::tree {
+namespace {
+RegTree BuildExactTree(std::shared_ptr<DMatrix> p_fmat, HostDeviceVector<GradientPair>* gpair,
+                       std::int32_t n_threads, Args const& args) {
+  Context ctx;
+  ctx.UpdateAllowUnknown(Args{{"nthread", std::to_string(n_threads)}});
+  ObjInfo task{ObjInfo::kRegression};
+  std::unique_ptr<TreeUpdater> updater{TreeUpdater::Create("grow_colmaker", &ctx, &task)};
+  updater->Configure(args);
+  TrainParam param;
+  param.UpdateAllowUnknown(args);
+
+  RegTree tree{1u, static_cast<bst_feature_t>(p_fmat->Info().num_col_)};
+  std::vector<HostDeviceVector<bst_node_t>> position(1);
+  updater->Update(&param, gpair, p_fmat.get(), position, {&tree});
+  return tree;
+}
+
+void TestThreadInvariance(float sparsity, Args const& args) {
+  std::size_t constexpr kRows = 4096, kCols = 16;
+  auto p_fmat = RandomDataGenerator{kRows, kCols, sparsity}.Seed(3).GenerateDMatrix();
+  auto gpair = GenerateRandomGradients(kRows);
+
+  // The split search is distributed over features and nodes, the result must not depend
+  // on the number of threads.
+  auto expected = BuildExactTree(p_fmat, &gpair, 1, args);
+  ASSERT_GT(expected.NumExtraNodes(), 2);
+  for (std::int32_t n_threads : {2, 7, 16}) {
+    auto tree = BuildExactTree(p_fmat, &gpair, n_threads, args);
+    ASSERT_EQ(tree, expected);
+  }
+}
+}  // anonymous namespace
+
+TEST(ColMaker, ThreadInvariance) {
+  TestThreadInvariance(0.0, Args{{"max_depth", "6"}});
+  TestThreadInvariance(0.5, Args{{"max_depth", "8"}, {"min_child_weight", "0.5"}});
+  TestThreadInvariance(0.5, Args{{"max_depth", "8"}, {"default_direction", "right"}});
+}
+
+TEST(ColMaker, InteractionConstraint) {
+  std::size_t constexpr kRows = 32, kCols = 16;
+  auto p_fmat = RandomDataGenerator{kRows, kCols, 0.6f}.Seed(3).GenerateDMatrix();
+  auto gpair = GenerateRandomGradients(kRows);
+  auto tree = BuildExactTree(
+      p_fmat, &gpair, 4,
+      Args{{"interaction_constraints", "[[0, 1]]"}, {"num_feature", std::to_string(kCols)}});
+  tree.WalkTree([&](bst_node_t nidx) {
+    if (!tree[nidx].IsLeaf()) {
+      EXPECT_LT(tree[nidx].SplitIndex(), 2);
+    }
+    return true;
+  });
+}
+}  // namespace xgboost::tree
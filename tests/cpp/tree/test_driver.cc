@@ -0,0 +1,96 @@
+/**
+ * Copyright 2023 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+
+#include <cstddef>  // for size_t
+#include <vector>   // for vector
+
+#include "../../../src/tree/driver.h"
+#include "../../../src/tree/hist/expand_entry.h"
+
+namespace xgboost::tree {
+namespace {
+CPUExpandEntry MakeEntry(bst_node_t nidx, bst_node_t depth, float loss_chg) {
+  SplitEntry split;
+  split.loss_chg = loss_chg;
+  split.left_sum = GradStats{0.0, 1.0};
+  split.right_sum = GradStats{0.0, 1.0};
+  return {nidx, depth, split};
+}
+}  // anonymous namespace
+
+TEST(Driver, AdaptiveDepthWise) {
+  TrainParam p;
+  p.UpdateAllowUnknown(Args{{"grow_policy", "depthwise"}, {"max_depth", "0"}});
+  std::size_t constexpr kMaxBatch = 2;
+  std::int32_t constexpr kThreads = 2;
+  Driver<CPUExpandEntry> driver(p, kMaxBatch);
+  std::vector<std::size_t> rows(16, 1);
+  driver.SetRowEstimator([&](CPUExpandEntry const& e) { return rows.at(e.nid); }, kThreads);
+
+  driver.Push(MakeEntry(0, 0, 1.0f));
+  ASSERT_EQ(driver.Pop().size(), 1);
+  // Small nodes are grouped past the node limit, but only within the same level.
+  for (bst_node_t i = 1; i < 7; ++i) {
+    driver.Push(MakeEntry(i, 1, 1.0f));
+  }
+  driver.Push(MakeEntry(7, 2, 1.0f));
+  auto batch = driver.Pop();
+  ASSERT_EQ(batch.size(), 6);
+  for (auto const& e : batch) {
+    ASSERT_EQ(e.depth, 1);
+  }
+  ASSERT_EQ(driver.BatchStats().n_grouped, 1);
+  ASSERT_EQ(driver.Pop().size(), 1);
+
+  // Large nodes use the node limit.
+  auto large = Driver<CPUExpandEntry>::kMinRowsPerThread * kThreads;
+  for (bst_node_t i = 8; i < 12; ++i) {
+    rows[i] = large;
+    driver.Push(MakeEntry(i, 3, 1.0f));
+  }
+  ASSERT_EQ(driver.Pop().size(), kMaxBatch);
+  ASSERT_EQ(driver.Pop().size(), kMaxBatch);
+  ASSERT_TRUE(driver.Pop().empty());
+
+  auto const& stats = driver.BatchStats();
+  ASSERT_EQ(stats.n_batches, 5);
+  ASSERT_EQ(stats.n_nodes, 12);
+  ASSERT_EQ(stats.max_batch_size, 6);
+}
+
+TEST(Driver, AdaptiveLossGuide) {
+  auto rows = [](CPUExpandEntry const&) { return std::size_t{1}; };
+  {
+    // Without a leaf limit, nodes from different levels are expanded together.
+    TrainParam p;
+    p.UpdateAllowUnknown(Args{{"grow_policy", "lossguide"}, {"max_depth", "0"}});
+    Driver<CPUExpandEntry> driver(p);
+    driver.SetRowEstimator(rows, 4);
+    driver.Push(MakeEntry(1, 1, 1.0f));
+    driver.Push(MakeEntry(3, 2, 5.0f));
+    driver.Push(MakeEntry(4, 2, 3.0f));
+    auto batch = driver.Pop();
+    ASSERT_EQ(batch.size(), 3);
+    // Ordered by loss change.
+    ASSERT_EQ(batch[0].nid, 3);
+    ASSERT_EQ(batch[1].nid, 4);
+    ASSERT_EQ(batch[2].nid, 1);
+  }
+  {
+    // With a leaf limit, the order of expansion matters.
+    TrainParam p;
+    p.UpdateAllowUnknown(
+        Args{{"grow_policy", "lossguide"}, {"max_depth", "0"}, {"max_leaves", "8"}});
+    Driver<CPUExpandEntry> driver(p);
+    driver.SetRowEstimator(rows, 4);
+    driver.Push(MakeEntry(1, 1, 1.0f));
+    driver.Push(MakeEntry(3, 2, 5.0f));
+    auto batch = driver.Pop();
+    ASSERT_EQ(batch.size(), 1);
+    ASSERT_EQ(batch[0].nid, 3);
+    ASSERT_EQ(driver.Pop().front().nid, 1);
+  }
+}
+}  // namespace xgboost::tree
@@ -6,6 +6,7 @@
 #include <xgboost/tree_updater.h>
 
 #include <algorithm>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -74,5 +75,102 @@ TEST(QuantileHist, Partitioner) {
     }
   }
 }
+
+TEST(QuantileHist, SampledPartitioner) {
+  size_t n_samples = 1024, n_features = 1, base_rowid = 0;
+  Context ctx;
+  ctx.InitAllowUnknown(Args{});
+
+  // Only the even rows are sampled.
+  std::vector<GradientPair> gpair(n_samples);
+  for (size_t i = 0; i < n_samples; i += 2) {
+    gpair[i] = GradientPair{1.0f, 1.0f};
+  }
+  CommonRowPartitioner partitioner{&ctx, n_samples, base_rowid,
+                                   common::Span<GradientPair const>{gpair}};
+  ASSERT_EQ(partitioner.Size(), 1);
+  ASSERT_EQ(partitioner.Partitions()[0].Size(), n_samples / 2);
+  for (auto it = partitioner[0].begin; it != partitioner[0].end; ++it) {
+    ASSERT_EQ(*it % 2, 0);
+  }
+
+  auto Xy = RandomDataGenerator{n_samples, n_features, 0}.GenerateDMatrix(true);
+  std::vector<CPUExpandEntry> candidates{{0, 0}};
+  candidates.front().split.loss_chg = 0.4;
+  auto cuts = common::SketchOnDMatrix(Xy.get(), 64, ctx.Threads());
+
+  for (auto const& page : Xy->GetBatches<SparsePage>()) {
+    GHistIndexMatrix gmat(page, {}, cuts, 64, true, 0.5, ctx.Threads());
+    bst_feature_t const split_ind = 0;
+    common::ColumnMatrix column_indices;
+    column_indices.InitFromSparse(page, gmat, 0.5, ctx.Threads());
+
+    auto ptr = gmat.cut.Ptrs()[split_ind + 1];
+    float split_value = gmat.cut.Values().at(ptr / 2);
+    RegTree tree;
+    GetSplit(&tree, split_value, &candidates);
+    partitioner.UpdatePosition<false, true>(&ctx, gmat, column_indices, candidates, &tree);
+    auto left_nidx = tree[RegTree::kRoot].LeftChild();
+    auto right_nidx = tree[RegTree::kRoot].RightChild();
+    ASSERT_EQ(partitioner[left_nidx].Size() + partitioner[right_nidx].Size(), n_samples / 2);
+
+    // All rows are assigned to leaves after finalising the position.
+    partitioner.FinalisePosition(&ctx, gmat, tree);
+    ASSERT_EQ(partitioner[left_nidx].Size() + partitioner[right_nidx].Size(), n_samples);
+    auto elem = partitioner[left_nidx];
+    for (auto it = elem.begin; it != elem.end; ++it) {
+      auto value = gmat.cut.Values().at(gmat.index[*it]);
+      ASSERT_LE(value, split_value);
+    }
+    elem = partitioner[right_nidx];
+    for (auto it = elem.begin; it != elem.end; ++it) {
+      auto value = gmat.cut.Values().at(gmat.index[*it]);
+      ASSERT_GT(value, split_value) << *it;
+    }
+  }
+}
+
+TEST(QuantileHist, ExternalMemory) {
+  constexpr size_t kRows = 1024, kCols = 4, kPages = 4;
+  dmlc::TemporaryDirectory tmpdir;
+  std::unique_ptr<DMatrix> p_fmat{CreateSparsePageDMatrix(kRows, kCols, 1, tmpdir.path + "/cache")};
+  std::unique_ptr<DMatrix> p_fmat_ext{
+      CreateSparsePageDMatrix(kRows, kCols, kPages, tmpdir.path + "/cache_ext")};
+  auto gpair = GenerateRandomGradients(kRows);
+
+  Context ctx;
+  ObjInfo task{ObjInfo::kRegression};
+  auto build = [&](DMatrix* dmat, RegTree* p_tree, HostDeviceVector<bst_node_t>* p_position) {
+    std::unique_ptr<TreeUpdater> updater{
+        TreeUpdater::Create("grow_quantile_histmaker", &ctx, &task)};
+    TrainParam param;
+    param.UpdateAllowUnknown(Args{{"max_depth", "6"}});
+    updater->Configure(Args{});
+    updater->Update(&param, &gpair, dmat, common::Span<HostDeviceVector<bst_node_t>>{p_position, 1},
+                    {p_tree});
+  };
+
+  // Nodes of a level are processed page by page for the external memory DMatrix, the
+  // result should be the same as using a single page.
+  RegTree tree{1u, kCols};
+  HostDeviceVector<bst_node_t> position;
+  build(p_fmat.get(), &tree, &position);
+  RegTree tree_ext{1u, kCols};
+  HostDeviceVector<bst_node_t> position_ext;
+  build(p_fmat_ext.get(), &tree_ext, &position_ext);
+
+  ASSERT_GT(tree.NumExtraNodes(), 2);
+  ASSERT_EQ(tree.NumNodes(), tree_ext.NumNodes());
+  for (bst_node_t i = 0; i < tree.NumNodes(); ++i) {
+    ASSERT_EQ(tree[i].IsLeaf(), tree_ext[i].IsLeaf());
+    if (tree[i].IsLeaf()) {
+      ASSERT_NEAR(tree[i].LeafValue(), tree_ext[i].LeafValue(), kRtEps);
+    } else {
+      ASSERT_EQ(tree[i].SplitIndex(), tree_ext[i].SplitIndex());
+      ASSERT_EQ(tree[i].SplitCond(), tree_ext[i].SplitCond());
+    }
+  }
+  ASSERT_EQ(position.ConstHostVector(), position_ext.ConstHostVector());
+}
 }  // namespace tree
 }  // namespace xgboost
@@ -61,10 +61,12 @@ class RegenTest : public ::testing::Test {
   auto constexpr Iter() const { return 4; }
 
   template <typename Page>
-  size_t TestTreeMethod(std::string tree_method, std::string obj, bool reset = true) const {
+  size_t TestTreeMethod(std::string tree_method, std::string obj, bool reset = true,
+                        Args const& args = {}) const {
     auto learner = std::unique_ptr<Learner>{Learner::Create({p_fmat_})};
     learner->SetParam("tree_method", tree_method);
     learner->SetParam("objective", obj);
+    learner->SetParams(args);
     learner->Configure();
 
     for (auto i = 0; i < Iter(); ++i) {
@@ -92,6 +94,17 @@ TEST_F(RegenTest, Approx) {
   ASSERT_EQ(n, this->Iter());
 }
 
+TEST_F(RegenTest, ApproxDrift) {
+  // Trees in the same iteration share the sketch.
+  auto n = this->TestTreeMethod<GHistIndexMatrix>("approx", "reg:logistic", true,
+                                                  {{"num_parallel_tree", "2"}});
+  ASSERT_EQ(n, this->Iter());
+  // The total variation distance is bounded by 1, the first sketch is always reused.
+  n = this->TestTreeMethod<GHistIndexMatrix>("approx", "reg:logistic", true,
+                                             {{"sketch_drift_tolerance", "1"}});
+  ASSERT_EQ(n, 1);
+}
+
 TEST_F(RegenTest, Hist) {
   auto n = this->TestTreeMethod<GHistIndexMatrix>("hist", "reg:squarederror");
   ASSERT_EQ(n, 1);
@@ -208,6 +208,19 @@ class TestBasic:
         assert isinstance(cv, dict)
         assert len(cv) == (4)
 
+    def test_cv_view(self):
+        dm = xgb.DMatrix(dpath + 'agaricus.txt.train')
+        # Views are opt-in, the default tree method is supported as well.
+        for tree_method in ["auto", "hist"]:
+            params = {'max_depth': 2, 'eta': 1, 'verbosity': 0,
+                      'objective': 'binary:logistic', 'tree_method': tree_method}
+            cv = xgb.cv(params, dm, num_boost_round=4, nfold=4, as_pandas=False,
+                        view=True)
+            assert isinstance(cv, dict)
+            assert len(cv) == (4)
+        with pytest.raises(ValueError, match="gpu_hist"):
+            xgb.cv({'tree_method': 'gpu_hist'}, dm, num_boost_round=1, view=True)
+
     def test_cv_explicit_fold_indices(self):
         dm = xgb.DMatrix(dpath + 'agaricus.txt.train')
         params = {'max_depth': 2, 'eta': 1, 'verbosity': 0, 'objective':
@@ -88,3 +88,32 @@ class TestArrowTable(unittest.TestCase):
         y_np_low = dtrain.get_float_info("label_lower_bound")
         np.testing.assert_equal(y_np_up, y_upper_bound.to_pandas().values)
         np.testing.assert_equal(y_np_low, y_lower_bound.to_pandas().values)
+
+    def test_arrow_quantile_chunked(self):
+        rows, cols = 256, 4
+        rng = np.random.RandomState(1994)
+        X = rng.randn(rows, cols)
+        X[rng.rand(rows, cols) < 0.2] = np.nan
+        names = [f"f{i}" for i in range(cols)]
+        columns = [pa.array(X[:, i], from_pandas=True) for i in range(cols)]
+        table = pa.Table.from_arrays(columns, names)
+        # Split the rows into record batches with uneven sizes.
+        chunked = pa.Table.from_batches(
+            [table.slice(0, 100).to_batches()[0], table.slice(100).to_batches()[0]]
+        )
+        assert chunked.column(0).num_chunks == 2
+
+        expected = xgb.QuantileDMatrix(X, feature_names=names)
+        Xy = xgb.QuantileDMatrix(chunked)
+        assert Xy.feature_names == names
+        assert Xy.num_row() == rows
+
+        y = rng.randn(rows)
+        expected.set_label(y)
+        Xy.set_label(y)
+        booster = xgb.train({"tree_method": "hist"}, expected, num_boost_round=4)
+        from_chunked = xgb.train({"tree_method": "hist"}, Xy, num_boost_round=4)
+        np.testing.assert_allclose(
+            booster.predict(xgb.DMatrix(X, feature_names=names)),
+            from_chunked.predict(xgb.DMatrix(chunked)),
+        )